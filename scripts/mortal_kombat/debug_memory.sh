@@ -1,9 +1,14 @@
 #!/bin/bash
 
+# Genomes are stored in compact form: expanded to json by the archive tool
+archive=build/release/tools/splinoids-archive
+[ ! -z ${BUILD+x} ] && archive=$BUILD/tools/splinoids-archive
+
 for p in A B
 do
   f=$1/$p
-  ls $f/gen[0-9]*/mk*.dna -v | xargs jq '.dna | fromjson | .[0].gen.s.g' \
+  ls $f/gen[0-9]*/mk*.dna -v | xargs -n1 $archive json \
+    | jq '.dna | fromjson | .[0].gen.s.g' \
     | awk 'BEGIN{n=0}{new=(prev!=$1); if (new) n++; print n, new; prev=$1}' > .tmp.$p
 #   cat .tmp.$p
 done
@@ -42,7 +42,11 @@ indfolder=$(dirname $ind)/$(basename $ind .dna)
 shift
 
 sfolder=$(dirname $0) # script folder
-teams=$(jq '.dna | fromjson | .[0]' $ind)
+
+# Genomes are stored in compact form: expanded to json by the archive tool
+archive=build/release/tools/splinoids-archive
+[ ! -z ${BUILD+x} ] && archive=$BUILD/tools/splinoids-archive
+teams=$($archive json $ind | jq '.dna | fromjson | .[0]')
 
 ################################################################################
 # Behavior against previous champion(s)
@@ -13,6 +13,10 @@ then
   exit 1
 fi
 
+# Genomes are stored in compact form: expanded to json by the archive tool
+archive=build/release/tools/splinoids-archive
+[ ! -z ${BUILD+x} ] && archive=$BUILD/tools/splinoids-archive
+
 gens=$(readlink -e $f/A/gen_last | sed 's/.*[^0-9]\([0-9]\+\)/\1/')
 for p in A B
 do
@@ -24,7 +28,7 @@ do
     for g in $(seq $gens -1 0)
     do
       tmplocal="$f/$p/.tmp.lineage.local"
-      jq -r '.population | sort_by(.fitnesses["mk"]) | reverse | .[] | [.id[0], (.dna | fromjson | .[0].gen | (.s.g, .m.g)), (.fitnesses["mk"])] | join(" ")' $f/$p/gen$g/pop*pop > $tmplocal
+      $archive json $f/$p/gen$g/pop*pop | jq -r '.population | sort_by(.fitnesses["mk"]) | reverse | .[] | [.id[0], (.dna | fromjson | .[0].gen | (.s.g, .m.g)), (.fitnesses["mk"])] | join(" ")' > $tmplocal
       awk -vID=$prevChamp 'NR==1 || $2 == ID' $tmplocal
       prevChamp=$(head -n1 $tmplocal | cut -d ' ' -f 3)
     done | pv -N "Processing ${p}.raw" > $tmpraw
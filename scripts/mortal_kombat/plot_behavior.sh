@@ -58,7 +58,10 @@ fi
 # Visu flag for pdf rendering
 annRender="--ann-render=$ext"
 
-teamsize=$(jq '.dna | fromjson | .[0]' $ind)
+# Genomes are stored in compact form: expanded to json by the archive tool
+archive=build/release/tools/splinoids-archive
+[ ! -z ${BUILD+x} ] && archive=$BUILD/tools/splinoids-archive
+teamsize=$($archive json $ind | jq '.dna | fromjson | .[0]')
 
 plotoutputs(){
   gnuplot -e "
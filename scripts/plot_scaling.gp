@@ -0,0 +1,49 @@
+#!/usr/bin/gnuplot
+
+file=ARG1
+output=ARG2
+
+print "      script : ", ARG0
+print " input file  : ", file
+print " output file : ", output
+
+if (ARGC < 2) {
+  print "Plots the results of es-scaling: throughput (top) and share of each"
+  print "phase of the step (bottom) for every measured point"
+  exit
+}
+
+set term pngcairo size 1680,1680 font ',18';
+set output output
+
+# Columns (see es-scaling): 1-8 point, 9-14 measures, 15+ phases shares
+# (one per profiled phase, 14 as of now: 15-28). The last column is derived
+# from the header line (leading '#' excluded) to follow future phases
+first=15
+last=int(system(sprintf("awk 'NR==1 { print NF-1; exit }' '%s'", file)))
+label(i)=sprintf("%d@%dx%d p%d:%d t%d", \
+                 column(1), column(2), column(3), column(4), column(5), \
+                 column(6))
+
+set multiplot layout 2,1
+
+set title noenhance file;
+set ylabel 'Steps/s (all threads)';
+set logscale y;
+set grid;
+set xtics rotate by -45 noenhance;
+set style fill solid .25;
+set boxwidth .8;
+plot file using 0:11:xtic(label(0)) with boxes notitle
+
+unset title;
+unset logscale y;
+set ylabel 'Share of step time';
+set yrange [0:1];
+set style data histogram;
+set style histogram rowstacked;
+set style fill solid .75 border -1;
+set key outside right noenhance;
+plot for [i=first:last] file using i:xtic(label(0)) title columnhead(i-1)
+
+unset multiplot
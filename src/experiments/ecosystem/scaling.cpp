@@ -0,0 +1,347 @@
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../simu/simulation.h"
+
+#include "kgd/external/cxxopts.hpp"
+
+/// Scaling study of the (headless) ecosystem simulation
+///
+/// Sweeps the cartesian product of the requested population sizes, arena
+/// sizes, vision precisions, thread counts and Box2D iterations. Each point
+/// runs in its own process (clean peak memory and Box2D parameters, which are
+/// cached on first use) with as many independent simulations as threads.
+/// After a warm-up, sustained throughput and the share of each phase of the
+/// step profiler are measured.
+
+using CGenome = genotype::Critter;
+using EGenome = genotype::Environment;
+using simu::Simulation;
+using simu::Profiler;
+using json = nlohmann::json;
+
+static constexpr int debugScaling = 0;
+
+struct Point {
+  uint critters;
+  uint width, height;
+  uint pmin, pmax;    // Vision precision range of the seed genomes
+  uint threads;
+  uint viter, piter;  // Box2D velocity/position iterations
+
+  json toJson (void) const {
+    return {
+      { "critters", critters }, { "width", width }, { "height", height },
+      { "pmin", pmin }, { "pmax", pmax }, { "threads", threads },
+      { "viter", viter }, { "piter", piter }
+    };
+  }
+};
+
+struct Settings {
+  uint steps, warmup;
+  uint genomes;
+  float energyPerCritter;
+  int seed;
+};
+
+/// Phases reported (critter substeps rather than the enclosing CRITTERS)
+static const std::vector<Profiler::Phase> phases {
+  Profiler::VISION, Profiler::NEURAL, Profiler::METABOLISM, Profiler::AGING,
+  Profiler::BOX2D, Profiler::FIGHTS, Profiler::FEEDING, Profiler::LOD,
+  Profiler::GHOSTS,
+  Profiler::AUDITION, Profiler::REPRODUCTION, Profiler::CORPSES,
+  Profiler::DECOMPOSITION, Profiler::PLANTS, Profiler::STATS
+};
+
+template <typename F>
+std::vector<std::string> split (const std::string &s, char sep, F check) {
+  std::vector<std::string> tokens;
+  std::istringstream iss (s);
+  std::string token;
+  while (std::getline(iss, token, sep))
+    if (!token.empty()) tokens.push_back(token);
+  if (!check(tokens.size()))
+    utils::Thrower("Malformed value '", s, "'");
+  return tokens;
+}
+
+/// Parses "a,b,c" as a list of values
+std::vector<uint> parseList (const std::string &s) {
+  std::vector<uint> l;
+  for (const std::string &t: split(s, ',', [] (auto n) { return n > 0; }))
+    l.push_back(std::stoul(t));
+  return l;
+}
+
+/// Parses "a<sep>b,c,..." as a list of pairs (a lone value stands for both)
+std::vector<std::pair<uint,uint>> parsePairs (const std::string &s, char sep) {
+  std::vector<std::pair<uint,uint>> l;
+  for (const std::string &t: split(s, ',', [] (auto n) { return n > 0; })) {
+    auto p = split(t, sep, [] (auto n) { return n == 1 || n == 2; });
+    uint a = std::stoul(p.front()), b = std::stoul(p.back());
+    l.emplace_back(a, b);
+  }
+  return l;
+}
+
+/// Runs a simulation on the calling thread, merging its timings into total
+void runOne (const Point &p, const Settings &s, uint index,
+             Profiler &total, std::mutex &mutex, double &seconds) {
+  rng::FastDice dice (s.seed + index);
+
+  EGenome e = EGenome::random(dice);
+  e.width = p.width;
+  e.height = p.height;
+  e.taurus = true;
+
+  std::vector<CGenome> genomes;
+  for (uint i=0; i<s.genomes; i++) {
+    CGenome g = CGenome::random(dice);
+    g.vision.precision =
+      p.pmin + (s.genomes > 1 ? i * (p.pmax - p.pmin) / (s.genomes - 1) : 0);
+    genomes.push_back(g);
+  }
+
+  Simulation::InitData idata {};
+  idata.ienergy = p.critters * s.energyPerCritter;
+  idata.cRatio = 1. / (1+config::Simulation::plantEnergyDensity());
+  idata.nCritters = p.critters;
+  idata.cRange = 1;
+  idata.pRange = 1;
+  idata.seed = s.seed + index;
+
+  Simulation simulation;
+  simulation.init(e, genomes, idata);
+
+  for (uint i=0; i<s.warmup && !simulation.extinct(); i++) simulation.step();
+
+  Profiler &profiler = simulation.environment().profiler();
+  profiler.clear();
+
+  auto start = Profiler::clock::now();
+  for (uint i=0; i<s.steps && !simulation.extinct(); i++) simulation.step();
+  double duration = std::chrono::duration<double>(
+                      Profiler::clock::now() - start).count();
+
+  std::lock_guard<std::mutex> lock (mutex);
+  total.merge(profiler);
+  profiler.clear();
+  seconds = std::max(seconds, duration);
+}
+
+/// Measures a point (in a child process)
+json measure (const Point &p, const Settings &s) {
+  config::Simulation::b2VelocityIter.overrideWith(p.viter);
+  config::Simulation::b2PositionIter.overrideWith(p.piter);
+  Profiler::setLevel(1);
+
+  Profiler total;
+  std::mutex mutex;
+  double seconds = 0;
+
+  std::vector<std::thread> workers;
+  for (uint i=0; i<p.threads; i++)
+    workers.emplace_back(runOne, std::cref(p), std::cref(s), i,
+                         std::ref(total), std::ref(mutex), std::ref(seconds));
+  for (std::thread &t: workers) t.join();
+
+  rusage u {};
+  getrusage(RUSAGE_SELF, &u);
+
+  uint64_t steps = total[Profiler::STEP].count,
+           ticks = total[Profiler::AGING].count;
+  double stepTime = total[Profiler::STEP].total;
+
+  json shares;
+  for (Profiler::Phase ph: phases)
+    shares[Profiler::names[ph]] =
+      stepTime > 0 ? total[ph].total / stepTime : 0.;
+
+  json j = p.toJson();
+  j["steps"] = steps;
+  j["seconds"] = seconds;
+  j["steps_per_second"] = seconds > 0 ? steps / seconds : 0;
+  j["critter_ticks_per_second"] = seconds > 0 ? ticks / seconds : 0;
+  j["mean_critters"] = steps > 0 ? double(ticks) / steps : 0;
+  j["peak_rss_kb"] = u.ru_maxrss;
+  j["shares"] = shares;
+
+  total.clear();
+  return j;
+}
+
+/// Forks, measures the point in the child and sends back the result
+json measureInChild (const Point &p, const Settings &s) {
+  int fds [2];
+  if (pipe(fds) != 0) utils::Thrower("Failed to create pipe");
+
+  pid_t pid = fork();
+  if (pid < 0)  utils::Thrower("Failed to fork");
+
+  if (pid == 0) {
+    close(fds[0]);
+    int status = 0;
+    try {
+      std::string str = measure(p, s).dump();
+      if (write(fds[1], str.data(), str.size()) != ssize_t(str.size()))
+        status = 1;
+    } catch (std::exception &e) {
+      std::cerr << "Failed to measure " << p.toJson() << ": " << e.what()
+                << std::endl;
+      status = 1;
+    }
+    close(fds[1]);
+    _exit(status);  // Skip exit handlers (e.g. profiler output)
+  }
+
+  close(fds[1]);
+  std::string str;
+  char buffer [4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) str.append(buffer, n);
+  close(fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || str.empty()) {
+    json j = p.toJson();
+    j["failed"] = true;
+    return j;
+  }
+
+  if (debugScaling) std::cerr << "Child " << pid << ": " << str << "\n";
+  return json::parse(str);
+}
+
+int main(int argc, char *argv[]) {
+  std::string critters = "50,200,1000", sizes = "50,100,200",
+              precisions = "1", threads = "1", iterations = "8:3";
+  std::string output = "scaling";
+
+  Settings s;
+  s.steps = 1000;
+  s.warmup = 100;
+  s.genomes = 4;
+  s.energyPerCritter = 20;
+  s.seed = 0;
+
+  cxxopts::Options options("Splinoids (scaling study)",
+                           "Throughput of the ecosystem simulation across"
+                           " population and world sizes");
+  options.add_options()
+    ("h,help", "Display help")
+    ("n,critters", "Initial population sizes (comma-separated)",
+     cxxopts::value(critters))
+    ("sizes", "Arena sizes (comma-separated, as S or WxH)",
+     cxxopts::value(sizes))
+    ("precisions", "Vision precision ranges of the seed genomes"
+                   " (comma-separated, as P or MIN:MAX)",
+     cxxopts::value(precisions))
+    ("threads", "Number of concurrent simulations (comma-separated)",
+     cxxopts::value(threads))
+    ("b2-iterations", "Box2D velocity and position iterations"
+                      " (comma-separated, as V:P)",
+     cxxopts::value(iterations))
+    ("steps", "Number of measured steps", cxxopts::value(s.steps))
+    ("warmup", "Number of unmeasured steps before that",
+     cxxopts::value(s.warmup))
+    ("genomes", "Number of (random) seed genomes",
+     cxxopts::value(s.genomes))
+    ("energy", "Energy per initial critter (plants included)",
+     cxxopts::value(s.energyPerCritter))
+    ("s,seed", "Seed of the first simulation (next ones are incremented)",
+     cxxopts::value(s.seed))
+    ("o,output", "Base name for the output files (.dat, .json)",
+     cxxopts::value(output))
+    ;
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("help")) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  config::Simulation::verbosity.overrideWith(0);
+  s.genomes = std::max(1u, s.genomes);
+
+  std::vector<Point> points;
+  for (uint n: parseList(critters))
+    for (auto size: parsePairs(sizes, 'x'))
+      for (auto prec: parsePairs(precisions, ':'))
+        for (uint t: parseList(threads))
+          for (auto iter: parsePairs(iterations, ':'))
+            points.push_back({ n, size.first, size.second,
+                               prec.first, prec.second, std::max(1u, t),
+                               iter.first, iter.second });
+
+  std::cout << "Measuring " << points.size() << " points ("
+            << s.warmup << "+" << s.steps << " steps each)\n";
+
+  std::ofstream dat (output + ".dat");
+  dat << "# Critters Width Height PMin PMax Threads VIter PIter Steps Seconds"
+         " StepsPerS TicksPerS MeanCritters PeakRSSKb";
+  for (Profiler::Phase ph: phases) dat << " " << Profiler::names[ph];
+  dat << "\n";
+
+  std::cout << std::setw(8) << "critters" << std::setw(10) << "arena"
+            << std::setw(8) << "prec" << std::setw(8) << "threads"
+            << std::setw(6) << "b2it" << std::setw(12) << "steps/s"
+            << std::setw(12) << "ticks/s" << std::setw(10) << "alive"
+            << std::setw(10) << "RSS (MB)" << "  dominant\n";
+
+  json report = json::array();
+  for (const Point &p: points) {
+    json j = measureInChild(p, s);
+    report.push_back(j);
+
+    std::ostringstream arena, prec, iter;
+    arena << p.width << "x" << p.height;
+    prec << p.pmin << ":" << p.pmax;
+    iter << p.viter << ":" << p.piter;
+
+    std::cout << std::setw(8) << p.critters << std::setw(10) << arena.str()
+              << std::setw(8) << prec.str() << std::setw(8) << p.threads
+              << std::setw(6) << iter.str();
+    if (j.contains("failed")) {
+      std::cout << "  failed" << std::endl;
+      continue;
+    }
+
+    const json &shares = j["shares"];
+    std::string dominant;
+    float dshare = 0;
+    for (const auto &sh: shares.items())
+      if (sh.value().get<float>() > dshare)
+        dominant = sh.key(), dshare = sh.value();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(12) << j["steps_per_second"].get<double>()
+              << std::setw(12) << j["critter_ticks_per_second"].get<double>()
+              << std::setw(10) << j["mean_critters"].get<double>()
+              << std::setw(10) << j["peak_rss_kb"].get<long>() / 1024.
+              << "  " << dominant << " (" << std::setprecision(0)
+              << 100 * dshare << "%)" << std::defaultfloat << std::endl;
+
+    dat << p.critters << " " << p.width << " " << p.height << " "
+        << p.pmin << " " << p.pmax << " " << p.threads << " "
+        << p.viter << " " << p.piter << " " << j["steps"] << " "
+        << j["seconds"] << " " << j["steps_per_second"] << " "
+        << j["critter_ticks_per_second"] << " " << j["mean_critters"] << " "
+        << j["peak_rss_kb"];
+    for (Profiler::Phase ph: phases) dat << " " << shares[Profiler::names[ph]];
+    dat << "\n";
+  }
+
+  std::ofstream (output + ".json") << report.dump(2) << "\n";
+  std::cout << "Results written to " << output << ".{dat,json}\n";
+
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include "indevaluator.h"
+
+#include "../../tools/benchmark.h"
+
+using Genome = simu::Evaluator::Genome;
+using Ind = simu::Evaluator::Ind;
+
+/// Evaluates n random (seeded) individuals on the given spec set
+void evaluate (const std::string &type, uint n) {
+  rng::FastDice dice (0);
+  phylogeny::GIDManager gidManager;
+  simu::Evaluator eval (type);
+
+  for (uint i=0; i<n; i++) {
+    auto g = Genome::random(dice);
+    g.gdata.setAsPrimordial(gidManager);
+    Ind ind (g);
+    eval(ind);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  config::Simulation::verbosity.overrideWith(0);
+
+  bench::Benchmark b ("lg-bench");
+  b.add("lg-direction", [&b] { evaluate("d", b.steps(10)); });
+  b.add("lg-color", [&b] { evaluate("c22", b.steps(10)); });
+  return b.main(argc, argv);
+}
@@ -46,7 +46,8 @@ bool diffStatsMap (const T &prev, const T &curr) {
       if (!ok)
         std::cout << " (" << p.second - it->second << ")";
       std::cout << GAGA_COLOR_NORMAL;
-      if (p.first == "wtime") ok = true;
+      if (p.first == "wtime" || p.first == "allocs"
+          || p.first == "alloc_bytes" || p.first == "peak_bytes") ok = true;
       allOk &= ok;
 
     } else {
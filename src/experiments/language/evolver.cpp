@@ -1,6 +1,8 @@
 #include <csignal>
 
 #include "indevaluator.h"
+#include "../../ga/novelty.hpp"
+#include "../../ga/steadystate.hpp"
 #include "kgd/external/cxxopts.hpp"
 
 void sigint_manager (int) {
@@ -119,6 +121,8 @@ int main(int argc, char *argv[]) {
   Verbosity verbosity = Verbosity::SHOW;
   int gagaVerbosity = 1;
   bool novelty = true;
+  bool async = false;
+  bool packed = false;
 
 //  std::string load;
 
@@ -148,6 +152,10 @@ int main(int argc, char *argv[]) {
     ("gaga-verbosity", "GAGA verbosity level. ",
      cxxopts::value(gagaVerbosity))
     ("no-novelty", "Disable novelty fitness")
+    ("pack", "Store elites, populations and stats in a single packed archive"
+             " (see splinoids-archive) instead of per-generation files")
+    ("async", "Asynchronous steady-state evolution (no generational barrier,"
+              " generations are counted in epochs of population evaluations)")
 
     ("f,data-folder", "Folder under which to store the computational outputs",
      cxxopts::value(outputFolder))
@@ -190,6 +198,8 @@ int main(int argc, char *argv[]) {
   }
 
   novelty = (!result.count("no-novelty"));
+  async = result.count("async");
+  packed = result.count("pack");
 
   {
     std::string evalTypes = simu::Evaluator::prettyEvalTypes();
@@ -300,11 +310,16 @@ int main(int argc, char *argv[]) {
 
   ga.disableGenerationHistory();
   if (gagaSavePopulations == 0) ga.disablePopulationSave();
+  if (packed) {
+    ga.setNbSavedElites(0);
+    ga.disablePopulationSave();
+  }
 
   ga.setSaveFolderGenerator([dataFolder] (auto) { return dataFolder; });
 
   ga.setNewGenerationFunction([&ga, gagaSavePopulations] {
     std::cout << "\nNew generation at " << utils::CurrentTime{} << "\n";
+    simu::Trace::instant("generation", "ga", ga.getCurrentGenerationNumber());
 
 #ifndef CLUSTER_BUILD
     auto gen = ga.getCurrentGenerationNumber();
@@ -330,15 +345,8 @@ int main(int argc, char *argv[]) {
   ga.setEvaluator([&eval] (auto &i, auto /*p*/) { eval(i); }, "language");
 
 // -- -- -- -- -- -- SPECIFIC TO THE NOVELTY EXTENSION: -- -- -- -- -- -- --
-  GAGA::NoveltyExtension<GA> nov;  // novelty extension instance
-  // Distance function (compares 2 signatures). Here a simple Euclidian distance.
-  auto euclidianDist = [](const auto& fpA, const auto& fpB) {
-      double sum = 0;
-      for (size_t i = 0; i < fpA.size(); ++i)
-        sum += std::pow(fpA[i] - fpB[i], 2);
-      return sqrt(sum);
-  };
-  nov.setComputeSignatureDistanceFunction(euclidianDist);
+  simu::IndexedNoveltyExtension<GA> nov;  // novelty extension instance
+  // Euclidian distance between signatures (set by the indexed extension)
   nov.K = 10;  // size of the neighbourhood to compute novelty.
   //(Novelty = avg dist to the K Nearest Neighbors)
   nov.saveArchiveEnabled = false;
@@ -384,43 +392,95 @@ int main(int argc, char *argv[]) {
   auto start = simu::Simulation::now();
   std::ofstream genealogy;
 
-  for (uint i=0; i<generations && !simu::Evaluator::aborted; i++) {
-    if (i == generations-1) nov.saveArchiveEnabled = true;
-
-    ga.step();
-
-    if (gagaSavePopulations == -1 && i > 0) {
-      stdfs::path previousPop = ga.getSaveFolder();
-      previousPop /= utils::mergeToString("gen", i-1);
-      previousPop /= utils::mergeToString("pop", i-1, ".pop");
-      std::cerr << "Removing previous population\n";
-      stdfs::remove(previousPop);
-    }
-
-    if (i == 0) {
-      genealogy.open(ga.getSaveFolder() / "genealogy.dat");
+  const auto logGenealogy = [&genealogy, &dataFolder] (
+      uint gen, const std::vector<GA::Ind_t> &individuals) {
+    if (gen == 0) {
+      genealogy.open(dataFolder / "genealogy.dat");
       if (!genealogy)
         utils::Thrower<std::logic_error>(
           "Failed to create genealogy file '",
-          ga.getSaveFolder(), "/genealogy.dat'");
+          dataFolder, "/genealogy.dat'");
       genealogy << "Gen Ind_i Ind_GID Parent_i Parent_GID Score\n";
     }
 
-    for (const GA::Ind_t &ind: ga.previousGenerations.back()) {
-      genealogy << i << " " << ind.id.second << " "
+    for (const GA::Ind_t &ind: individuals) {
+      genealogy << gen << " " << ind.id.second << " "
                 << ind.dna.gdata.self.gid << " ";
-      if (i == 0)
+      // Epochs count completions: initial individuals may end up in later ones
+      if (ind.parents.empty())
         genealogy << "0 -1 ";
       else
         genealogy << ind.parents.front().second << " "
                   << ind.dna.gdata.mother.gid << " ";
       genealogy << ind.fitnesses.at("lg") << "\n";
     }
+  };
+
+  uint lastGen = 0;
+  if (async) {
+    simu::SteadyStateGA<GA::Ind_t> sga;
+    sga.setPopSize(popSize);
+    sga.setNbThreads(threads);
+    sga.setTournamentSize(4);
+    sga.setObjective("lg");
+    sga.setEvaluatorName("language");
+    sga.setSaveFolder(dataFolder);
+    sga.setSavePopulations(gagaSavePopulations != 0);
+    sga.setVerbosity(gagaVerbosity);
+    sga.setAbortFlag(&simu::Evaluator::aborted);
+    sga.usePackedArchive(packed);
+    if (novelty)  sga.useNovelty(nov.K);
+
+    sga.setMutateMethod([&dice, &gidManager](Genome &g) {
+      g.mutate(dice);
+      g.gdata.updateAfterCloning(gidManager);
+    });
+    sga.setEvaluator([&eval] (GA::Ind_t &i) { eval(i); });
+    sga.setCostEstimator([] (const GA::Ind_t &i) {
+      return simu::Critter::complexity(i.dna);
+    });
+    sga.setNewEpochFunction(logGenealogy);
+
+    sga.initPopulation([&ga, i = 0u] () mutable {
+      return ga.population[i++].dna;
+    });
+
+    stdfs::create_directories(dataFolder);
+#ifndef CLUSTER_BUILD
+    symlink_as_last(dataFolder);
+#endif
+
+    sga.run(generations, dice);
+    lastGen = sga.getCurrentGenerationNumber();
+
+  } else {
+    simu::ArchiveWriter pack;
+    if (packed) pack.open(dataFolder);
+
+    for (uint i=0; i<generations && !simu::Evaluator::aborted; i++) {
+      if (i == generations-1) nov.saveArchiveEnabled = true;
+
+      ga.step();
+
+      if (packed)
+        pack.appendGeneration(ga, "lg", 1, gagaSavePopulations != 0);
+
+      if (gagaSavePopulations == -1 && i > 0) {
+        stdfs::path previousPop = ga.getSaveFolder();
+        previousPop /= utils::mergeToString("gen", i-1);
+        previousPop /= utils::mergeToString("pop", i-1, ".pop");
+        std::cerr << "Removing previous population\n";
+        stdfs::remove(previousPop);
+      }
+
+      logGenealogy(i, ga.previousGenerations.back());
+    }
+    lastGen = ga.getCurrentGenerationNumber();
   }
 
-  stdfs::create_directory_symlink(
-    GAGA::concat("gen", ga.getCurrentGenerationNumber()-1),
-    ga.getSaveFolder() / "gen_last");
+  if (lastGen > 0 && !packed)
+    stdfs::create_directory_symlink(GAGA::concat("gen", lastGen-1),
+                                    dataFolder / "gen_last");
 
   genealogy.close();
 
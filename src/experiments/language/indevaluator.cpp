@@ -1,4 +1,6 @@
 #include "indevaluator.h"
+#include "../../ga/archive.h"
+#include "../../simu/allocations.h"
 
 namespace simu {
 
@@ -693,6 +695,8 @@ Scenario::Params Evaluator::Params::scenarioParams (uint i) const {
 }
 
 void Evaluator::operator() (Ind &ind, Params &params) {
+  simu::Trace::Span span ("evaluation", "ga", ind.id.second);
+  simu::Allocations::Scope allocations;
   static const auto &TPS = config::Simulation::ticksPerSecond();
   bool brainless = true, mute = false;
 
@@ -734,7 +738,8 @@ void Evaluator::operator() (Ind &ind, Params &params) {
 
   for (uint i=0; i<n && !brainless; i++) {
 
-    Simulation simulation;
+    Simulation::Lease lease;
+    Simulation &simulation = *lease;
     Scenario scenario (simulation);
 
     auto s_params = params.scenarioParams(i);
@@ -856,6 +861,7 @@ void Evaluator::operator() (Ind &ind, Params &params) {
   if (n > 1)
     ind.stats["stime"] = float(ind.stats["stime"]) / n;
   ind.stats["wtime"] = Simulation::durationFrom(start_time) / 1000.f;
+  allocations.exportTo(ind.stats);
 
   ind.stats["mute"] = mute;
 }
@@ -902,13 +908,20 @@ void Evaluator::dumpStats(const stdfs::path &/*dna*/,
 }
 
 Evaluator::Ind Evaluator::fromJsonFile(const std::string &path) {
-  std::ifstream t(path);
-  if (!t) utils::Thrower("Error while opening ", path);
+  nlohmann::json o;
+  if (ArchiveReader::isLocator(path))
+    o = ArchiveReader::loadIndividual(path);
 
-  std::stringstream buffer;
-  buffer << t.rdbuf();
+  else {
+    std::ifstream t(path);
+    if (!t) utils::Thrower("Error while opening ", path);
+
+    std::stringstream buffer;
+    buffer << t.rdbuf();
+
+    o = nlohmann::json::parse(buffer.str());
+  }
 
-  auto o = nlohmann::json::parse(buffer.str());
   if (o.count("dna")) // assuming this is a gaga individual
     return Ind(o);
   else
@@ -126,6 +126,11 @@ void Scenario::init(const Params &params) {
   // Deactivate energy monitoring
   if (neuralEvaluation()) _simulation._systemExpectedEnergy = -1;
 
+  // Subjects are driven by hand: maybe skip the physics solve (which also
+  // drops fights and new contacts, see Environment::setKinematic)
+  if (neuralEvaluation() && config::Simulation::kinematicEvaluations())
+    _simulation.environment().setKinematic(true);
+
   if (neuralEvaluation()) {
     makeCritter(0, params.genome, params.brainTemplate);
 
@@ -0,0 +1,27 @@
+#include "indevaluator.h"
+
+#include "../../tools/benchmark.h"
+
+using CGenome = simu::IndEvaluator::DNA;
+using Ind = simu::IndEvaluator::Ind;
+
+/// Evaluates n random (seeded) individuals on a seeded scenario selection
+void evaluate (bool v0Scenarios, uint n) {
+  rng::FastDice dice (0);
+  simu::IndEvaluator eval (v0Scenarios);
+  eval.selectCurrentScenarios(dice);
+
+  for (uint i=0; i<n; i++) {
+    Ind ind (CGenome::random(dice));
+    eval(ind, 0);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  config::Simulation::verbosity.overrideWith(0);
+
+  bench::Benchmark b ("ld-bench");
+  b.add("ld-v0", [&b] { evaluate(true, b.steps(10)); });
+  b.add("ld-v1", [&b] { evaluate(false, b.steps(10)); });
+  return b.main(argc, argv);
+}
@@ -1,6 +1,8 @@
 #include <csignal>
 
 #include "indevaluator.h"
+#include "../../ga/novelty.hpp"
+#include "../../ga/archive.h"
 #include "kgd/external/cxxopts.hpp"
 
 void sigint_manager (int) {
@@ -58,6 +60,7 @@ int main(int argc, char *argv[]) {
   long seed = -1;
 
   bool v1scenarios = false;
+  bool packed = false;
 
   cxxopts::Options options("Splinoids (pp-evolver)",
                            "Evolution of minimal splinoids in 2D simulations"
@@ -94,6 +97,9 @@ int main(int argc, char *argv[]) {
 
     ("1,v1", "Use v1 scenarios",
      cxxopts::value(v1scenarios)->implicit_value("true"))
+    ("pack", "Store elites and stats in a single packed archive"
+             " (see splinoids-archive) instead of per-generation files",
+     cxxopts::value(packed)->implicit_value("true"))
     ;
 
   auto result = options.parse(argc, argv);
@@ -193,10 +199,24 @@ int main(int argc, char *argv[]) {
   ga.setSaveIndStats(true);
   ga.setSaveParetoFront(false);
 
-  ga.setNewGenerationFunction([&dice, &eval, &ga] {
+  // Previous generation is archived when the next one starts (and at the end)
+  simu::ArchiveWriter pack;
+  if (packed) {
+    ga.setNbSavedElites(0);
+    ga.disablePopulationSave();
+  }
+  auto archive = [&pack, &ga] {
+    if (!pack.isOpen()) pack.open(ga.getSaveFolder());
+    pack.appendGeneration(ga, "fitness", 1, false);
+  };
+
+  ga.setNewGenerationFunction([&dice, &eval, &ga, &packed, &archive] {
     std::cout << "\nNew generation at " << utils::CurrentTime{} << "\n";
+    simu::Trace::instant("generation", "ga", ga.getCurrentGenerationNumber());
     if (ga.getCurrentGenerationNumber() == 0)
       symlink_as_last(ga.getSaveFolder());
+    else if (packed)
+      archive();
     eval.selectCurrentScenarios(dice);
     std::cout << std::endl;
   });
@@ -206,14 +226,8 @@ int main(int argc, char *argv[]) {
                   "prey-maybe-predator");
 
 // -- -- -- -- -- -- SPECIFIC TO THE NOVELTY EXTENSION: -- -- -- -- -- -- --
-  GAGA::NoveltyExtension<GA> nov;  // novelty extension instance
-  // Distance function (compares 2 signatures). Here a simple Euclidian distance.
-  auto euclidianDist = [](const auto& fpA, const auto& fpB) {
-      double sum = 0;
-      for (size_t i = 0; i < fpA.size(); ++i) sum += std::pow(fpA[i] - fpB[i], 2);
-      return sqrt(sum);
-  };
-  nov.setComputeSignatureDistanceFunction(euclidianDist);
+  simu::IndexedNoveltyExtension<GA> nov;  // novelty extension instance
+  // Euclidian distance between signatures (set by the indexed extension)
   nov.K = 10;  // size of the neighbourhood to compute novelty.
   //(Novelty = avg dist to the K Nearest Neighbors)
 
@@ -270,9 +284,12 @@ int main(int argc, char *argv[]) {
     ga.step(success);
   }
 
-  stdfs::create_directory_symlink(
-    GAGA::concat("gen", ga.getCurrentGenerationNumber()-1),
-    ga.getSaveFolder() / "gen_last");
+  if (packed)
+    archive();
+  else
+    stdfs::create_directory_symlink(
+      GAGA::concat("gen", ga.getCurrentGenerationNumber()-1),
+      ga.getSaveFolder() / "gen_last");
 
   // ===========================================================================
   // == Post-evolution
@@ -1,4 +1,6 @@
 #include "indevaluator.h"
+#include "../../ga/archive.h"
+#include "../../simu/allocations.h"
 
 namespace simu {
 
@@ -115,6 +117,8 @@ std::string IndEvaluator::specToString (const Specs s, int lesion) {
 }
 
 void IndEvaluator::operator() (Ind &ind, int) {
+  Trace::Span span ("evaluation", "ga", ind.id.second);
+  Allocations::Scope allocations;
   float totalScore = 0;
 
 #ifndef NDEBUG
@@ -132,7 +136,8 @@ void IndEvaluator::operator() (Ind &ind, int) {
 
       std::string specStr = specToString(spec, lesion);
 
-      Simulation simulation;
+      Simulation::Lease lease;
+      Simulation &simulation = *lease;
       Scenario scenario (spec, simulation);
 
       scenario.init(ind.dna);
@@ -352,6 +357,7 @@ void IndEvaluator::operator() (Ind &ind, int) {
      ind.stats[Specs::toString(spec)] = 0;
 
   ind.fitnesses["fitness"] = totalScore;
+  allocations.exportTo(ind.stats);
 
   if (!logsSavePrefix.empty()) {
     std::ofstream ofs (logsSavePrefix / "scores.dat");
@@ -362,10 +368,16 @@ void IndEvaluator::operator() (Ind &ind, int) {
 }
 
 IndEvaluator::Ind IndEvaluator::fromJsonFile(const std::string &path) {
-  std::ifstream t(path);
-  std::stringstream buffer;
-  buffer << t.rdbuf();
-  auto o = nlohmann::json::parse(buffer.str());
+  nlohmann::json o;
+  if (ArchiveReader::isLocator(path))
+    o = ArchiveReader::loadIndividual(path);
+
+  else {
+    std::ifstream t(path);
+    std::stringstream buffer;
+    buffer << t.rdbuf();
+    o = nlohmann::json::parse(buffer.str());
+  }
 
   if (o.count("dna")) // assuming this is a gaga individual
     return Ind(o);
@@ -340,29 +340,7 @@ void Scenario::init(Genome genome) {
 void Scenario::applyLesions(int lesions) {
   if (lesions == 0) return;
   std::cout << "Applying lesion type: " << lesions;
-
-  uint count = 0;
-  for (auto &ptr: _subject->brain().neurons()) {
-    phenotype::ANN::Neuron &n = *ptr;
-    for (auto it=n.links().begin(); it!=n.links().end(); ) {
-      phenotype::ANN::Neuron &tgt = *(it->in.lock());
-      if (tgt.type == phenotype::ANN::Neuron::I
-          && (lesions == 3
-            || (lesions == 1 && tgt.pos.y() < -.75)   // deactivate vision
-            || (lesions == 2 && tgt.pos.y() >= -.75)  // deactivate audition
-            || (n.flags == 1024 && ( // deactivate amygdala inputs
-                 (lesions == 4 && tgt.pos.y() == -1)    // deactivate red
-              || (lesions == 5 && tgt.pos.y() == -.75))))) { // deactivate noise audition
-        it = n.links().erase(it);
-        count++;
-//        std::cerr << "Deactivated " << tgt.pos << " -> " << n.pos << "\n";
-      } else {
-        ++it;
-//        std::cerr << "Kept " << tgt.pos << " -> " << n.pos << " (" << n.flags << ")\n";
-      }
-    }
-  }
-
+  uint count = Critter::applyLesions(_subject->brain(), lesions);
   std::cout << " (" << count << " links deleted)\n";
 }
 
@@ -1,6 +1,8 @@
 #include <csignal>
 
 #include "indevaluator.h"
+#include "../../ga/novelty.hpp"
+#include "../../ga/steadystate.hpp"
 #include "kgd/external/cxxopts.hpp"
 
 void sigint_manager (int) {
@@ -52,6 +54,9 @@ int main(int argc, char *argv[]) {
   Verbosity verbosity = Verbosity::SHOW;
   int gagaVerbosity = 1;
   bool novelty = true;
+  bool async = false;
+  bool packed = false;
+  bool arenas = false;
 
 //  std::string load;
 
@@ -81,6 +86,12 @@ int main(int argc, char *argv[]) {
     ("gaga-verbosity", "GAGA verbosity level. ",
      cxxopts::value(gagaVerbosity))
     ("no-novelty", "Disable novelty fitness")
+    ("pack", "Store elites, populations and stats in a single packed archive"
+             " (see splinoids-archive) instead of per-generation files")
+    ("arenas", "Run each individual's fights at once in a single simulation"
+               " (one arena per opponent)")
+    ("async", "Asynchronous steady-state evolution (no generational barrier,"
+              " generations are counted in epochs of team-count evaluations)")
 
     ("f,data-folder", "Folder under which to store the computational outputs",
      cxxopts::value(outputFolder))
@@ -118,6 +129,9 @@ int main(int argc, char *argv[]) {
   }
 
   novelty = (!result.count("no-novelty"));
+  async = result.count("async");
+  packed = result.count("pack");
+  arenas = result.count("arenas");
 
   stdfs::path dataFolder = stdfs::weakly_canonical(outputFolder);
 #ifndef CLUSTER_BUILD
@@ -182,12 +196,20 @@ int main(int argc, char *argv[]) {
 
   phylogeny::GIDManager gidManager;
   simu::Evaluator eval;
+  eval.packArenas = arenas;
 
   using GA = simu::Evaluator::GA;
   struct Evolution {
     std::string name;
     GA ga;
-    GAGA::NoveltyExtension<GA> nov;
+    simu::IndexedNoveltyExtension<GA> nov;
+    simu::SteadyStateGA<Ind> sga;
+    rng::FastDice dice; // Only drawn from under sga's lock
+    simu::ArchiveWriter pack;
+    struct {
+      std::mutex mutex;
+      std::map<decltype(Ind::id), simu::Evaluator::Inds> map;
+    } opponents;  // Champions faced by individuals under (split) evaluation
     Evolution (void) : name("NA") {}
   };
 
@@ -223,6 +245,10 @@ int main(int argc, char *argv[]) {
 
     ga.disableGenerationHistory();
     if (gagaSavePopulations <= 0) ga.disablePopulationSave();
+    if (packed) {
+      ga.setNbSavedElites(0);
+      ga.disablePopulationSave();
+    }
 
     ga.setSaveFolderGenerator([&evo, dataFolder] (auto) {
       return dataFolder / evo.name;
@@ -234,6 +260,7 @@ int main(int argc, char *argv[]) {
                 << utils::CurrentTime{} << "\n";
 
       auto gen = ga.getCurrentGenerationNumber();
+      simu::Trace::instant("generation", "ga", gen);
 #ifndef CLUSTER_BUILD
       if (gen == 0 && p == 0) symlink_as_last(ga.getSaveFolder().parent_path());
 #endif
@@ -271,14 +298,7 @@ int main(int argc, char *argv[]) {
 
   // -- -- -- -- -- -- SPECIFIC TO THE NOVELTY EXTENSION: -- -- -- -- -- -- --
     auto &nov = evolutions[p].nov;
-    // Distance function (compares 2 signatures). Here a simple Euclidian distance.
-    auto euclidianDist = [](const auto& fpA, const auto& fpB) {
-        double sum = 0;
-        for (size_t i = 0; i < fpA.size(); ++i)
-          sum += std::pow(fpA[i] - fpB[i], 2);
-        return sqrt(sum);
-    };
-    nov.setComputeSignatureDistanceFunction(euclidianDist);
+    // Euclidian distance between signatures (set by the indexed extension)
     nov.K = 10;  // size of the neighbourhood to compute novelty.
     //(Novelty = avg dist to the K Nearest Neighbors)
     nov.saveArchiveEnabled = false;
@@ -321,54 +341,168 @@ int main(int argc, char *argv[]) {
   auto start = simu::Simulation::now();
   int success = 0;
 
-  for (uint i=0; i<generations && !simu::Evaluator::aborted; i++) {
-    // Update previous champions archive
+  if (async) {
+    // Each population evolves on its own thread, fighting against the current
+    // champions of the others
+    std::mutex gidMutex;
     for (uint p = 0; p < populations; p++) {
-      auto &ga = evolutions[p].ga;
-      auto gen = ga.getCurrentGenerationNumber();
+      Evolution &evo = evolutions[p];
+      GA &ga = evo.ga;
+      auto &sga = evo.sga;
+      sga.setPopSize(popSize);
+      sga.setNbThreads(threads / populations);
+      sga.setTournamentSize(4);
+      sga.setObjective("mk");
+      sga.setEvaluatorName("POP " + evo.name);
+      sga.setSaveFolder(dataFolder / evo.name);
+      sga.setSavePopulations(gagaSavePopulations > 0);
+      sga.setVerbosity(gagaVerbosity);
+      sga.setAbortFlag(&simu::Evaluator::aborted);
+      sga.usePackedArchive(packed);
+      if (novelty)  sga.useNovelty(evo.nov.K);
+
+      // Populations run concurrently: each draws from its own dice, seeded
+      // from the main one for reproducible streams
+      evo.dice.reset(dice(0u, std::numeric_limits<uint>::max()));
+      sga.setMutateMethod([&evo, &gidManager, &gidMutex](Team &t) {
+        std::unique_lock<std::mutex> lock (gidMutex);
+        auto &g = t.genome;
+        g.mutate(evo.dice);
+        g.gdata.updateAfterCloning(gidManager);
+      });
 
-      bool first = (gen == 0);
-      auto c = first ? ga.population[0]
-                     : ga.getLastGenElites(1).at("mk").front();
-      if (first)  c.fitnesses["mk"] = NAN;
+      // Every member of the team is simulated
+      sga.setCostEstimator([] (const Ind &i) {
+        return i.dna.size * simu::Critter::complexity(i.dna.genome);
+      });
+
+      const auto currentOpponents = [&evolutions, &lastChampions, p] {
+        simu::Evaluator::Inds opponents;
+        for (uint p_ = 0; p_ < evolutions.size(); p_++) {
+          if (p_ == p)  continue;
+          const auto &other = evolutions[p_].sga;
+          if (other.getCurrentGenerationNumber() > 0)
+                opponents.push_back(other.champion());
+          else  opponents.push_back(lastChampions[p_]);
+        }
+        return opponents;
+      };
+
+      if (populations > 2) {
+        // One task per opponent. All kombats of an individual must face the
+        // same champions: these are drawn by the first one to start
+        auto &cache = evo.opponents;
+        const auto opponentsOf = [&cache, currentOpponents] (const Ind &i) {
+          std::unique_lock<std::mutex> lock (cache.mutex);
+          auto it = cache.map.find(i.id);
+          if (it == cache.map.end())
+            it = cache.map.emplace(i.id, currentOpponents()).first;
+          return it->second;
+        };
+
+        sga.setSplitEvaluator(populations-1,
+                              [&eval, opponentsOf] (Ind &i, uint k) {
+          eval(i, opponentsOf(i), k);
+        }, [&cache] (Ind &i, const simu::Evaluator::Inds &kombats) {
+          simu::Evaluator::merge(i, kombats);
+          std::unique_lock<std::mutex> lock (cache.mutex);
+          cache.map.erase(i.id);
+        });
+
+      } else
+        sga.setEvaluator([&eval, currentOpponents] (Ind &i) {
+          eval(i, currentOpponents());
+        });
+
+      // Same random initial population as the generational mode
+      sga.initPopulation([&ga, i = 0u] () mutable {
+        return ga.population[i++].dna;
+      });
 
-      lastChampions[p] = c;
+      lastChampions[p] = ga.population[0];
+      lastChampions[p].fitnesses["mk"] = NAN;
+
+      stdfs::create_directories(sga.getSaveFolder());
     }
 
-    if (i == generations-1)
-      for (uint p = 0; p < populations; p++)
-        evolutions[p].nov.saveArchiveEnabled = true;
+#ifndef CLUSTER_BUILD
+    symlink_as_last(dataFolder);
+#endif
+
+    std::vector<std::thread> runners;
+    for (Evolution &evo: evolutions)
+      runners.emplace_back([&evo, generations] {
+        evo.sga.run(generations, evo.dice);
+      });
+    for (std::thread &t: runners) t.join();
 
     for (uint p = 0; p < populations; p++) {
-      std::vector<Ind> opponents; // Prepare competitors for each population
-      for (uint p_ = 0; p_ < populations; p_++)
-        if (p_ != p) opponents.push_back(lastChampions[p_]);
+      const auto &sga = evolutions[p].sga;
+      auto epochs = sga.getCurrentGenerationNumber();
+      if (epochs == 0)  continue;
+      if (!packed)
+        stdfs::create_directory_symlink(GAGA::concat("gen", epochs-1),
+                                        sga.getSaveFolder() / "gen_last");
+      success += (sga.champion().fitnesses.at("mk") >= 0);
+    }
 
-      GA &ga = evolutions[p].ga;
-      ga.setEvaluator([&eval, &opponents] (auto &i, auto) {
-          eval(i, opponents);
-      }, "mortal-kombat");
-
-      ga.step();
-
-      if (gagaSavePopulations == -1 && i > 0) {
-        stdfs::path previousPop = ga.getSaveFolder();
-        previousPop /= utils::mergeToString("gen", i-1);
-        previousPop /= utils::mergeToString("pop", i-1, ".pop");
-        std::cerr << "Removing pre-evolution cached population\n";
-        stdfs::remove(previousPop);
+  } else {
+    for (uint i=0; i<generations && !simu::Evaluator::aborted; i++) {
+      // Update previous champions archive
+      for (uint p = 0; p < populations; p++) {
+        auto &ga = evolutions[p].ga;
+        auto gen = ga.getCurrentGenerationNumber();
+
+        bool first = (gen == 0);
+        auto c = first ? ga.population[0]
+                       : ga.getLastGenElites(1).at("mk").front();
+        if (first)  c.fitnesses["mk"] = NAN;
+
+        lastChampions[p] = c;
+      }
+
+      if (i == generations-1)
+        for (uint p = 0; p < populations; p++)
+          evolutions[p].nov.saveArchiveEnabled = true;
+
+      for (uint p = 0; p < populations; p++) {
+        std::vector<Ind> opponents; // Prepare competitors for each population
+        for (uint p_ = 0; p_ < populations; p_++)
+          if (p_ != p) opponents.push_back(lastChampions[p_]);
+
+        GA &ga = evolutions[p].ga;
+        ga.setEvaluator([&eval, &opponents] (auto &i, auto) {
+            eval(i, opponents);
+        }, "mortal-kombat");
+
+        ga.step();
+
+        auto &pack = evolutions[p].pack;
+        if (packed) {
+          if (!pack.isOpen()) pack.open(ga.getSaveFolder());
+          pack.appendGeneration(ga, "mk", 1, gagaSavePopulations > 0);
+        }
+
+        if (gagaSavePopulations == -1 && i > 0) {
+          stdfs::path previousPop = ga.getSaveFolder();
+          previousPop /= utils::mergeToString("gen", i-1);
+          previousPop /= utils::mergeToString("pop", i-1, ".pop");
+          std::cerr << "Removing pre-evolution cached population\n";
+          stdfs::remove(previousPop);
+        }
       }
     }
-  }
 
-  for (uint p = 0; p < populations; p++) {
-    GA &ga = evolutions[p].ga;
-    stdfs::create_directory_symlink(
-      GAGA::concat("gen", ga.getCurrentGenerationNumber()-1),
-      ga.getSaveFolder() / "gen_last");
+    for (uint p = 0; p < populations; p++) {
+      GA &ga = evolutions[p].ga;
+      if (!packed)
+        stdfs::create_directory_symlink(
+          GAGA::concat("gen", ga.getCurrentGenerationNumber()-1),
+          ga.getSaveFolder() / "gen_last");
 
-    success +=
-      (ga.getLastGenElites(1).at("mk").front().fitnesses.at("mk") >= 0);
+      success +=
+        (ga.getLastGenElites(1).at("mk").front().fitnesses.at("mk") >= 0);
+    }
   }
 
   // ===========================================================================
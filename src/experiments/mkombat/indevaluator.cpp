@@ -1,4 +1,6 @@
 #include "indevaluator.h"
+#include "../../ga/archive.h"
+#include "../../simu/allocations.h"
 
 namespace simu {
 
@@ -453,6 +455,62 @@ void Evaluator::operator () (Ind &ind, const Inds &opps) {
   ind.infos = params.opponentsIds();
 }
 
+void Evaluator::operator () (Ind &ind, const Inds &opps, uint i) {
+  Params params = Params::fromInds(ind, opps);
+  params.kombat = i;
+  operator() (params);
+  ind = params.ind;
+  ind.infos = params.opponentsIds();
+}
+
+void Evaluator::merge (Ind &ind, const Inds &kombats) {
+  static const uint H = footprintSize(0), K = footprintSize(1) - H;
+  const uint n = kombats.size();
+  std::vector<float> scores (n);
+  Footprint footprint (footprintSize(n));
+
+  // Subject specifics are identical in every kombat
+  auto it = std::copy(kombats[0].signature.begin(),
+                      kombats[0].signature.begin() + H, footprint.begin());
+
+  ind.stats.clear();
+  for (uint i=0; i<n; i++) {
+    const Ind &k = kombats[i];
+    assert(k.signature.size() == H + K);
+    it = std::copy(k.signature.begin() + H, k.signature.end(), it);
+    scores[i] = k.fitnesses.at("mk");
+
+    for (const auto &p: k.stats) {
+      if (p.first == "wtime" || p.first == "stime"
+          || p.first == "allocs" || p.first == "alloc_bytes")
+        ind.stats[p.first] += p.second;
+      else if (p.first == "peak_bytes")
+        ind.stats[p.first] = std::max(ind.stats[p.first], p.second);
+      else
+        ind.stats[p.first] = p.second;
+    }
+  }
+
+  ind.signature = footprint;
+  ind.fitnesses["mk"] = fitness(scores);
+  if (n > 1)  ind.stats["stime"] = float(ind.stats["stime"]) / n;
+  ind.infos = kombats[0].infos;
+}
+
+float Evaluator::fitness (const std::vector<float> &scores) {
+  const uint n = scores.size();
+  if (n == 1)
+    return scores[0];
+
+  else if (n == 2)
+    return 2.f * std::min(scores[0], scores[1]) / 3.f
+         + 1.f * std::max(scores[0], scores[1]) / 3.f;
+
+  else
+    utils::Thrower("mk fitness not defined for n = ", n, " > 2");
+  return NAN;
+}
+
 uint Evaluator::footprintSize(uint evaluations) {
   static constexpr auto NS = 2*Critter::SPLINES_COUNT;
   return NS             // splines health at start
@@ -490,6 +548,8 @@ std::vector<std::string> Evaluator::footprintFields (uint evaluations) {
 }
 
 void Evaluator::operator() (Params &params) {
+  simu::Trace::Span span ("evaluation", "ga", params.ind.id.second);
+  simu::Allocations::Scope allocations;
   std::array<bool,2> brainless;
 
 //  using utils::operator<<;
@@ -497,25 +557,22 @@ void Evaluator::operator() (Params &params) {
 
   Ind &ind = params.ind;
   const uint n = params.opps.size();
+  const bool single = (params.kombat >= 0);
   std::vector<float> scores (n);
-  Footprint footprint (footprintSize(n));
+  Footprint footprint (footprintSize(single ? 1 : n));
 
   ind.stats["stime"] = 0;
 
-  uint f = 0;
-  for (uint i=0; i<n; i++) {
-    Simulation simulation;
-    Scenario scenario (simulation, params.teamSize);
-
-    scenario.init(params.scenarioParams(i));
+  const auto t0_avg = [] (Scenario &s, auto f, auto... args) {
+    return simu::avg(s.teams()[0], f, args...);
+  };
+  using SSide = Critter::Side;
 
+  uint f = 0;
+  const auto starting = [&] (Scenario &scenario) {
     brainless = scenario.brainless();
 
-    const auto t0_avg = [&scenario] (auto f, auto... args) {
-      return simu::avg(scenario.teams()[0], f, args...);
-    };
-    using SSide = Critter::Side;
-    if (i == 0) { // save subject specifics at the first evaluation
+    if (f == 0) { // save subject specifics at the first evaluation
       ind.stats["brain"] = !brainless[0];
 
       phenotype::ANN &b = scenario.subject()->brain();
@@ -526,10 +583,61 @@ void Evaluator::operator() (Params &params) {
 
       for (SSide s: {SSide::LEFT, SSide::RIGHT})
         for (uint j=0; j<Critter::SPLINES_COUNT; j++)
-          footprint[f++] = t0_avg(&Critter::splineHealth, j, s);
-      footprint[f++] = t0_avg(&Critter::mass);
-      footprint[f++] = t0_avg(&Critter::momentOfInertia);
+          footprint[f++] = t0_avg(scenario, &Critter::splineHealth, j, s);
+      footprint[f++] = t0_avg(scenario, &Critter::mass);
+      footprint[f++] = t0_avg(scenario, &Critter::momentOfInertia);
     }
+  };
+
+  // Outcomes are stored in opponent order, whatever the order of completion
+  static const uint H = footprintSize(0), K = footprintSize(1) - H;
+  const auto over = [&] (uint i, Scenario &scenario, float duration) {
+    scores[i] = scenario.score();
+
+    if (n > 1) ind.stats[utils::mergeToString("mk", i)] = scores[i];
+
+    ind.stats["stime"] += Scenario::DURATION - duration;
+
+//    const auto &autopsies = scenario.autopsies();
+//    lhs_i.stats["injury"] = autopsies[1][Scenario::DeathCause::INJURY];
+//    lhs_i.stats["starvation"] = 1-autopsies[1][Scenario::DeathCause::STARVATION];
+
+    uint fi = H + (single ? 0 : i) * K;
+    footprint[fi++] = t0_avg(scenario, &Critter::bodyHealth);
+    for (SSide s: {SSide::LEFT, SSide::RIGHT})
+      for (uint j=0; j<Critter::SPLINES_COUNT; j++)
+        footprint[fi++] = t0_avg(scenario, &Critter::splineHealth, j, s);
+    footprint[fi++] = t0_avg(scenario, &Critter::x);
+    footprint[fi++] = t0_avg(scenario, &Critter::y);
+  };
+
+  if (packArenas && !single && n > 1 && params.flags.none()
+      && logsSavePrefix.empty() && annTagsFile.empty()) {
+    Simulation::Lease lease;
+    Arenas arenas (*lease, params.teamSize);
+
+    std::vector<Scenario::Params> sparams;
+    for (uint i=0; i<n; i++)  sparams.push_back(params.scenarioParams(i));
+    arenas.init(sparams);
+
+    for (uint i=0; i<n; i++)  starting(arenas[i]);
+
+    auto start_time = Simulation::now();
+    arenas.run(over, aborted);
+    ind.stats["wtime"] += Simulation::durationFrom(start_time);
+
+    f += n * K;
+
+  } else for (uint i=0; i<n; i++) {
+    if (single && i != uint(params.kombat))  continue;
+
+    Simulation::Lease lease;
+    Simulation &simulation = *lease;
+    Scenario scenario (simulation, params.teamSize);
+
+    scenario.init(params.scenarioParams(i));
+
+    starting(scenario);
 
     /// Modular ANN
     if (!logsSavePrefix.empty() && !annTagsFile.empty()) {
@@ -558,37 +666,22 @@ void Evaluator::operator() (Params &params) {
       if (!logsSavePrefix.empty()) logging_step(&log, scenario);
     }
 
-    scores[i] = scenario.score();
-
-    if (n > 1) ind.stats[utils::mergeToString("mk", i)] = scores[i];
-
     ind.stats["wtime"] += Simulation::durationFrom(start_time);
-    ind.stats["stime"] += Scenario::DURATION - duration(simulation);
-
-//    const auto &autopsies = scenario.autopsies();
-//    lhs_i.stats["injury"] = autopsies[1][Scenario::DeathCause::INJURY];
-//    lhs_i.stats["starvation"] = 1-autopsies[1][Scenario::DeathCause::STARVATION];
 
-    footprint[f++] = t0_avg(&Critter::bodyHealth);
-    for (SSide s: {SSide::LEFT, SSide::RIGHT})
-      for (uint i=0; i<Critter::SPLINES_COUNT; i++)
-        footprint[f++] = t0_avg(&Critter::splineHealth, i, s);
-    footprint[f++] = t0_avg(&Critter::x);
-    footprint[f++] = t0_avg(&Critter::y);
+    over(i, scenario, duration(simulation));
+    f += K;
   }
 
-  assert(f == footprintSize(n));
+  assert(f == footprint.size());
   ind.signature = footprint;
+  allocations.exportTo(ind.stats);
 
-  if (n == 1) {
-    ind.fitnesses["mk"] = scores[0];
+  if (single) {
+    ind.fitnesses["mk"] = scores[params.kombat];
+    return;
+  }
 
-  } else if (n == 2) {
-    ind.fitnesses["mk"] =
-        2.f * std::min(scores[0], scores[1]) / 3.f
-      + 1.f * std::max(scores[0], scores[1]) / 3.f;
-  } else
-    utils::Thrower("mk fitness not defined for n = ", n, " > 2");
+  ind.fitnesses["mk"] = fitness(scores);
 
   if (n > 1) {
     ind.stats["stime"] = float(ind.stats["stime"]) / n;
@@ -637,13 +730,20 @@ void Evaluator::dumpStats(const stdfs::path &dna,
 }
 
 Evaluator::Ind Evaluator::fromJsonFile(const std::string &path) {
-  std::ifstream t(path);
-  if (!t) utils::Thrower("Error while opening ", path);
+  nlohmann::json o;
+  if (ArchiveReader::isLocator(path))
+    o = ArchiveReader::loadIndividual(path);
+
+  else {
+    std::ifstream t(path);
+    if (!t) utils::Thrower("Error while opening ", path);
 
-  std::stringstream buffer;
-  buffer << t.rdbuf();
+    std::stringstream buffer;
+    buffer << t.rdbuf();
+
+    o = nlohmann::json::parse(buffer.str());
+  }
 
-  auto o = nlohmann::json::parse(buffer.str());
   if (o.count("dna")) // assuming this is a gaga individual
     return Ind(o);
   else
@@ -31,7 +31,9 @@ struct Evaluator {
     Scenario::Params::Flags flags;
 //    bool neutralFirst;
 
-    Params (Ind i) : ind(i) {}
+    int kombat;   ///< If positive, only fight against this opponent
+
+    Params (Ind i) : ind(i), kombat(-1) {}
 
     static Params fromArgv (const std::string &lhsArg,
                             const std::vector<std::string> &rhsArgs,
@@ -55,6 +57,14 @@ struct Evaluator {
   // Regular combat between individuals
   void operator() (Ind &ind, const Inds &opp);
 
+  // Single combat against opp[i] (to be merged with the others)
+  void operator() (Ind &ind, const Inds &opp, uint i);
+
+  // Rebuilds fitness, footprint and stats from single combats
+  static void merge (Ind &ind, const Inds &kombats);
+
+  static float fitness (const std::vector<float> &scores);
+
   // Actual evaluator
   void operator() (Params &params);
 
@@ -79,6 +89,10 @@ struct Evaluator {
 
   stdfs::path logsSavePrefix, annTagsFile;
 
+  /// Whether to run all of an individual's regular fights at once, in the
+  /// arenas of a single simulation (see Arenas). Ignored when logging
+  bool packArenas = false;
+
   std::vector<std::unique_ptr<phenotype::ModularANN>> manns;
 
 //  std::vector<int> lesions;
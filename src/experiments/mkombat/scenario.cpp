@@ -1,4 +1,5 @@
 #include "scenario.h"
+#include "../../genotype/codec.h"
 
 namespace simu {
 
@@ -13,6 +14,24 @@ void from_json (const nlohmann::json &j, Team &t) {
   t.genome = j[1].get<decltype(t.genome)>();
 }
 
+std::string Team::serialize (void) const {
+  return genotype::Codec::armor(toBinary());
+}
+
+Team::Team (const std::string &str) {
+  using Codec = genotype::Codec;
+  if (Codec::isArmored(str))
+    size = Codec::decodeTeam(Codec::unarmor(str), genome);
+  else if (Codec::isBinary(str))
+    size = Codec::decodeTeam(str, genome);
+  else
+    *this = nlohmann::json::parse(str);
+}
+
+std::string Team::toBinary (void) const {
+  return genotype::Codec::encodeTeam(genome, size);
+}
+
 Team Team::fromFile (const stdfs::path &p) {
   return nlohmann::json::parse(utils::readAll(p));
 }
@@ -50,7 +69,7 @@ genotype::Environment Scenario::environmentGenome (uint tSize, bool eval) {
 // =============================================================================
 
 Scenario::Scenario (Simulation &simulation, uint tSize)
-  : _simulation(simulation), _teamsSize(tSize) {
+  : Scenario(simulation, tSize, -1, {0,0}) {
   simulation.setupCallbacks({
     { Simulation::POST_ENV_STEP,  [this] { postEnvStep(); } },
     {     Simulation::POST_STEP,  [this] { postStep();    } },
@@ -61,6 +80,57 @@ Scenario::Scenario (Simulation &simulation, uint tSize)
   });
 }
 
+Scenario::Scenario (Simulation &simulation, uint tSize, int arena,
+                    const b2Vec2 &origin)
+  : _simulation(simulation), _teamsSize(tSize),
+    _arena(arena), _origin(origin), _finished(false), _aborted(false) {}
+
+bool Scenario::finished (void) const {
+  return _arena < 0 ? _simulation.finished() : (_finished || _aborted);
+}
+
+bool Scenario::aborted (void) const {
+  return _arena < 0 ? _simulation.aborted() : _aborted;
+}
+
+void Scenario::setFinished (bool f) {
+  if (_arena < 0) _simulation._finished = f;
+  else            _finished = f;
+}
+
+void Scenario::abort (void) {
+  if (_arena < 0) _simulation._aborted = true;
+  else if (!_aborted) {
+    // The shared simulation goes on: dump it now (see Simulation::step)
+    _aborted = true;
+    _simulation.dumpFlightRecorder(utils::mergeToString("arena ", _arena,
+                                                        " aborted"));
+  }
+}
+
+void Scenario::makeWalls (void) {
+  const float S = environmentGenome(_teamsSize, false).width,
+              T = .5f * Arenas::WALLS;
+  const float x0 = _origin.x - .5f * S, y0 = _origin.y - .5f * S;
+  for (Obstacle *o: { _simulation.addObstacle(x0-T, y0-T, T, S+2*T),
+                      _simulation.addObstacle(x0+S, y0-T, T, S+2*T),
+                      _simulation.addObstacle(x0, y0-T, S, T),
+                      _simulation.addObstacle(x0, y0+S, S, T) })
+    o->setArena(_arena);
+}
+
+void Scenario::clear (void) {
+  // Survivors' energy goes back to the reserve (which lent it, see
+  // makeCritter) for the budget to hold while other arenas run
+  for (auto &team: _teams) {
+    for (Critter *c: team) {
+      _simulation.environment().modifyEnergyReserve(c->totalStoredEnergy());
+      _simulation.delCritter(c);
+    }
+    team.clear();
+  }
+}
+
 simu::Critter* Scenario::makeCritter (uint team, uint id,
                                       const genotype::Critter &genome) {
 
@@ -81,8 +151,10 @@ simu::Critter* Scenario::makeCritter (uint team, uint id,
   };
 
   auto c = _simulation.addCritter(genome,
-                                  x(team), y(id, _teamsSize),
+                                  _origin.x + x(team),
+                                  _origin.y + y(id, _teamsSize),
                                   team*M_PI, E, .5, true);
+  c->setArena(_arena);
   _teams[team].insert(c);
 
   if (neuralEvaluation()) pin(c, team != 0);
@@ -104,12 +176,20 @@ void Scenario::init(const Params &params) {
     _teamsSize = 1;
   }
 
-  _simulation.init(environmentGenome(_teamsSize, neuralEvaluation()),
-                   {}, commonInitData);
+  if (_arena < 0)
+    _simulation.init(environmentGenome(_teamsSize, neuralEvaluation()),
+                     {}, commonInitData);
+  else
+    makeWalls();
 
   // Deactivate energy monitoring
   if (neuralEvaluation()) _simulation._systemExpectedEnergy = -1;
 
+  // Subjects are driven by hand: maybe skip the physics solve (which also
+  // drops fights and new contacts, see Environment::setKinematic)
+  if (neuralEvaluation() && config::Simulation::kinematicEvaluations())
+    _simulation.environment().setKinematic(true);
+
   if (params.lhs.size != _teamsSize)
     std::cerr << "Provided lhs team has size " << params.lhs.size
               << " instead of " << _teamsSize << "\n";
@@ -209,7 +289,7 @@ void Scenario::postEnvStep(void) {
     for (const Critter *c: t) {
       auto v = c->body().GetLinearVelocity().Length();
       if (v > 10) {
-        _simulation._aborted = true;
+        abort();
         std::cerr << CID(c) << " has improbable linear velocity of "
                   << v << "m/s. Aborting!" << std::endl;
       }
@@ -312,7 +392,7 @@ void Scenario::postStep(void) {
     if (awake)  break;
   }
 
-  _simulation._finished = casualty || !awake || (t >= timeout);
+  setFinished(casualty || !awake || (t >= timeout));
 }
 
 void Scenario::preDelCritter(Critter *c) {
@@ -337,7 +417,7 @@ void Scenario::preDelCritter(Critter *c) {
 }
 
 float Scenario::score (void) const {
-  if (_simulation._aborted) return -4;
+  if (aborted()) return -4;
 
   std::array<double,2> healths;
   float score;
@@ -395,4 +475,73 @@ std::array<bool,2> Scenario::brainless(void) const {
   return b;
 }
 
+// =============================================================================
+
+Arenas::Arenas (Simulation &simulation, uint tSize)
+  : _simulation(simulation), _teamsSize(tSize) {
+  simulation.setupCallbacks({
+    { Simulation::POST_ENV_STEP,  [this] {
+        for (uint i=0; i<size(); i++)
+          if (!_over[i])  _scenarios[i]->postEnvStep();
+      }
+    },
+    {     Simulation::POST_STEP,  [this] {
+        for (uint i=0; i<size(); i++)
+          if (!_over[i])  _scenarios[i]->postStep();
+      }
+    },
+    { Simulation::PRE_CORPSE_DEL, [this] (Critter *c) {
+        for (auto &s: _scenarios) s->preDelCritter(c);
+      }
+    }
+  });
+}
+
+void Arenas::init (const std::vector<Scenario::Params> &params) {
+  const uint k = params.size();
+  const uint n = std::ceil(std::sqrt(k));
+
+  auto e = Scenario::environmentGenome(_teamsSize, false);
+  const float pitch = e.width + WALLS;
+  e.width = e.height = n * pitch;
+  _simulation.init(e, {}, Scenario::commonInitData);
+
+  _scenarios.clear();
+  _over.assign(k, false);
+  for (uint i=0; i<k; i++) {
+    if (params[i].flags.any())
+      utils::Thrower("Neural evaluations cannot be packed in arenas");
+
+    b2Vec2 origin ((i%n + .5f) * pitch - .5f * e.width,
+                   (i/n + .5f) * pitch - .5f * e.height);
+    _scenarios.push_back(
+      std::make_unique<Scenario>(_simulation, _teamsSize, i, origin));
+    _scenarios.back()->init(params[i]);
+  }
+}
+
+void Arenas::run (const Callback &callback, const std::atomic<bool> &abort) {
+  static const auto &TPS = config::Simulation::ticksPerSecond();
+  const auto close = [this, &callback] (uint i) {
+    callback(i, *_scenarios[i],
+             float(_simulation.currTime().timestamp()) / TPS);
+    _scenarios[i]->clear();
+    _over[i] = true;
+  };
+
+  uint remaining = size();
+  while (remaining > 0 && !_simulation.finished() && !abort) {
+    _simulation.step();
+
+    for (uint i=0; i<size(); i++) {
+      if (_over[i] || !_scenarios[i]->finished()) continue;
+      close(i);
+      remaining--;
+    }
+  }
+
+  // Interrupted
+  for (uint i=0; i<size(); i++)  if (!_over[i])  close(i);
+}
+
 } // end of namespace simu
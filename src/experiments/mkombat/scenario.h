@@ -1,6 +1,8 @@
 #ifndef SCENARIO_H
 #define SCENARIO_H
 
+#include <atomic>
+
 #include "../../simu/simulation.h"
 
 namespace simu {
@@ -20,13 +22,14 @@ struct Team {
   }
 
   // == Gaga methods
-  std::string serialize (void) const {
-    return nlohmann::json(*this).dump();
-  }
+  /// Armored binary (see genotype::Codec). Use toFile for human-readable
+  /// exports
+  std::string serialize (void) const;
 
-  Team (const std::string &json) {
-    *this = nlohmann::json::parse(json);
-  }
+  /// Either armored (from serialize), binary (from toBinary) or json
+  Team (const std::string &str);
+
+  std::string toBinary (void) const;
 
   friend void to_json (nlohmann::json &j, const Team &t);
   friend void from_json (const nlohmann::json &j, Team &t);
@@ -58,6 +61,10 @@ public:
 
   Scenario(Simulation &simulation, uint tSize);
 
+  /// Scenario confined to an arena of a shared simulation (see Arenas)
+  Scenario(Simulation &simulation, uint tSize, int arena,
+           const b2Vec2 &origin);
+
   void init (const Params &params);
   void postEnvStep (void);
   void postStep (void);
@@ -83,6 +90,10 @@ public:
     return _params.flags.any();
   }
 
+  /// Standalone scenarios use the simulation's flags, arena ones their own
+  bool finished (void) const;
+  bool aborted (void) const;
+
   bool hasFlag (Params::Flag f) {
     return _params.flags.test(f);
   }
@@ -117,12 +128,66 @@ private:
 
   uint _testChannel;
 
+  int _arena;       ///< Negative when alone in the simulation
+  b2Vec2 _origin;   ///< Center of the arena
+  bool _finished, _aborted;
+
+  void setFinished (bool f);
+  void abort (void);
+
+  /// Walls around the arena (in place of the environment's edges)
+  void makeWalls (void);
+
+  /// Removes the critters of a finished arena
+  void clear (void);
+
+  friend class Arenas;
+
   simu::Critter* makeCritter (uint team, uint id,
                               const genotype::Critter &genome);
 
   static genotype::Environment environmentGenome (uint tSize, bool eval);
 };
 
+/// Independent (regular) fights sharing one simulation, and thus one b2World,
+/// to amortize the per-world overhead of short fights.
+///
+/// Each fight takes place in its own walled arena and bodies from different
+/// arenas never collide, hear nor see each other (see b2BodyUserData::arena).
+/// Arenas finish (or abort) independently: their critters are then removed
+/// so that the others proceed alone.
+class Arenas {
+public:
+  /// Called on each fight as soon as it is over (before its critters are
+  /// removed), with its duration in seconds
+  using Callback = std::function<void(uint i, Scenario &s, float duration)>;
+
+  Arenas (Simulation &simulation, uint tSize);
+
+  void init (const std::vector<Scenario::Params> &params);
+
+  /// Steps until every fight is over (or abort is raised)
+  void run (const Callback &callback, const std::atomic<bool> &abort);
+
+  uint size (void) const {
+    return _scenarios.size();
+  }
+
+  Scenario& operator[] (uint i) {
+    return *_scenarios[i];
+  }
+
+  /// Space between two arenas (taken by their walls)
+  static constexpr float WALLS = 1;
+
+private:
+  Simulation &_simulation;
+  const uint _teamsSize;
+
+  std::vector<std::unique_ptr<Scenario>> _scenarios;
+  std::vector<bool> _over;
+};
+
 } // end of namespace simu
 
 #endif // SCENARIO_H
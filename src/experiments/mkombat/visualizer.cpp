@@ -165,6 +165,8 @@ int main(int argc, char *argv[]) {
   int trace = -1;
   bool tag = false;
 
+  std::string replay;
+
   cxxopts::Options options("Splinoids (mk-gui-evaluation)",
                            "2D graphical simulation of simplified splinoids "
                            " for evolution in Mortal Kombat conditions");
@@ -233,6 +235,10 @@ int main(int argc, char *argv[]) {
 
     ("tags", "Tag items to facilitate reading",
      cxxopts::value(tag)->implicit_value("true"))
+
+    ("replay", "Loop over a flight recording (dumped by an aborted evaluation"
+               " of the same teams/scenario) instead of simulating",
+     cxxopts::value(replay))
     ;
 
   auto result = options.parse(argc, argv);
@@ -616,10 +622,27 @@ int main(int argc, char *argv[]) {
     v->fitInView(simulation.bounds(), Qt::KeepAspectRatio);
     v->select(nullptr);
 
-    QTimer::singleShot(100, [&v, startspeed] {
-      if (startspeed) v->start(startspeed);
-      else            v->stop();
-    });
+    QTimer replayTimer;
+    simu::FlightRecorder::Recording recording;
+    if (!replay.empty()) {
+      recording = simu::FlightRecorder::load(replay);
+      std::cout << "Replaying " << recording.frames.size() << " steps ("
+                << recording.reason << ")\n";
+
+      uint frame = 0;
+      QObject::connect(&replayTimer, &QTimer::timeout,
+                       [&simulation, &recording, frame] () mutable {
+        if (recording.frames.empty()) return;
+        simulation.replay(recording.frames[frame]);
+        frame = (frame + 1) % recording.frames.size();
+      });
+      replayTimer.start(1000 / config::Simulation::ticksPerSecond());
+
+    } else
+      QTimer::singleShot(100, [&v, startspeed] {
+        if (startspeed) v->start(startspeed);
+        else            v->stop();
+      });
 
 //    using Eval = simu::Evaluator;
 //    auto log = Eval::logging_getData();
@@ -0,0 +1,185 @@
+#include <regex>
+
+#include "archive.h"
+
+namespace simu {
+
+static constexpr int debugArchive = 0;
+
+std::string Archive::eliteFileName (const nlohmann::json &record, uint rank) {
+  std::string objective = record.at("objective");
+  double fitness = record.at("individual").at("fitnesses").at(objective);
+  std::ostringstream oss;
+  oss << objective << "__" << fitness << "_" << rank << ".dna";
+  return oss.str();
+}
+
+// =============================================================================
+// == Writer
+
+void ArchiveWriter::open (const stdfs::path &folder) {
+  stdfs::create_directories(folder);
+  stdfs::path pack = folder / Archive::PACK, index = folder / Archive::INDEX;
+
+  bool exists = stdfs::exists(pack) && stdfs::file_size(pack) > 0;
+  _pack.open(pack, std::ios::binary | std::ios::app);
+  _index.open(index, std::ios::binary | std::ios::app);
+  if (!_pack || !_index)
+    utils::Thrower("Failed to open archive under ", folder);
+
+  if (!exists)
+    _pack.write(Archive::MAGIC, sizeof(Archive::MAGIC))
+         .write(reinterpret_cast<const char*>(&Archive::VERSION), 1);
+  _pack.flush();
+  _offset = stdfs::file_size(pack);
+
+  if (debugArchive)
+    std::cerr << "Opened archive " << pack << " at offset " << _offset << "\n";
+}
+
+void ArchiveWriter::append (Archive::Kind kind, uint generation, uint rank,
+                            const nlohmann::json &payload) {
+  if (!isOpen())  utils::Thrower("Appending to a closed archive");
+
+  auto bytes = nlohmann::json::to_msgpack(payload);
+
+  Archive::RecordHeader h {};
+  h.size = bytes.size();
+  h.generation = generation;
+  h.rank = rank;
+  h.kind = kind;
+  _pack.write(reinterpret_cast<const char*>(&h), sizeof(h));
+  _pack.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  _pack.flush();
+
+  // Index is only updated once the record is safely stored
+  Archive::Entry e {};
+  e.generation = generation;
+  e.rank = rank;
+  e.offset = _offset + sizeof(h);
+  e.size = bytes.size();
+  e.kind = kind;
+  _index.write(reinterpret_cast<const char*>(&e), sizeof(e));
+  _index.flush();
+
+  _offset += sizeof(h) + bytes.size();
+}
+
+// =============================================================================
+// == Reader
+
+ArchiveReader::ArchiveReader (const stdfs::path &path) {
+  _folder = stdfs::is_directory(path) ? path : path.parent_path();
+  stdfs::path pack = _folder / Archive::PACK, index = _folder / Archive::INDEX;
+
+  _pack.open(pack, std::ios::binary);
+  if (!_pack) utils::Thrower("Failed to open archive ", pack);
+
+  char magic [sizeof(Archive::MAGIC)];
+  uint8_t version = 0;
+  _pack.read(magic, sizeof(magic));
+  _pack.read(reinterpret_cast<char*>(&version), 1);
+  if (!_pack || !std::equal(magic, magic+sizeof(magic), Archive::MAGIC))
+    utils::Thrower(pack, " is not an archive");
+  if (version == 0 || version > Archive::VERSION)
+    utils::Thrower("Unsupported archive version ", uint(version));
+
+  std::ifstream ifs (index, std::ios::binary);
+  if (!ifs) utils::Thrower("Missing archive index ", index,
+                           ". Rebuild it with the 'reindex' command");
+
+  // Drop entries whose record did not make it to the pack (interrupted run)
+  auto packSize = stdfs::file_size(pack);
+  Archive::Entry e;
+  while (ifs.read(reinterpret_cast<char*>(&e), sizeof(e)))
+    if (e.offset + e.size <= packSize)
+      _entries.push_back(e);
+}
+
+int ArchiveReader::lastGeneration (void) const {
+  int last = -1;
+  for (const Archive::Entry &e: _entries)
+    last = std::max(last, int(e.generation));
+  return last;
+}
+
+const Archive::Entry* ArchiveReader::find (Archive::Kind kind, int generation,
+                                           uint rank) const {
+  if (generation < 0) generation = lastGeneration();
+
+  // Later records shadow earlier ones (e.g. after a restart)
+  for (auto it = _entries.rbegin(); it != _entries.rend(); ++it)
+    if (it->kind == kind && int(it->generation) == generation
+        && it->rank == rank)
+      return &*it;
+  return nullptr;
+}
+
+nlohmann::json ArchiveReader::read (const Archive::Entry &e) const {
+  std::vector<uint8_t> bytes (e.size);
+  _pack.clear();
+  _pack.seekg(e.offset);
+  _pack.read(reinterpret_cast<char*>(bytes.data()), e.size);
+  if (!_pack) utils::Thrower("Failed to read record at offset ", e.offset);
+  return nlohmann::json::from_msgpack(bytes);
+}
+
+void ArchiveReader::reindex (const stdfs::path &folder) {
+  stdfs::path pack = folder / Archive::PACK, index = folder / Archive::INDEX;
+  std::ifstream ifs (pack, std::ios::binary);
+  if (!ifs) utils::Thrower("Failed to open archive ", pack);
+
+  auto packSize = stdfs::file_size(pack);
+  uint64_t offset = sizeof(Archive::MAGIC) + 1;
+  ifs.seekg(offset);
+
+  std::ofstream ofs (index, std::ios::binary | std::ios::trunc);
+  Archive::RecordHeader h;
+  uint n = 0;
+  while (ifs.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+    offset += sizeof(h);
+    if (offset + h.size > packSize) break; // Truncated record
+
+    Archive::Entry e {};
+    e.generation = h.generation;
+    e.rank = h.rank;
+    e.offset = offset;
+    e.size = h.size;
+    e.kind = h.kind;
+    ofs.write(reinterpret_cast<const char*>(&e), sizeof(e));
+
+    offset += h.size;
+    ifs.seekg(offset);
+    n++;
+  }
+
+  std::cout << "Indexed " << n << " records from " << pack << "\n";
+}
+
+/// <path>:<gen|last>[:<rank>]
+static const std::regex locatorRegex ("(.*):(last|[0-9]+)(?::([0-9]+))?");
+
+bool ArchiveReader::isLocator (const std::string &path) {
+  std::smatch m;
+  if (!std::regex_match(path, m, locatorRegex)) return false;
+  stdfs::path p = m[1].str();
+  return (stdfs::is_directory(p) && stdfs::exists(p / Archive::PACK))
+      || p.filename() == Archive::PACK;
+}
+
+nlohmann::json ArchiveReader::loadIndividual (const std::string &locator) {
+  std::smatch m;
+  if (!std::regex_match(locator, m, locatorRegex))
+    utils::Thrower("'", locator, "' is not an archive locator");
+
+  ArchiveReader reader (m[1].str());
+  int gen = (m[2] == "last") ? -1 : std::stoi(m[2]);
+  uint rank = m[3].matched ? std::stoul(m[3]) : 0;
+
+  const Archive::Entry *e = reader.find(Archive::ELITE, gen, rank);
+  if (!e) utils::Thrower("No elite ", rank, " for generation ", m[2], " in ",
+                         reader.folder());
+  return reader.read(*e).at("individual");
+}
+
+} // end of namespace simu
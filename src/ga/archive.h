@@ -0,0 +1,147 @@
+#ifndef GA_ARCHIVE_H
+#define GA_ARCHIVE_H
+
+#include <fstream>
+
+#include "kgd/external/json.hpp"
+#include "kgd/utils/utils.h"
+
+namespace simu {
+
+/// Append-only storage for everything an evolution run saves (elites,
+/// populations, generation statistics) in two files instead of thousands
+///
+/// - archive.pack: header then records (fixed header + MessagePack payload)
+/// - archive.idx:  one fixed-size Entry per record, for direct access
+///
+/// The index can be rebuilt from the pack alone (see ArchiveReader::reindex)
+/// should a run be interrupted between the two writes.
+///
+/// Individuals are addressed by locators of the form
+///   <folder or pack>:<gen|last>[:<rank>]
+/// which evaluators and visualizers accept wherever a .dna file is expected.
+struct Archive {
+  static constexpr const char *PACK = "archive.pack";
+  static constexpr const char *INDEX = "archive.idx";
+
+  static constexpr char MAGIC [4] = { '\x89', 'S', 'P', 'K' };
+  static constexpr uint8_t VERSION = 1;
+
+  enum Kind : uint8_t {
+    ELITE = 'E',      ///< rank is the elite's rank
+    POPULATION = 'P', ///< rank is the index in the population
+    STATS = 'S'       ///< rank is unused
+  };
+
+  struct Entry {
+    uint32_t generation;
+    uint32_t rank;
+    uint64_t offset;    ///< Of the payload in the pack
+    uint32_t size;      ///< Of the payload
+    Kind kind;
+    uint8_t padding [3];
+  };
+  static_assert(sizeof(Entry) == 24, "Unexpected index entry size");
+
+  /// Fixed header preceding each payload in the pack
+  struct RecordHeader {
+    uint32_t size;
+    uint32_t generation;
+    uint32_t rank;
+    Kind kind;
+    uint8_t padding [3];
+  };
+  static_assert(sizeof(RecordHeader) == 16, "Unexpected record header size");
+
+  /// Name of the individual file GAGA would have written for this elite
+  static std::string eliteFileName (const nlohmann::json &record, uint rank);
+};
+
+class ArchiveWriter {
+public:
+  ArchiveWriter (void) = default;
+
+  /// Opens (or creates) the archive under folder, for appending
+  void open (const stdfs::path &folder);
+
+  bool isOpen (void) const {
+    return _pack.is_open();
+  }
+
+  void append (Archive::Kind kind, uint generation, uint rank,
+               const nlohmann::json &payload);
+
+  /// Elites are stored with the objective they were selected on
+  void appendElite (uint generation, uint rank, const std::string &objective,
+                    const nlohmann::json &individual) {
+    append(Archive::ELITE, generation, rank,
+           {{"objective", objective}, {"individual", individual}});
+  }
+
+  template <typename I>
+  void appendPopulation (uint generation, const std::vector<I> &population) {
+    for (uint i=0; i<population.size(); i++)
+      append(Archive::POPULATION, generation, i, population[i].toJSON());
+  }
+
+  /// Stores the last generation of a GAGA run (elites, statistics and
+  /// maybe population)
+  template <typename GA>
+  void appendGeneration (GA &ga, const std::string &objective,
+                         uint elites, bool population) {
+    uint gen = ga.getCurrentGenerationNumber() - 1;
+    const auto &e = ga.getLastGenElites(elites).at(objective);
+    for (uint i=0; i<e.size(); i++)
+      appendElite(gen, i, objective, e[i].toJSON());
+    if (!ga.genStats.empty())
+      append(Archive::STATS, gen, 0, ga.genStats.back());
+    if (population) appendPopulation(gen, ga.previousGenerations.back());
+  }
+
+private:
+  std::ofstream _pack, _index;
+  uint64_t _offset;
+};
+
+class ArchiveReader {
+public:
+  using Entries = std::vector<Archive::Entry>;
+
+  /// Path is either the folder containing the archive or the pack itself
+  explicit ArchiveReader (const stdfs::path &path);
+
+  const stdfs::path& folder (void) const {
+    return _folder;
+  }
+
+  const Entries& entries (void) const {
+    return _entries;
+  }
+
+  /// -1 if the archive is empty
+  int lastGeneration (void) const;
+
+  /// nullptr if no such record. A negative generation means the last one
+  const Archive::Entry* find (Archive::Kind kind, int generation,
+                              uint rank) const;
+
+  nlohmann::json read (const Archive::Entry &e) const;
+
+  /// Rebuilds the index by scanning the pack
+  static void reindex (const stdfs::path &folder);
+
+  /// Whether this path designates an archived individual (instead of a file)
+  static bool isLocator (const std::string &path);
+
+  /// The individual (in GAGA format) designated by this locator
+  static nlohmann::json loadIndividual (const std::string &locator);
+
+private:
+  stdfs::path _folder;
+  Entries _entries;
+  mutable std::ifstream _pack;
+};
+
+} // end of namespace simu
+
+#endif // GA_ARCHIVE_H
@@ -0,0 +1,306 @@
+#ifndef GA_NOVELTY_HPP
+#define GA_NOVELTY_HPP
+
+#include <cstring>
+#include <queue>
+
+#include "kgd/external/gaga.hpp"
+#include "kgd/external/novelty.hpp"
+
+namespace simu {
+
+/// Euclidian distance between two footprints.
+/// Bit-for-bit identical to the std::pow-based lambda each evolver used to
+/// provide (float difference, double accumulation, in order)
+struct EuclidianDistance {
+  template <typename F>
+  double operator() (const F &lhs, const F &rhs) const {
+    return compute(lhs.data(), rhs.data(), lhs.size());
+  }
+
+  static double compute (const float *lhs, const float *rhs, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+      double d = float(lhs[i] - rhs[i]);
+      sum += d * d;
+    }
+    return std::sqrt(sum);
+  }
+};
+
+/// K-nearest neighbours queries over a fixed set of footprints
+///
+/// Small sets are served by a brute-force search whose first pass uses a
+/// vectorized single-precision kernel to discard far away points. Larger
+/// sets are organized in a vantage-point tree. In both cases the returned
+/// distances are computed by EuclidianDistance so that novelty values are
+/// exactly those of the full distance matrix.
+class NoveltyIndex {
+public:
+  struct Neighbour {
+    uint index;
+    double distance;
+
+    friend bool operator< (const Neighbour &lhs, const Neighbour &rhs) {
+      if (lhs.distance != rhs.distance) return lhs.distance < rhs.distance;
+      return lhs.index < rhs.index;
+    }
+  };
+  using Neighbours = std::vector<Neighbour>;
+
+  /// Above this size the vantage-point tree is used
+  static constexpr uint BRUTE_FORCE_LIMIT = 512;
+
+  NoveltyIndex (void) : _dims(0), _size(0), _root(-1) {}
+
+  template <typename F>
+  void build (const std::vector<const F*> &points) {
+    _size = points.size();
+    _dims = _size > 0 ? points.front()->size() : 0;
+    _data.resize(_size * _dims);
+    for (uint i=0; i<_size; i++) {
+      assert(points[i]->size() == _dims);
+      std::copy(points[i]->begin(), points[i]->end(),
+                _data.begin() + i * _dims);
+    }
+
+    _nodes.clear();
+    _root = -1;
+    if (!bruteForce()) {
+      std::vector<uint> indices (_size);
+      std::iota(indices.begin(), indices.end(), 0);
+      _nodes.reserve(_size);
+      _root = buildNode(indices, 0, _size);
+    }
+  }
+
+  uint size (void) const {
+    return _size;
+  }
+
+  bool bruteForce (void) const {
+    return _size <= BRUTE_FORCE_LIMIT;
+  }
+
+  /// The (at most) k nearest neighbours of point i, itself excluded, sorted
+  /// by increasing distance
+  void knn (uint i, uint k, Neighbours &neighbours) const {
+    neighbours.clear();
+    k = std::min(k, _size - 1);
+    if (k == 0) return;
+
+    if (bruteForce()) bruteForceKNN(i, k, neighbours);
+    else              treeKNN(i, k, neighbours);
+  }
+
+  /// Average distance of point i to its k nearest neighbours
+  double novelty (uint i, uint k) const {
+    Neighbours n;
+    knn(i, k, n);
+    if (n.empty())  return 0;
+
+    double sum = 0;
+    for (const Neighbour &nn: n)  sum += nn.distance;
+    return sum / n.size();
+  }
+
+  double distance (uint i, uint j) const {
+    return EuclidianDistance::compute(point(i), point(j), _dims);
+  }
+
+private:
+  uint _dims, _size;
+  std::vector<float> _data; // row-major footprints
+
+  struct Node {
+    uint point;   // vantage point
+    double mu;    // median distance to the vantage point
+    int inside, outside;
+  };
+  std::vector<Node> _nodes;
+  int _root;
+
+  const float* point (uint i) const {
+    return _data.data() + i * _dims;
+  }
+
+  // ===========================================================================
+  // == Brute force
+
+  /// Single precision squared distance, 4 lanes at a time
+  static float approxSquaredDistance (const float *lhs, const float *rhs,
+                                      uint n) {
+    typedef float v4f __attribute__((vector_size(16)));
+    v4f acc = {0, 0, 0, 0};
+    uint i = 0;
+    for (; i + 4 <= n; i += 4) {
+      v4f a, b;
+      std::memcpy(&a, lhs + i, sizeof(a));
+      std::memcpy(&b, rhs + i, sizeof(b));
+      v4f d = a - b;
+      acc += d * d;
+    }
+    float sum = acc[0] + acc[1] + acc[2] + acc[3];
+    for (; i < n; i++) {
+      float d = lhs[i] - rhs[i];
+      sum += d * d;
+    }
+    return sum;
+  }
+
+  void bruteForceKNN (uint i, uint k, Neighbours &neighbours) const {
+    const float *p = point(i);
+
+    std::vector<Neighbour> approx;
+    approx.reserve(_size - 1);
+    for (uint j=0; j<_size; j++)
+      if (j != i)
+        approx.push_back({j, approxSquaredDistance(p, point(j), _dims)});
+
+    // k-th smallest approximated distance
+    std::nth_element(approx.begin(), approx.begin() + (k-1), approx.end());
+    double threshold = approx[k-1].distance;
+
+    // Single precision sums of n positive terms are within a relative error
+    // gamma of the exact value: keep everything that could be closer than
+    // the true k-th neighbour
+    const double gamma = (_dims + 2) * std::ldexp(1., -23);
+    threshold = threshold * (1 + gamma) / (1 - gamma)
+              + std::numeric_limits<float>::denorm_min();
+
+    for (const Neighbour &n: approx)
+      if (n.distance <= threshold)
+        neighbours.push_back({n.index, distance(i, n.index)});
+
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.resize(k);
+  }
+
+  // ===========================================================================
+  // == Vantage-point tree
+
+  int buildNode (std::vector<uint> &indices, uint begin, uint end) {
+    if (begin >= end) return -1;
+
+    int n = _nodes.size();
+    _nodes.push_back({indices[begin], 0, -1, -1});
+    if (end - begin == 1) return n;
+
+    // First point as vantage point (deterministic), others split on median
+    uint vp = indices[begin];
+    uint median = (begin + 1 + end) / 2;
+
+    std::vector<Neighbour> others;
+    others.reserve(end - begin - 1);
+    for (uint j=begin+1; j<end; j++)
+      others.push_back({indices[j], distance(vp, indices[j])});
+    auto mid = others.begin() + (median - begin - 1);
+    std::nth_element(others.begin(), mid, others.end());
+    for (uint j=begin+1; j<end; j++)  indices[j] = others[j-begin-1].index;
+    double mu = mid->distance;
+
+    int inside = buildNode(indices, begin + 1, median);
+    int outside = buildNode(indices, median, end);
+
+    Node &node = _nodes[n];
+    node.mu = mu;
+    node.inside = inside;
+    node.outside = outside;
+    return n;
+  }
+
+  void treeKNN (uint i, uint k, Neighbours &neighbours) const {
+    std::priority_queue<Neighbour> heap;  // Farthest on top
+    treeSearch(_root, i, k, heap);
+
+    neighbours.resize(heap.size());
+    for (uint j=heap.size(); j>0; j--) {
+      neighbours[j-1] = heap.top();
+      heap.pop();
+    }
+  }
+
+  void treeSearch (int n, uint i, uint k,
+                   std::priority_queue<Neighbour> &heap) const {
+    if (n < 0)  return;
+
+    const Node &node = _nodes[n];
+    double d = distance(i, node.point);
+
+    if (node.point != i) {
+      Neighbour candidate {node.point, d};
+      if (heap.size() < k)
+        heap.push(candidate);
+      else if (candidate < heap.top())
+        heap.pop(), heap.push(candidate);
+    }
+
+    // Slack to protect pruning from rounding errors in the triangle inequality
+    static constexpr double EPS = 1e-9;
+    const auto tau = [&heap, k] {
+      if (heap.size() < k)  return std::numeric_limits<double>::infinity();
+      return heap.top().distance * (1 + EPS) + EPS;
+    };
+
+    if (d < node.mu) {
+      if (d - tau() <= node.mu) treeSearch(node.inside, i, k, heap);
+      if (d + tau() >= node.mu) treeSearch(node.outside, i, k, heap);
+    } else {
+      if (d + tau() >= node.mu) treeSearch(node.outside, i, k, heap);
+      if (d - tau() <= node.mu) treeSearch(node.inside, i, k, heap);
+    }
+  }
+};
+
+/// Novelty extension whose K-nearest neighbours queries are served by a
+/// NoveltyIndex instead of the full (archive+population)^2 distance matrix.
+/// Archive management and saving are inherited from GAGA's extension
+template <typename GA>
+struct IndexedNoveltyExtension : public GAGA::NoveltyExtension<GA> {
+  using Base = GAGA::NoveltyExtension<GA>;
+  using Ind_t = typename GA::Ind_t;
+  using Signature = typename Ind_t::sig_t;
+
+  IndexedNoveltyExtension (void) {
+    Base::setComputeSignatureDistanceFunction(EuclidianDistance());
+  }
+
+  void onRegister (GA &ga) {
+    ga.addPostEvaluationMethod([this] (GA &ga) { updateNovelty(ga); });
+    ga.addPrintStartMethod([this] (const GA&) {
+      std::cout << "  - indexed novelty is enabled (K = " << Base::K << ")"
+                << std::endl;
+    });
+    ga.addSavePopMethod([this] (const GA &ga) {
+      if (Base::saveArchiveEnabled) Base::saveArchive(ga);
+    });
+  }
+
+  void updateNovelty (GA &ga) {
+    auto &archive = Base::archive;
+    auto &population = ga.population;
+
+    std::vector<const Signature*> signatures;
+    signatures.reserve(archive.size() + population.size());
+    for (const Ind_t &i: archive)     signatures.push_back(&i.signature);
+    for (const Ind_t &i: population)  signatures.push_back(&i.signature);
+
+    _index.build(signatures);
+
+    const uint offset = archive.size();
+    for (uint i=0; i<population.size(); i++)
+      population[i].fitnesses["novelty"] = _index.novelty(offset + i, Base::K);
+
+    // Random archive additions, as in the original extension
+    std::uniform_int_distribution<size_t> d (0, population.size() - 1);
+    for (size_t i = 0; i < Base::nbOfArchiveAdditionsPerGeneration; ++i)
+      archive.push_back(population[d(ga.globalRand())]);
+  }
+
+private:
+  NoveltyIndex _index;
+};
+
+} // end of namespace simu
+
+#endif // GA_NOVELTY_HPP
@@ -0,0 +1,537 @@
+#ifndef GA_STEADYSTATE_HPP
+#define GA_STEADYSTATE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <thread>
+
+#include "novelty.hpp"
+#include "archive.h"
+#include "../simu/trace.h"
+
+namespace simu {
+
+/// Asynchronous steady-state evolution
+///
+/// There is no generational barrier: each completed evaluation is
+/// immediately integrated into the population (replacing a poor individual
+/// once it is full) and a new child is bred and dispatched to the freed
+/// worker. Every popSize completed evaluations define an epoch which is
+/// saved with GAGA's layout (genN/ folders with elites and optional
+/// population, gen_stats.csv) so that the analysis scripts keep working, or
+/// in a packed Archive.
+///
+/// A backlog of bred children (at least one per worker) is kept waiting and
+/// dispatched longest-first, so that expensive individuals do not end up alone
+/// at the tail of an epoch. Their cost is predicted from their own complexity
+/// (see setCostEstimator), calibrated by their parent's measured time.
+/// Evaluations made of independent parts (e.g. one per opponent) can be split
+/// to be scheduled separately.
+///
+/// With novelty, a new individual is scored against the archive and the
+/// current population as it is integrated. As the archive and population keep
+/// changing, the population's scores are refreshed at the end of every epoch
+/// (GAGA recomputes them at every generation).
+///
+/// Results depend on the order in which evaluations complete and are thus
+/// not reproducible across runs, even with a fixed seed.
+template <typename Ind>
+class SteadyStateGA {
+public:
+  using DNA = decltype(std::declval<Ind>().dna);
+  using Footprint = decltype(std::declval<Ind>().signature);
+
+  using Evaluator = std::function<void(Ind&)>;
+  using PartialEvaluator = std::function<void(Ind&, uint part)>;
+  using Merger = std::function<void(Ind&, const std::vector<Ind> &parts)>;
+  using Complexity = std::function<double(const Ind &ind)>;
+  using Mutator = std::function<void(DNA&)>;
+  using Initializer = std::function<DNA(void)>;
+  using EpochCallback = std::function<void(uint epoch,
+                                           const std::vector<Ind> &evaluated)>;
+
+  SteadyStateGA (void)
+    : _popSize(0), _threads(1), _tournamentSize(4),
+      _novelty(false), _noveltyK(10), _archiveAdditions(5),
+      _savePopulations(false), _packed(false), _verbosity(1), _parts(1),
+      _epoch(0), _dispatched(0), _completed(0), _maxDispatches(0),
+      _stopping(false), _aborted(nullptr) {}
+
+  void setPopSize (uint n) {            _popSize = n;           }
+  void setNbThreads (uint n) {          _threads = std::max(1u, n); }
+  void setTournamentSize (uint n) {     _tournamentSize = n;    }
+  void setObjective (const std::string &o) {  _objective = o;   }
+  void setEvaluatorName (const std::string &n) { _evaluatorName = n; }
+  void setSaveFolder (const stdfs::path &p) {  _folder = p;     }
+  void setSavePopulations (bool s) {    _savePopulations = s;   }
+  void usePackedArchive (bool p) {      _packed = p;            }
+  void setVerbosity (int v) {           _verbosity = v;         }
+  void setAbortFlag (const std::atomic<bool> *a) {  _aborted = a; }
+
+  void useNovelty (uint K, uint archiveAdditions = 5) {
+    _novelty = true;
+    _noveltyK = K;
+    _archiveAdditions = archiveAdditions;
+  }
+
+  void setEvaluator (const Evaluator &e) {    _evaluate = e;  }
+
+  /// Evaluations are split in n parts, each evaluated (on a copy of the
+  /// individual) as soon as a worker is available. The results are then
+  /// gathered by the merger
+  void setSplitEvaluator (uint n, const PartialEvaluator &e, const Merger &m) {
+    _parts = n;
+    _evaluatePart = e;
+    _merge = m;
+  }
+
+  /// Predicted relative cost of evaluating an individual, from its own genome
+  /// (brain, morphology, ...). Without one, all individuals cost the same
+  void setCostEstimator (const Complexity &c) {  _complexity = c;  }
+
+  /// Cost model: the individual's complexity, converted into a duration with
+  /// its parent's (wall time over complexity) when that was measured
+  double predictedCost (const Ind &ind, const Ind *parent) const {
+    double c = _complexity ? _complexity(ind) : 1;
+    if (!parent)  return c;
+
+    const auto &s = parent->stats;
+    auto it = s.find("wtime");
+    if (it == s.end())  it = s.find("evalTime");
+    if (it == s.end())  return c;
+
+    double cp = _complexity ? _complexity(*parent) : 1;
+    return cp > 0 ? c * it->second / cp : c;
+  }
+  void setMutateMethod (const Mutator &m) {   _mutate = m;    }
+  void setNewEpochFunction (const EpochCallback &c) { _onEpoch = c; }
+
+  const stdfs::path& getSaveFolder (void) const {
+    return _folder;
+  }
+
+  uint getCurrentGenerationNumber (void) const {
+    std::unique_lock<std::mutex> lock (_mutex);
+    return _epoch;
+  }
+
+  /// Thread-safe copy of the best individual (w.r.t. the main objective)
+  Ind champion (void) const {
+    std::unique_lock<std::mutex> lock (_mutex);
+    return _population.at(championIndex());
+  }
+
+  void initPopulation (const Initializer &init) {
+    _initial.clear();
+    for (uint i=0; i<_popSize; i++) _initial.emplace_back(init());
+  }
+
+  /// Runs for the requested number of epochs (i.e. epochs * popSize
+  /// evaluations), initial population included
+  void run (uint epochs, rng::AbstractDice &dice) {
+    std::unique_lock<std::mutex> lock (_mutex);
+    if (_initial.size() != _popSize)
+      utils::Thrower("Steady-state GA: population was not initialized");
+    if ((_parts > 1 ? !(_evaluatePart && _merge) : !_evaluate) || !_mutate)
+      utils::Thrower("Steady-state GA: missing evaluator or mutator");
+
+    _dice = &dice;
+    if (_packed && !_pack.isOpen()) _pack.open(_folder);
+    _maxDispatches = epochs * _popSize;
+    _stopping = false;
+
+    for (Ind &i: _initial) {
+      double cost = predictedCost(i, nullptr);
+      dispatch(std::move(i), cost);
+    }
+    _initial.clear();
+    _epochStart = std::chrono::steady_clock::now();
+    lock.unlock();
+
+    std::vector<std::thread> workers;
+    for (uint t=0; t<_threads; t++)
+      workers.emplace_back([this] { work(); });
+    for (std::thread &t: workers) t.join();
+
+    if (_verbosity > 0 && aborted())
+      std::cout << "Steady-state evolution interrupted after " << _completed
+                << " evaluations\n";
+  }
+
+private:
+  uint _popSize, _threads, _tournamentSize;
+  std::string _objective, _evaluatorName;
+  stdfs::path _folder;
+
+  bool _novelty;
+  uint _noveltyK, _archiveAdditions;
+  std::vector<Footprint> _archive;
+  NoveltyIndex _index;
+  std::vector<double> _distances;
+
+  bool _savePopulations, _packed;
+  ArchiveWriter _pack;
+  int _verbosity;
+
+  Evaluator _evaluate;
+  uint _parts;
+  PartialEvaluator _evaluatePart;
+  Merger _merge;
+  Complexity _complexity;
+  Mutator _mutate;
+  EpochCallback _onEpoch;
+
+  std::vector<Ind> _initial, _population, _epochEvaluations;
+
+  /// Columns of gen_stats.csv, fixed when its header is written (or read
+  /// back from it when appending)
+  std::vector<std::string> _genStatsColumns;
+
+  /// An individual being evaluated (maybe in multiple parts)
+  struct Pending {
+    Ind ind;
+    std::vector<Ind> parts;
+    uint remaining;
+    long duration;
+  };
+  std::map<uint, Pending> _pending;
+
+  /// A unit of work: part of the evaluation of a pending individual
+  struct Task {
+    double cost;
+    uint ticket, part;
+
+    /// Most expensive first, then oldest first
+    friend bool operator< (const Task &lhs, const Task &rhs) {
+      if (lhs.cost != rhs.cost) return lhs.cost < rhs.cost;
+      if (lhs.ticket != rhs.ticket) return lhs.ticket > rhs.ticket;
+      return lhs.part > rhs.part;
+    }
+  };
+  std::priority_queue<Task> _queue;
+
+  uint _epoch, _dispatched, _completed, _maxDispatches;
+  bool _stopping;
+  const std::atomic<bool> *_aborted;
+  rng::AbstractDice *_dice;
+
+  std::chrono::steady_clock::time_point _epochStart;
+
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+
+  bool aborted (void) const {
+    return _aborted && *_aborted;
+  }
+
+  // ===========================================================================
+  // == Workers
+
+  void work (void) {
+    while (true) {
+      Task task;
+      Ind ind;
+      {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _cv.wait(lock, [this] {
+          return !_queue.empty() || _stopping || aborted();
+        });
+        if (_queue.empty() || aborted()) {
+          _cv.notify_all();
+          return;
+        }
+        task = _queue.top();
+        _queue.pop();
+        ind = _pending.at(task.ticket).ind;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      if (_parts > 1) _evaluatePart(ind, task.part);
+      else            _evaluate(ind);
+      long duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+
+      std::unique_lock<std::mutex> lock (_mutex);
+      if (aborted()) {  // Partial evaluation: discard
+        _cv.notify_all();
+        return;
+      }
+
+      auto it = _pending.find(task.ticket);
+      Pending &p = it->second;
+      p.duration += duration;
+      if (_parts > 1) p.parts[task.part] = std::move(ind);
+      else            p.ind = std::move(ind);
+
+      if (--p.remaining == 0) {
+        if (_parts > 1) _merge(p.ind, p.parts);
+        p.ind.evaluated = true;
+        p.ind.stats["evalTime"] = p.duration;
+        integrate(std::move(p.ind));
+        _pending.erase(it);
+      }
+
+      // Keep enough children waiting for the ordering to matter
+      while (_queue.size() < _threads * _parts && !_population.empty()
+             && _dispatched < _maxDispatches && !aborted()) {
+        const Ind *parent = nullptr;
+        Ind child = breed(parent);
+        double cost = predictedCost(child, parent);
+        dispatch(std::move(child), cost);
+      }
+      if (_completed == _maxDispatches) _stopping = true;
+      _cv.notify_all();
+    }
+  }
+
+  void dispatch (Ind &&ind, double cost) {
+    uint ticket = _dispatched++;
+    ind.id = {ticket / _popSize, ticket % _popSize};
+
+    Pending &p = _pending[ticket];
+    p.ind = std::move(ind);
+    p.parts.resize(_parts > 1 ? _parts : 0);
+    p.remaining = _parts;
+    p.duration = 0;
+
+    for (uint i=0; i<_parts; i++)
+      _queue.push({cost / _parts, ticket, i});
+  }
+
+  // ===========================================================================
+  // == Selection/replacement (called with the lock held)
+
+  static bool dominates (const Ind &lhs, const Ind &rhs) {
+    bool strict = false;
+    for (const auto &p: lhs.fitnesses) {
+      double r = rhs.fitnesses.at(p.first);
+      if (p.second < r) return false;
+      strict |= (p.second > r);
+    }
+    return strict;
+  }
+
+  uint championIndex (void) const {
+    uint best = 0;
+    for (uint i=1; i<_population.size(); i++)
+      if (_population[i].fitnesses.at(_objective)
+          > _population[best].fitnesses.at(_objective))
+        best = i;
+    return best;
+  }
+
+  std::vector<uint> tournament (void) {
+    std::vector<uint> t (std::min<size_t>(_tournamentSize, _population.size()));
+    for (uint &i: t)  i = (*_dice)(0u, uint(_population.size()-1));
+    return t;
+  }
+
+  /// Pareto tournament: random pick among the non-dominated participants
+  Ind breed (const Ind* &parent) {
+    auto t = tournament();
+    std::vector<uint> front;
+    for (uint i: t) {
+      bool dominated = false;
+      for (uint j: t)
+        dominated |= (i != j && dominates(_population[j], _population[i]));
+      if (!dominated) front.push_back(i);
+    }
+
+    parent = &_population[*(*_dice)(front)];
+    Ind child (parent->dna);
+    _mutate(child.dna);
+    child.parents = {parent->id};
+    child.evaluated = false;
+    return child;
+  }
+
+  /// Inverse tournament on the main objective, never removing the champion
+  uint victim (void) {
+    uint champ = championIndex();
+    uint worst = champ;
+    for (uint i: tournament()) {
+      if (i == champ) continue;
+      if (worst == champ
+          || _population[i].fitnesses.at(_objective)
+           < _population[worst].fitnesses.at(_objective))
+        worst = i;
+    }
+    if (worst == champ) worst = (champ + 1) % _population.size();
+    return worst;
+  }
+
+  /// Average distance of a newcomer to its k nearest neighbours among the
+  /// archive and population. By brute force: building an index for a single
+  /// query costs more than it saves
+  void updateNovelty (Ind &ind) {
+    static const EuclidianDistance distance {};
+    _distances.clear();
+    for (const Footprint &f: _archive)
+      _distances.push_back(distance(ind.signature, f));
+    for (const Ind &i: _population)
+      _distances.push_back(distance(ind.signature, i.signature));
+
+    double novelty = 0;
+    uint k = std::min<size_t>(_noveltyK, _distances.size());
+    if (k > 0) {
+      std::partial_sort(_distances.begin(), _distances.begin() + k,
+                        _distances.end());
+      for (uint i=0; i<k; i++)  novelty += _distances[i];
+      novelty /= k;
+    }
+    ind.fitnesses["novelty"] = novelty;
+
+    if ((*_dice)(double(_archiveAdditions) / _popSize))
+      _archive.push_back(ind.signature);
+  }
+
+  /// Rescores the whole population against the current archive and
+  /// population (one index for all queries)
+  void refreshNovelty (void) {
+    std::vector<const Footprint*> signatures;
+    signatures.reserve(_archive.size() + _population.size());
+    for (const Footprint &f: _archive)    signatures.push_back(&f);
+    for (const Ind &i: _population)       signatures.push_back(&i.signature);
+
+    _index.build(signatures);
+    for (uint i=0; i<_population.size(); i++)
+      _population[i].fitnesses["novelty"] =
+        _index.novelty(_archive.size() + i, _noveltyK);
+  }
+
+  void integrate (Ind &&ind) {
+    if (_novelty) updateNovelty(ind);
+
+    _epochEvaluations.push_back(ind);
+    if (_population.size() < _popSize)
+      _population.push_back(std::move(ind));
+    else
+      _population[victim()] = std::move(ind);
+
+    _completed++;
+    if (_completed % _popSize == 0)  endOfEpoch();
+  }
+
+  // ===========================================================================
+  // == Epochs
+
+  void endOfEpoch (void) {
+    Trace::instant("epoch", "ga", _epoch);
+    if (_novelty) refreshNovelty();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - _epochStart).count();
+
+    if (_verbosity > 0)
+      std::cout << "[" << _evaluatorName << "] End of epoch " << _epoch
+                << " at " << utils::CurrentTime{} << " (" << duration
+                << " ms)\n";
+
+    const Ind &champ = _population[championIndex()];
+    if (_pack.isOpen()) {
+      _pack.appendElite(_epoch, 0, _objective, champ.toJSON());
+      if (_savePopulations) _pack.appendPopulation(_epoch, _population);
+
+    } else {
+      stdfs::path genFolder = _folder / GAGA::concat("gen", _epoch);
+      stdfs::create_directories(genFolder);
+
+      if (_savePopulations) {
+        nlohmann::json jpop;
+        for (const Ind &i: _population) jpop.push_back(i.toJSON());
+        std::ofstream ofs (genFolder / GAGA::concat("pop", _epoch, ".pop"));
+        ofs << nlohmann::json{{"population", jpop}}.dump();
+      }
+
+      std::ostringstream oss;
+      oss << _objective << "__" << champ.fitnesses.at(_objective) << "_0.dna";
+      std::ofstream ofs (genFolder / oss.str());
+      ofs << champ.toJSON().dump(2);
+    }
+
+    saveGenStats(duration);
+
+    if (_onEpoch) _onEpoch(_epoch, _epochEvaluations);
+
+    _epochEvaluations.clear();
+    _epoch++;
+    _epochStart = std::chrono::steady_clock::now();
+  }
+
+  /// Same columns as GAGA's gen_stats.csv: gen, then <field>_<avg|max|min>
+  /// (alphabetical order) over this epoch's evaluations
+  void saveGenStats (long duration) {
+    std::map<std::string, std::map<std::string, double>> stats;
+    const auto accumulate = [&stats, this] (const std::string &key, double v) {
+      auto &s = stats[key];
+      if (s.empty())  s = {{"avg", 0}, {"max", v}, {"min", v}};
+      s["avg"] += v / _epochEvaluations.size();
+      s["max"] = std::max(s["max"], v);
+      s["min"] = std::min(s["min"], v);
+    };
+    for (const Ind &i: _epochEvaluations) {
+      for (const auto &p: i.fitnesses)  accumulate(p.first, p.second);
+      for (const auto &p: i.stats)      accumulate(p.first, p.second);
+    }
+
+    std::map<std::string, double> global {
+      { "genTotalTime", double(duration) },
+      { "nEvals", double(_epochEvaluations.size()) },
+      { "archiveSize", double(_archive.size()) }
+    };
+
+    if (_pack.isOpen()) {
+      nlohmann::json j = stats;
+      for (const auto &p: global) j["global"][p.first] = p.second;
+      _pack.append(Archive::STATS, _epoch, 0, j);
+    }
+
+    std::map<std::string, double> row;
+    for (const auto &p: global) row["global_" + p.first] = p.second;
+    for (const auto &s: stats)
+      for (const auto &p: s.second) row[s.first + "_" + p.first] = p.second;
+
+    const stdfs::path file = _folder / "gen_stats.csv";
+    bool header = (_epoch == 0 || !stdfs::exists(file));
+    if (header) {
+      _genStatsColumns.clear();
+      for (const auto &p: global)
+        _genStatsColumns.push_back("global_" + p.first);
+      for (const auto &s: stats)
+        for (const auto &p: s.second)
+          _genStatsColumns.push_back(s.first + "_" + p.first);
+
+    } else if (_genStatsColumns.empty()) {
+      std::ifstream ifs (file);
+      std::string line, column;
+      std::getline(ifs, line);
+      std::istringstream iss (line);
+      std::getline(iss, column, ','); // gen
+      while (std::getline(iss, column, ','))
+        _genStatsColumns.push_back(column);
+    }
+
+    std::ofstream ofs (file, header ? std::ios::trunc : std::ios::app);
+    if (header) {
+      ofs << "gen";
+      for (const std::string &c: _genStatsColumns)  ofs << "," << c;
+      ofs << "\n";
+    }
+
+    // Keys missing from this epoch are left empty, new ones are dropped
+    ofs << _epoch;
+    for (const std::string &c: _genStatsColumns) {
+      ofs << ",";
+      auto it = row.find(c);
+      if (it != row.end())  ofs << it->second;
+    }
+    ofs << "\n";
+  }
+};
+
+} // end of namespace simu
+
+#endif // GA_STEADYSTATE_HPP
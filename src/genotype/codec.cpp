@@ -0,0 +1,224 @@
+#include "codec.h"
+
+namespace genotype {
+
+static_assert(sizeof(float) == 4, "Genome codec expects 32-bits floats");
+
+void Codec::Writer::blob (const nlohmann::json &j) {
+  auto bytes = nlohmann::json::to_msgpack(j);
+  pod(uint32_t(bytes.size()));
+  buffer.append(bytes.begin(), bytes.end());
+}
+
+nlohmann::json Codec::Reader::blob (void) {
+  auto n = pod<uint32_t>();
+  require(n);
+  auto begin = buffer.begin() + offset;
+  offset += n;
+  return nlohmann::json::from_msgpack(begin, begin + n);
+}
+
+static constexpr char B64 [] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string Codec::armor (const Buffer &b) {
+  std::string s (ARMOR);
+  s.reserve(s.size() + 4 * ((b.size() + 2) / 3));
+
+  const auto byte = [&b] (size_t i) { return uint32_t(uint8_t(b[i])); };
+  size_t i = 0;
+  for (; i + 2 < b.size(); i += 3) {
+    uint32_t v = (byte(i) << 16) | (byte(i+1) << 8) | byte(i+2);
+    for (int k=18; k>=0; k-=6)  s.push_back(B64[(v >> k) & 63]);
+  }
+  if (size_t r = b.size() - i) {
+    uint32_t v = byte(i) << 16;
+    if (r == 2) v |= byte(i+1) << 8;
+    s.push_back(B64[(v >> 18) & 63]);
+    s.push_back(B64[(v >> 12) & 63]);
+    s.push_back(r == 2 ? B64[(v >> 6) & 63] : '=');
+    s.push_back('=');
+  }
+  return s;
+}
+
+Codec::Buffer Codec::unarmor (const std::string &s) {
+  if (!isArmored(s))
+    utils::Thrower("Genome codec: not an armored genome");
+
+  static const auto values = [] {
+    std::array<int8_t, 256> a;
+    a.fill(-1);
+    for (uint i=0; i<64; i++) a[uint8_t(B64[i])] = i;
+    return a;
+  }();
+
+  size_t begin = sizeof(ARMOR)-1, end = s.size();
+  while (end > begin && s[end-1] == '=')  end--;
+  if ((s.size() - begin) % 4 != 0 || s.size() - end > 2)
+    utils::Thrower("Genome codec: malformed armored genome");
+
+  Buffer b;
+  b.reserve(3 * (end - begin) / 4);
+  uint32_t v = 0;
+  int bits = 0;
+  for (size_t i=begin; i<end; i++) {
+    int8_t d = values[uint8_t(s[i])];
+    if (d < 0)
+      utils::Thrower("Genome codec: invalid character '", s[i],
+                     "' in armored genome");
+    v = (v << 6) | uint32_t(d);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      b.push_back(char((v >> bits) & 255));
+    }
+  }
+  return b;
+}
+
+Codec::Kind Codec::kind (const Buffer &b) {
+  Reader r (b);
+  if (!isBinary(r.buffer))
+    utils::Thrower("Genome codec: not a binary genome");
+  r.offset = sizeof(MAGIC);
+
+  auto v = r.pod<uint8_t>();
+  if (v == 0 || v > VERSION)
+    utils::Thrower("Genome codec: unsupported version ", uint(v),
+                   " (max is ", uint(VERSION), ")");
+
+  return r.pod<Kind>();
+}
+
+void Codec::writeHeader (Writer &w, Kind k) {
+  w.buffer.append(MAGIC, sizeof(MAGIC));
+  w.pod(VERSION);
+  w.pod(k);
+}
+
+void Codec::readHeader (Reader &r, Kind k) {
+  auto k_ = kind(r.buffer);
+  r.version = uint8_t(r.buffer[sizeof(MAGIC)]);
+  r.offset = sizeof(MAGIC) + sizeof(VERSION) + sizeof(Kind);
+  if (k_ != k)
+    utils::Thrower("Genome codec: expected kind '", char(k), "' got '",
+                   char(k_), "'");
+}
+
+void Codec::write (Writer &w, const Critter &c) {
+  w.pod(uint16_t(c.splines.size()));
+  for (const Spline &s: c.splines)  w.array(s.data);
+#ifdef USE_DIMORPHISM
+  w.array(c.dimorphism);
+#endif
+
+  w.pod(uint16_t(c.colors.size()));
+  for (const Color &col: c.colors)  w.array(col);
+
+  w.pod(c.vision.angleBody);
+  w.pod(c.vision.angleRelative);
+  w.pod(c.vision.width);
+  w.pod(uint32_t(c.vision.precision));
+
+  w.pod(c.minClockSpeed);
+  w.pod(c.maxClockSpeed);
+  w.pod(c.matureAge);
+  w.pod(c.oldAge);
+  w.pod(int32_t(c.asexual));
+
+  w.blob(c.cdata);
+  w.blob(c.gdata);
+
+  // Only the CPPN's structure is packed. The rest goes through json
+  auto brain = c.brain;
+  brain.cppn.nodes.clear();
+  brain.cppn.links.clear();
+  w.blob(brain);
+  w.records(c.brain.cppn.nodes);
+  w.records(c.brain.cppn.links);
+}
+
+void Codec::read (Reader &r, Critter &c) {
+  if (r.pod<uint16_t>() != c.splines.size())
+    utils::Thrower("Genome codec: mismatched number of splines");
+  for (Spline &s: c.splines)  r.array(s.data);
+#ifdef USE_DIMORPHISM
+  r.array(c.dimorphism);
+#endif
+
+  if (r.pod<uint16_t>() != c.colors.size())
+    utils::Thrower("Genome codec: mismatched number of colors");
+  for (Color &col: c.colors)  r.array(col);
+
+  c.vision.angleBody = r.pod<float>();
+  c.vision.angleRelative = r.pod<float>();
+  c.vision.width = r.pod<float>();
+  c.vision.precision = r.pod<uint32_t>();
+
+  c.minClockSpeed = r.pod<float>();
+  c.maxClockSpeed = r.pod<float>();
+  c.matureAge = r.pod<float>();
+  c.oldAge = r.pod<float>();
+  c.asexual = r.pod<int32_t>();
+
+  c.cdata = r.blob();
+  c.gdata = r.blob();
+  c.brain = r.blob();
+  if (r.version >= 2) {
+    r.records(c.brain.cppn.nodes);
+    r.records(c.brain.cppn.links);
+  }
+}
+
+Codec::Buffer Codec::encode (const Critter &c) {
+  Buffer b;
+  Writer w (b);
+  writeHeader(w, CRITTER);
+  write(w, c);
+  return b;
+}
+
+Critter Codec::decode (const Buffer &b) {
+  Critter c;
+  Reader r (b);
+  readHeader(r, CRITTER);
+  read(r, c);
+  return c;
+}
+
+Codec::Buffer Codec::encodeTeam (const Critter &c, uint32_t size) {
+  Buffer b;
+  Writer w (b);
+  writeHeader(w, TEAM);
+  w.pod(size);
+  write(w, c);
+  return b;
+}
+
+uint32_t Codec::decodeTeam (const Buffer &b, Critter &c) {
+  Reader r (b);
+  readHeader(r, TEAM);
+  auto size = r.pod<uint32_t>();
+  read(r, c);
+  return size;
+}
+
+nlohmann::json Codec::toJSON (const std::string &str) {
+  if (isArmored(str)) return toJSON(unarmor(str));
+  if (!isBinary(str)) return nlohmann::json::parse(str);
+
+  switch (kind(str)) {
+  case CRITTER: return decode(str);
+  case TEAM: {
+    Critter c;
+    auto size = decodeTeam(str, c);
+    return nlohmann::json::array({size, c});
+  }
+  default:
+    utils::Thrower("Genome codec: unknown kind '", char(kind(str)), "'");
+  }
+  return {};
+}
+
+} // end of namespace genotype
@@ -0,0 +1,162 @@
+#ifndef GNTP_CODEC_H
+#define GNTP_CODEC_H
+
+#include <cstring>
+
+#include "critter.h"
+
+namespace genotype {
+
+/// Compact, versioned binary representation of genomes
+///
+/// Fields owned by this project are stored as raw host-endian values (thus
+/// without any loss of precision). So are the nodes and links of the brain's
+/// CPPN, by far the largest part of a genome, as fixed-size records. The
+/// remaining externally defined sub-genomes (crossover data, genealogy and the
+/// brain's other fields) are embedded as MessagePack blobs of their json
+/// representation.
+///
+/// Buffers are std::string and start with a non-ascii magic number: they can
+/// thus never be mistaken for json. As json strings must be valid utf-8,
+/// genomes travel through GAGA (serialize()/constructor, populations, packed
+/// archive) in their armored form: the buffer in base64, after a textual
+/// prefix. Human-readable json is still produced by toJSON (and toFile).
+///
+/// Layout:
+///  - magic (4 bytes), version (u8), kind (u8)
+///  - payload (see Codec::write)
+struct Codec {
+  using Buffer = std::string;
+
+  static constexpr char MAGIC [4] = { '\x89', 'S', 'G', 'B' };
+  /// 1: whole brain as a blob, 2: CPPN nodes and links as records
+  static constexpr uint8_t VERSION = 2;
+
+  /// Prefix of armored buffers
+  static constexpr char ARMOR [] = "sgb64:";
+
+  /// What the buffer contains
+  enum Kind : uint8_t { CRITTER = 'C', TEAM = 'T' };
+
+  struct Writer {
+    Buffer &buffer;
+
+    Writer (Buffer &b) : buffer(b) {}
+
+    template <typename T>
+    void pod (const T &v) {
+      static_assert(std::is_trivially_copyable<T>::value, "Not a pod");
+      const char *p = reinterpret_cast<const char*>(&v);
+      buffer.append(p, sizeof(T));
+    }
+
+    template <typename T, size_t N>
+    void array (const std::array<T, N> &a) {
+      pod(uint16_t(N));
+      for (const T &v: a) pod(v);
+    }
+
+    /// Elements of a container of trivially copyable records (e.g. CPPN
+    /// nodes), preceded by their size and count
+    template <typename C>
+    void records (const C &c) {
+      using T = typename C::value_type;
+      static_assert(std::is_trivially_copyable<T>::value, "Not a record");
+      pod(uint16_t(sizeof(T)));
+      pod(uint32_t(c.size()));
+      for (const T &v: c) pod(v);
+    }
+
+    void blob (const nlohmann::json &j);
+  };
+
+  struct Reader {
+    const Buffer &buffer;
+    size_t offset;
+    uint8_t version;  ///< Of the buffer (set by readHeader)
+
+    Reader (const Buffer &b, size_t o = 0)
+      : buffer(b), offset(o), version(VERSION) {}
+
+    template <typename T>
+    T pod (void) {
+      static_assert(std::is_trivially_copyable<T>::value, "Not a pod");
+      require(sizeof(T));
+      T v;
+      std::memcpy(&v, buffer.data() + offset, sizeof(T));
+      offset += sizeof(T);
+      return v;
+    }
+
+    template <typename T, size_t N>
+    void array (std::array<T, N> &a) {
+      auto n = pod<uint16_t>();
+      if (n != N)
+        utils::Thrower("Genome codec: mismatched array size (", n, " != ", N,
+                       "). Was this genome produced by a different build?");
+      for (T &v: a) v = pod<T>();
+    }
+
+    /// Appends the records (in order, see Writer::records) to c
+    template <typename C>
+    void records (C &c) {
+      using T = typename C::value_type;
+      auto s = pod<uint16_t>();
+      if (s != sizeof(T))
+        utils::Thrower("Genome codec: mismatched record size (", s, " != ",
+                       sizeof(T), "). Was this genome produced by a different"
+                       " build?");
+      auto n = pod<uint32_t>();
+      require(size_t(n) * sizeof(T));
+      for (uint32_t i=0; i<n; i++)  c.insert(c.end(), pod<T>());
+    }
+
+    nlohmann::json blob (void);
+
+    void require (size_t n) const {
+      if (offset + n > buffer.size())
+        utils::Thrower("Genome codec: truncated buffer (", buffer.size(),
+                       " bytes, needed ", offset + n, ")");
+    }
+  };
+
+  /// Whether this buffer was produced by this codec (as opposed to json)
+  static bool isBinary (const Buffer &b) {
+    return b.size() >= sizeof(MAGIC)
+        && std::equal(std::begin(MAGIC), std::end(MAGIC), b.begin());
+  }
+
+  /// Whether this string is an armored buffer
+  static bool isArmored (const std::string &s) {
+    return s.compare(0, sizeof(ARMOR)-1, ARMOR) == 0;
+  }
+
+  static std::string armor (const Buffer &b);
+  static Buffer unarmor (const std::string &s);
+
+  /// Checks magic/version and returns the kind of this buffer
+  static Kind kind (const Buffer &b);
+
+  static void writeHeader (Writer &w, Kind k);
+
+  /// Checks magic/version/kind. Leaves the reader at the start of the payload
+  static void readHeader (Reader &r, Kind k);
+
+  static void write (Writer &w, const Critter &c);
+  static void read (Reader &r, Critter &c);
+
+  static Buffer encode (const Critter &c);
+  static Critter decode (const Buffer &b);
+
+  /// Teams (see mkombat) are a critter genome replicated size times
+  static Buffer encodeTeam (const Critter &c, uint32_t size);
+  static uint32_t decodeTeam (const Buffer &b, Critter &c);
+
+  /// Human-readable form of an armored, binary or json genome (a team is
+  /// represented as [size, genome])
+  static nlohmann::json toJSON (const std::string &str);
+};
+
+} // end of namespace genotype
+
+#endif // GNTP_CODEC_H
@@ -1,4 +1,5 @@
 #include "critter.h"
+#include "codec.h"
 
 using namespace genotype;
 
@@ -190,6 +191,16 @@ auto splinesFunctor = [] {
 };
 DEFINE_GENOME_FIELD_WITH_FUNCTOR(Ss, splines, "", splinesFunctor())
 
+std::string Critter::serialize (void) const {
+  return Codec::armor(Codec::encode(*this));
+}
+
+Critter::Critter (const std::string &str) {
+  if (Codec::isArmored(str))      *this = Codec::decode(Codec::unarmor(str));
+  else if (Codec::isBinary(str))  *this = Codec::decode(str);
+  else                            *this = json::parse(str);
+}
+
 #ifdef USE_DIMORPHISM
 using Dm = GENOME::Dimorphism;
 auto dimorphismFunctor = [] {
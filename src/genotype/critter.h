@@ -149,13 +149,11 @@ public:
   }
 
   // == Gaga required methods
-  std::string serialize (void) const {
-    return json(*this).dump();
-  }
+  /// Armored binary (see Codec). Use toFile/json for human-readable exports
+  std::string serialize (void) const;
 
-  Critter (const std::string &json) {
-    *this = json::parse(json);
-  }
+  /// Either armored (from serialize), binary (from Codec::encode) or json
+  Critter (const std::string &str);
 
   void reset (void) {}
 };
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#include <malloc.h>
+#endif
+
+#include "allocations.h"
+
+namespace simu {
+
+/// Innermost scope of the calling thread (constant-initialized, so that
+/// accessing it never goes through a TLS wrapper)
+static thread_local Allocations::Scope *active = nullptr;
+
+static int64_t usableSize (void *p) {
+#ifdef __linux__
+  return malloc_usable_size(p);
+#else
+  (void)p;
+  return 0;
+#endif
+}
+
+Allocations::Scope::Scope (void) : _parent(active) {
+  active = this;
+}
+
+Allocations::Scope::~Scope (void) {
+  active = _parent;
+  if (_parent) {
+    Stats &p = _parent->_stats;
+    p.allocs += _stats.allocs;
+    p.pooled += _stats.pooled;
+    p.bytes += _stats.bytes;
+    p.peak = std::max(p.peak, p.current + _stats.peak);
+    p.current += _stats.current;
+  }
+}
+
+void Allocations::Scope::allocated (void *p, uint64_t size) {
+  Scope *s = active;
+  if (!s || !p) return;
+  Stats &st = s->_stats;
+  st.allocs++;
+  st.bytes += size;
+  st.current += usableSize(p);
+  st.peak = std::max(st.peak, st.current);
+}
+
+void Allocations::Scope::poolGrowth (void) {
+  if (Scope *s = active) s->_stats.pooled++;
+}
+
+void Allocations::Scope::freed (void *p) {
+  Scope *s = active;
+  if (!s || !p) return;
+  s->_stats.current -= usableSize(p);
+}
+
+} // end of namespace simu
+
+#ifdef WITH_ALLOCATION_COUNTING
+
+using simu::Allocations;
+
+static void* countedAlloc (std::size_t size) {
+  void *p = std::malloc(size ? size : 1);
+  Allocations::Scope::allocated(p, size);
+  return p;
+}
+
+static void countedFree (void *p) {
+  Allocations::Scope::freed(p);
+  std::free(p);
+}
+
+void* operator new (std::size_t size) {
+  void *p = countedAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[] (std::size_t size) {
+  void *p = countedAlloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+
+void operator delete (void *p) noexcept { countedFree(p); }
+void operator delete[] (void *p) noexcept { countedFree(p); }
+void operator delete (void *p, std::size_t) noexcept { countedFree(p); }
+void operator delete[] (void *p, std::size_t) noexcept { countedFree(p); }
+void operator delete (void *p, const std::nothrow_t&) noexcept {
+  countedFree(p);
+}
+void operator delete[] (void *p, const std::nothrow_t&) noexcept {
+  countedFree(p);
+}
+
+#ifdef WITH_B2_ALLOC_WRAP
+// Box2D (2.4.0) allocates through b2Alloc/b2Free (b2_settings.cpp), redirected
+// here by the linker (--wrap, see the root CMakeLists.txt). So is
+// b2BlockAllocator::Allocate, so as to tell its chunks apart from the other
+// buffers (stack allocator, broad-phase, dynamic tree) which are not pools
+extern "C" {
+void* __real__Z7b2Alloci (int32_t size);
+void __real__Z6b2FreePv (void *mem);
+void* __real__ZN16b2BlockAllocator8AllocateEi (void *allocator, int32_t size);
+
+/// Whether the calling thread is inside a pooled b2BlockAllocator::Allocate
+static thread_local bool blockAllocation = false;
+
+void* __wrap__ZN16b2BlockAllocator8AllocateEi (void *allocator, int32_t size) {
+  // Larger blocks are forwarded to b2Alloc and never reused (b2_maxBlockSize)
+  static constexpr int32_t maxBlockSize = 640;
+  const bool outer = blockAllocation;
+  blockAllocation = (size <= maxBlockSize);
+  void *p = __real__ZN16b2BlockAllocator8AllocateEi(allocator, size);
+  blockAllocation = outer;
+  return p;
+}
+
+void* __wrap__Z7b2Alloci (int32_t size) {
+  void *p = __real__Z7b2Alloci(size);
+  // A new chunk or a larger chunk array
+  if (blockAllocation)  Allocations::Scope::poolGrowth();
+  Allocations::Scope::allocated(p, size);
+  return p;
+}
+
+void __wrap__Z6b2FreePv (void *mem) {
+  Allocations::Scope::freed(mem);
+  __real__Z6b2FreePv(mem);
+}
+}
+#endif
+
+#endif
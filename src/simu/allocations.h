@@ -0,0 +1,71 @@
+#ifndef SIMU_ALLOCATIONS_H
+#define SIMU_ALLOCATIONS_H
+
+#include <cstdint>
+
+namespace simu {
+
+/// Counts the heap allocations made by the calling thread while a Scope is
+/// active
+///
+/// Requires WITH_ALLOCATION_COUNTING (global operator new/delete are then
+/// replaced). On Linux, Box2D's b2Alloc/b2Free are also wrapped at link time
+/// so that the physics' own pools are accounted for. Outside of a scope the
+/// only overhead is a thread-local pointer test per (de)allocation.
+///
+/// Live bytes rely on malloc_usable_size and are thus only tracked on Linux.
+struct Allocations {
+  struct Stats {
+    uint64_t allocs = 0;  ///< Number of allocations
+    uint64_t pooled = 0;  ///< Of which growth of a pool (Box2D's or ours)
+    uint64_t bytes = 0;   ///< Total requested bytes
+    int64_t current = 0;  ///< Live bytes (relative to the scope's start)
+    int64_t peak = 0;     ///< Maximal value of the above
+  };
+
+  /// Accounts for the calling thread's allocations until destruction.
+  /// Nested scopes also count into their parent
+  class Scope {
+    Stats _stats;
+    Scope *_parent;
+
+  public:
+    Scope (void);
+    ~Scope (void);
+
+    Scope (const Scope&) = delete;
+    Scope& operator= (const Scope&) = delete;
+
+    const Stats& stats (void) const {
+      return _stats;
+    }
+
+    /// Writes allocs, alloc_bytes and peak_bytes into a map-like container,
+    /// e.g. an individual's stats
+    template <typename M>
+    void exportTo (M &m) const {
+      m["allocs"] = _stats.allocs;
+      m["alloc_bytes"] = _stats.bytes;
+      m["peak_bytes"] = _stats.peak;
+    }
+
+    static void allocated (void *p, uint64_t size);
+    static void freed (void *p);
+
+    /// Records that a pool grew (the allocation itself is counted as usual)
+    static void poolGrowth (void);
+  };
+
+  /// Whether the counting hooks are compiled in
+  static constexpr bool available (void) {
+#ifdef WITH_ALLOCATION_COUNTING
+    return true;
+#else
+    return false;
+#endif
+  }
+};
+
+} // end of namespace simu
+
+#endif // SIMU_ALLOCATIONS_H
@@ -1,8 +1,71 @@
+#include <unordered_map>
+
+#include "box2d/b2_contact.h"
+#include "box2d/b2_joint.h"
+
 #include "box2dutils.h"
 
 #include "kgd/utils/assertequal.hpp"
 #include "config.h"
 
+namespace simu {
+
+Box2DUtils::WorldStats Box2DUtils::worldStats (b2World &world, bool islands) {
+  WorldStats s {};
+  s.bodies = world.GetBodyCount();
+  s.contacts = world.GetContactCount();
+  s.proxies = world.GetProxyCount();
+  s.treeHeight = world.GetTreeHeight();
+
+  for (b2Body *b = world.GetBodyList(); b; b = b->GetNext())
+    s.awake += b->IsAwake();
+
+  for (b2Contact *c = world.GetContactList(); c; c = c->GetNext())
+    s.touching += c->IsTouching();
+
+  if (!islands) return s;
+
+  // Same rules as b2World::Solve: static bodies do not propagate islands,
+  // sensors and disabled contacts do not link bodies
+  std::unordered_map<const b2Body*, uint> indices;
+  std::vector<uint> parents;
+  for (b2Body *b = world.GetBodyList(); b; b = b->GetNext()) {
+    if (b->GetType() == b2_staticBody || !b->IsEnabled()) continue;
+    indices[b] = parents.size();
+    parents.push_back(parents.size());
+  }
+
+  const auto root = [&parents] (uint i) {
+    while (parents[i] != i) i = parents[i] = parents[parents[i]];
+    return i;
+  };
+  const auto link = [&indices, &parents, &root] (const b2Body *a,
+                                                 const b2Body *b) {
+    auto ia = indices.find(a), ib = indices.find(b);
+    if (ia == indices.end() || ib == indices.end()) return;
+    parents[root(ia->second)] = root(ib->second);
+  };
+
+  for (b2Contact *c = world.GetContactList(); c; c = c->GetNext())
+    if (c->IsTouching() && c->IsEnabled()
+        && !c->GetFixtureA()->IsSensor() && !c->GetFixtureB()->IsSensor())
+      link(c->GetFixtureA()->GetBody(), c->GetFixtureB()->GetBody());
+
+  for (b2Joint *j = world.GetJointList(); j; j = j->GetNext())
+    link(j->GetBodyA(), j->GetBodyB());
+
+  std::vector<uint> sizes (parents.size(), 0);
+  for (uint i=0; i<parents.size(); i++) sizes[root(i)]++;
+  for (uint n: sizes) {
+    s.islands += (n > 0);
+    s.largestIsland = std::max(s.largestIsland, n);
+  }
+
+  return s;
+}
+
+} // end of namespace simu
+
 void assertEqual(const b2Body &lhs, const b2Body &rhs, bool deepcopy) {
   using utils::assertEqual;
   if (deepcopy) utils::assertDeepcopy(lhs, rhs);
@@ -45,6 +45,13 @@ struct Box2DUtils {
 
     return newBody->CreateFixture(&def);
   }
+
+  /// Population and connectivity of a world's physical objects
+  struct WorldStats {
+    uint bodies, awake, contacts, touching, proxies, treeHeight;
+    uint islands, largestIsland;  ///< Only if requested (linear but not free)
+  };
+  static WorldStats worldStats (b2World &world, bool islands);
 };
 
 } // end of namespace simu
@@ -61,6 +61,7 @@ DEFINE_PARAMETER(float, plantMinRadius, .25)
 DEFINE_PARAMETER(float, plantMaxRadius, .75)
 DEFINE_PARAMETER(float, plantEnergyDensity, 4)
 DEFINE_PARAMETER(decimal, decompositionRate, .01)
+DEFINE_PARAMETER(bool, plantField, false)
 
 DEFINE_PARAMETER(int, growthSubsteps, 4)
 DEFINE_PARAMETER(float, visionWidthToLength, 10)
@@ -73,6 +74,10 @@ DEFINE_PARAMETER(float, combatMinVelocity, .25)
 DEFINE_PARAMETER(float, auditionRange, 20)
 DEFINE_PARAMETER(float, reproductionRange, 3)
 DEFINE_PARAMETER(float, reproductionRequestThreshold, .9)
+DEFINE_PARAMETER(uint, gestationSteps, 0)
+DEFINE_PARAMETER(bool, twoPhaseStep, false)
+DEFINE_PARAMETER(bool, lodCritters, false)
+DEFINE_PARAMETER(bool, kinematicEvaluations, false)
 
 DEFINE_PARAMETER(float, baselineAgingSpeed, .001)
 DEFINE_PARAMETER(decimal, baselineEnergyConsumption, .0005)
@@ -88,6 +93,7 @@ DEFINE_PARAMETER(decimal, energyAbsorptionRate, .025)
 DEFINE_PARAMETER(bool, b2FixedBodyCOM, true)
 DEFINE_PARAMETER(uint, b2VelocityIter, 8)
 DEFINE_PARAMETER(uint, b2PositionIter, 3)
+DEFINE_PARAMETER(uint, physicsTiles, 1)
 DEFINE_PARAMETER(uint, ticksPerSecond, 10)
 DEFINE_PARAMETER(uint, secondsPerDay, 100)
 DEFINE_PARAMETER(uint, daysPerYear, 1000)
@@ -41,10 +41,25 @@ struct b2BodyUserData {
     Obstacle *obstacle; // null for edges
   } ptr;
 
+  /// Bodies in different (non-negative) arenas never interact nor see each
+  /// other (see Environment::sameArena). Negative for all arenas
+  int arena = -1;
+
+  /// Changes whenever the fixtures of the bodies sharing this data do. Unique
+  /// over the process so that a recycled owner never matches a stale copy
+  /// (see Environment::syncGhosts)
+  uint revision = nextRevision();
+
+  /// Whether this is a stand-in for a body of another physics tile
+  bool ghost = false;
+
+  static uint nextRevision (void);
+
   friend void assertEqual (const b2BodyUserData &lhs, const b2BodyUserData &rhs,
                            bool deepcopy) {
     using utils::assertEqual;
     assertEqual(lhs.type, rhs.type, deepcopy);
+    assertEqual(lhs.arena, rhs.arena, deepcopy);
     // Pointers ought to be different
   }
 };
@@ -100,6 +115,7 @@ struct CONFIG_FILE(Simulation) {
   DECLARE_PARAMETER(float, plantMaxRadius)
   DECLARE_PARAMETER(float, plantEnergyDensity)
   DECLARE_PARAMETER(decimal, decompositionRate)
+  DECLARE_PARAMETER(bool, plantField)   // Plants outside Box2D (see PlantField)
 
   // Splinoid constants
   DECLARE_PARAMETER(int, growthSubsteps)
@@ -113,6 +129,10 @@ struct CONFIG_FILE(Simulation) {
   DECLARE_PARAMETER(float, auditionRange)     // With respect to body size
   DECLARE_PARAMETER(float, reproductionRange) //
   DECLARE_PARAMETER(float, reproductionRequestThreshold)
+  DECLARE_PARAMETER(uint, gestationSteps) // Newborns' inert period (0: none)
+  DECLARE_PARAMETER(bool, twoPhaseStep)   // All critters sense, then all act
+  DECLARE_PARAMETER(bool, lodCritters)    // Isolated critters out of Box2D
+  DECLARE_PARAMETER(bool, kinematicEvaluations) // See Environment::setKinematic
 
   // Splinoid metabolic constants (per second, affected by clock speed)
   DECLARE_PARAMETER(float, baselineAgingSpeed)
@@ -130,6 +150,7 @@ struct CONFIG_FILE(Simulation) {
   DECLARE_PARAMETER(bool, b2FixedBodyCOM)
   DECLARE_PARAMETER(uint, b2VelocityIter)
   DECLARE_PARAMETER(uint, b2PositionIter)
+  DECLARE_PARAMETER(uint, physicsTiles)   // Worlds per side (1: single world)
   DECLARE_PARAMETER(uint, ticksPerSecond)
   DECLARE_PARAMETER(uint, secondsPerDay)
   DECLARE_PARAMETER(uint, daysPerYear)
@@ -2,6 +2,7 @@
 #include "foodlet.h"
 #include "environment.h"
 #include "box2dutils.h"
+#include "workerpool.h"
 
 //#include "../hyperneat/phenotype.h"
 
@@ -125,10 +126,10 @@ P2D pointAt (int t, const P2D &p0, const P2D &c0, const P2D &c1, const P2D &p1){
 // =============================================================================
 // == Top-level methods
 
-Critter::Critter (const Genome &g, b2Body *b) : _genotype(g), _body(*b) {
+Critter::Critter (const Genome &g, b2Body *b) : _genotype(g), _body(b) {
   _bodyUserData.type = BodyType::CRITTER;
   _bodyUserData.ptr.critter = this;
-  _body.SetUserData(&_bodyUserData);
+  _body->SetUserData(&_bodyUserData);
 
   _arms.fill(nullptr);
   _joints.fill(nullptr);
@@ -139,7 +140,7 @@ Critter::Critter (const Genome &g, b2Body *b) : _genotype(g), _body(*b) {
 }
 
 Critter::Critter(const Genome &g, b2Body *body, decimal e, float age,
-                 const phenotype::ANN *brainTemplate)
+                 const phenotype::ANN *brainTemplate, bool asyncBrain)
   : Critter(g, body) {
 
   static const decimal initEnergyRatio =
@@ -150,21 +151,16 @@ Critter::Critter(const Genome &g, b2Body *body, decimal e, float age,
   _age = age;
   setEfficiencyCoeffs(matureAt(), _ec0Coeff, oldAt(), _ec1Coeff);
 
+  _size = initialSize(g, age);
   if (age == 0) {
     _efficiency = 0;
     _nextGrowthStep = nextGrowthStepAt(0);    
-    _size = MIN_SIZE;
 
   } else {
     _efficiency = efficiency(_age, matureAt(), _ec0Coeff, oldAt(), _ec1Coeff);
 
     uint step = config::Simulation::growthSubsteps();
-    if (isYouth()) {
-      step *= _efficiency;
-      _size = _efficiency * (MAX_SIZE - MIN_SIZE) + MIN_SIZE;
-
-    } else
-      _size = MAX_SIZE;
+    if (isYouth())  step *= _efficiency;
 
     _nextGrowthStep = nextGrowthStepAt(step);
   }
@@ -238,21 +234,22 @@ Critter::Critter(const Genome &g, b2Body *body, decimal e, float age,
 
   generateVisionRays();
 
-  buildBrain(brainTemplate);
+  energyCosts.fill(0);
 
-  if (brainTemplate)
-    assertEqual(*brainTemplate, _brain, true);
+  static const auto &gestation = config::Simulation::gestationSteps();
+  if (asyncBrain && !brainTemplate && gestation > 0)
+    gestate(gestation);
 
-  updateColors();
+  else {
+    buildBrain(brainTemplate);
 
-  /// TODO Not returned to the environment
-  auto axonsCost = _brain.stats().axons * config::Simulation::axonEnergyCost();
-  _energy -= axonsCost;
-  if (debugMetabolism)
-    std::cerr << "Lost " << axonsCost << " energy to axons\n";
+    if (brainTemplate)
+      assertEqual(*brainTemplate, _brain, true);
 
-  energyCosts.fill(0);
-  energyCosts[3] = axonsCost;
+    payAxons();
+  }
+
+  updateColors();
 
   _feedingSources.fill(0);
 
@@ -260,18 +257,35 @@ Critter::Critter(const Genome &g, b2Body *body, decimal e, float age,
 }
 
 Critter::~Critter (void) {
-  b2World *world = _body.GetWorld();
+  b2World *world = _body->GetWorld();
   for (b2Joint *j: _joints)  if (j) world->DestroyJoint(j);
   for (b2Body *b: _arms) if (b) world->DestroyBody(b);
-  world->DestroyBody(&_body);
+  world->DestroyBody(_body);
+}
+
+void Critter::payAxons (void) {
+  /// TODO Not returned to the environment
+  auto axonsCost = _brain.stats().axons * config::Simulation::axonEnergyCost();
+  _energy -= axonsCost;
+  if (debugMetabolism)
+    std::cerr << "Lost " << axonsCost << " energy to axons\n";
+
+  energyCosts[3] = axonsCost;
 }
 
 std::vector<std::string> Critter::neuralInputsHeader(void) const {
+  return neuralInputsHeader(_raysEnd.size());
+}
+
+/// Names in the order used by neuralStep (only for compiled-in sensors)
+std::vector<std::string> Critter::neuralInputsHeader (uint rays) {
   std::vector<std::string> v;
+#ifdef WITH_SENSORS_HEALTH
   v.push_back("HA");
   v.push_back("HI");
+#endif
 
-  for (uint i=0; i<_raysEnd.size(); i++)
+  for (uint i=0; i<rays; i++)
     for (auto c: {'R','G','B'})
       v.push_back(utils::mergeToString("R", i, c));
 
@@ -282,17 +296,19 @@ std::vector<std::string> Critter::neuralInputsHeader(void) const {
       v.push_back(utils::mergeToString("A", c, "C", i));
   }
 
+#ifdef WITH_SENSORS_TOUCH
   v.push_back("TB");
 #if NUMBER_OF_SPLINES > 0
   for (auto c: {'L','R'})
     for (uint i=0; i<SPLINES_COUNT; i++)
       v.push_back(utils::mergeToString("T", c, "S", i));
+#endif
 #endif
 
   return v;
 }
 
-std::vector<std::string> Critter::neuralOutputsHeader (void) const {
+std::vector<std::string> Critter::neuralOutputsHeader (void) {
   std::vector<std::string> v;
   v.push_back("ML");
   v.push_back("MR");
@@ -304,11 +320,22 @@ std::vector<std::string> Critter::neuralOutputsHeader (void) const {
   v.push_back("VC");
 #endif
 #if ARMS > 0
-  for (uint i=0; i<_arms.size(); i++) v.push_back(utils::mergeToString("A", i));
+  for (uint i=0; i<ARTICULATIONS; i++)
+    v.push_back(utils::mergeToString("A", i));
 #endif
   return v;
 }
 
+float Critter::initialSize (const Genome &g, float age) {
+  if (age == 0) return MIN_SIZE;
+  if (g.matureAge <= age) return MAX_SIZE;
+
+  float c0Coeff, c1Coeff;
+  setEfficiencyCoeffs(g.matureAge, c0Coeff, g.oldAge, c1Coeff);
+  float e = efficiency(age, g.matureAge, c0Coeff, g.oldAge, c1Coeff);
+  return e * (MAX_SIZE - MIN_SIZE) + MIN_SIZE;
+}
+
 /// Public accessor (generates and discards visual rays)
 void Critter::buildBrain (const Genome &genotype, float bodyRadius,
                           phenotype::ANN &brain) {
@@ -318,6 +345,31 @@ void Critter::buildBrain (const Genome &genotype, float bodyRadius,
   buildBrain(genotype, visionEnd, brain);
 }
 
+uint Critter::applyLesions (phenotype::ANN &brain, int lesions) {
+  uint count = 0;
+  if (lesions == 0) return count;
+
+  for (auto &ptr: brain.neurons()) {
+    phenotype::ANN::Neuron &n = *ptr;
+    for (auto it=n.links().begin(); it!=n.links().end(); ) {
+      phenotype::ANN::Neuron &tgt = *(it->in.lock());
+      if (tgt.type == phenotype::ANN::Neuron::I
+          && (lesions == 3
+            || (lesions == 1 && tgt.pos.y() < -.75)   // deactivate vision
+            || (lesions == 2 && tgt.pos.y() >= -.75)  // deactivate audition
+            || (n.flags == 1024 && ( // deactivate amygdala inputs
+                 (lesions == 4 && tgt.pos.y() == -1)    // deactivate red
+              || (lesions == 5 && tgt.pos.y() == -.75))))) { // deactivate noise audition
+        it = n.links().erase(it);
+        count++;
+      } else
+        ++it;
+    }
+  }
+
+  return count;
+}
+
 /// Private static builder (reuse previously generated visual rays)
 void Critter::buildBrain (const Genome &genotype,
                           const VisionEndPoints &raysEnd,
@@ -446,6 +498,7 @@ void Critter::buildBrain (const Genome &genotype,
 /// Private member builder (reuses previously generated visual rays and
 /// initializes members variables)
 void Critter::buildBrain(const phenotype::ANN *brainTemplate) {
+  Trace::Span span ("brain", "critter", int64_t(id()));
   /// Either copy provided brain or create from scratch
   if (brainTemplate)
         brainTemplate->copyInto(_brain);
@@ -456,29 +509,117 @@ void Critter::buildBrain(const phenotype::ANN *brainTemplate) {
   selectiveBrainDead.resize(_neuralOutputs.size());
 }
 
+void Critter::gestate (uint remaining) {
+  _gestation = std::make_unique<Gestation>();
+  _gestation->remaining = remaining;
+  _gestation->brain = WorkerPool::instance().submit(
+    [genome = _genotype, rays = _raysEnd] {
+    phenotype::ANN brain;
+    buildBrain(genome, rays, brain);
+    return brain;
+  });
+}
+
+void Critter::birth (void) {
+  Trace::Span span ("birth", "critter", int64_t(id()));
+  _brain = _gestation->brain.get();
+  _gestation.reset();
+
+  _neuralInputs = _brain.inputs();
+  _neuralOutputs = _brain.outputs();
+  selectiveBrainDead.resize(_neuralOutputs.size());
+
+  payAxons();
+}
+
 void Critter::step(Environment &env) {
-  // Driving improvement
-  drivingCorrections();
+  prepare(env);
+  think(env, &env.profiler());
+  act(env);
+}
 
-  // Monitor articulations
+void Critter::prepare (Environment &env) {
+  // Both taken care of by drift, when dormant
+  if (!_dormancy.dormant) {
+    // Driving improvement
+    drivingCorrections();
+
+    // Monitor articulations (or pin them when nothing is solved)
 #if ARMS > 0
-  articulationsManagement();
+    if (env.kinematic())  alignArms();
+    else                  articulationsManagement();
+#else
+    (void)env;
 #endif
+  }
+
+  // Brain is ready at a fixed step (whether it was built in the background
+  // or has to be built now)
+  if (_gestation && _gestation->remaining-- == 0) birth();
+}
+
+void Critter::think (const Environment &env, Profiler *p) {
+  if (_gestation) return;
+
+  if (!p) {
+    performVision(env);
+    neuralStep();
+    return;
+  }
+
+  const uint cid = uint(id());
+  { // Launch a bunch of rays
+    auto t = p->time(Profiler::VISION, cid);
+    performVision(env);
+  }
 
-  // Launch a bunch of rays
+  { // Query neural network
+    auto t = p->time(Profiler::NEURAL, cid);
+    neuralStep();
+  }
+}
+
+void Critter::think (const Environment &env, ThinkDurations &d) {
+  d = ThinkDurations{};
+  if (!Profiler::enabled()) {
+    think(env, nullptr);
+    return;
+  }
+  if (_gestation) return;
+
+  using clock = Profiler::clock;
+  const auto since = [] (const clock::time_point &t) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      clock::now() - t).count());
+  };
+
+  auto start = clock::now();
   performVision(env);
+  d.vision = since(start);
 
-  // Query neural network
+  start = clock::now();
   neuralStep();
+  d.neural = since(start);
+}
 
-  // Distribute energy
-  energyConsumption(env);
+void Critter::act (Environment &env) {
+  Profiler &p = env.profiler();
+  const uint cid = uint(id());
 
-  // Regenerate body/artifacts as needed
-  regeneration(env);
+  {
+    auto t = p.time(Profiler::METABOLISM, cid);
+
+    // Distribute energy
+    energyConsumption(env);
 
-  // Age-specific tasks
-  aging(env);
+    // Regenerate body/artifacts as needed
+    regeneration(env);
+  }
+
+  { // Age-specific tasks
+    auto t = p.time(Profiler::AGING, cid);
+    aging(env);
+  }
 
   // Udate appearance
   updateColors();
@@ -507,14 +648,14 @@ void Critter::autopsy (void) const {
 // == Substeps
 
 void Critter::drivingCorrections(void) {
-  P2D velocity = _body.GetLinearVelocity();
+  P2D velocity = _body->GetLinearVelocity();
   if (velocity.Length() < 1e-3) return;
 
-  P2D tengentialNormal = _body.GetWorldVector({0,1}),
+  P2D tengentialNormal = _body->GetWorldVector({0,1}),
       lateralVelocity = b2Dot(tengentialNormal, velocity) * tengentialNormal;
 
-  P2D zeroImpulse = -_body.GetMass() * lateralVelocity;
-  _body.ApplyLinearImpulseToCenter(zeroImpulse, true);
+  P2D zeroImpulse = -_body->GetMass() * lateralVelocity;
+  _body->ApplyLinearImpulseToCenter(zeroImpulse, true);
 }
 
 void Critter::articulationsManagement(void) {
@@ -576,21 +717,34 @@ void Critter::performVision(const Environment &env) {
       if (thatData->type == BodyType::CRITTER && self == thatData->ptr.critter)
         return -1;
 
+      if (!Environment::sameArena(body, thatBody))  return -1;
+
       closestContact = fixture;
       closestFraction = fraction;
       return fraction;
     }
-  } cvc (&_body);
+  } cvc (_body);
+
+  const PlantField &plants = env.plants();
 
   uint n = _raysEnd.size(), h = n/2;
   for (uint ie=0; ie<n; ie++) {
     cvc.reset();
     uint is = ie / h;
-    env.physics().RayCast(&cvc,
-                          _body.GetWorldPoint(_raysStart[is]),
-                          _body.GetWorldPoint(_raysEnd[ie]));
+    const b2Vec2 p1 = _body->GetWorldPoint(_raysStart[is]),
+                 p2 = _body->GetWorldPoint(_raysEnd[ie]);
+    env.rayCast(&cvc, p1, p2);
 
-    if (cvc.closestContact) { // Found something !
+    // Plants outside of the physics (if any) in front of what Box2D found
+    PlantField::Hit plant = plants.rayCast(p1, p2, cvc.closestFraction, _body);
+
+    if (plant.plant) {
+      _retina[ie] = plant.plant->color();
+#ifndef CLUSTER_BUILD
+      _raysFraction[ie] = plant.fraction;
+#endif
+
+    } else if (cvc.closestContact) { // Found something !
 //      std::cerr << "Raycast(" << ie << "): " << cvc.closestFraction
 //                << " with " << cvc.closestContact << std::endl;
 
@@ -718,9 +872,16 @@ void Critter::neuralStep(void) {
     for (auto &m: _lmotors) {
       float s = config::Simulation::critterBaseSpeed()
           * m.second * _clockSpeed * _efficiency * _size;
-      P2D f = _body.GetWorldVector({s,0}),
-          p = _body.GetWorldPoint({0, int(m.first)*.5f*bodyRadius()});
-      _body.ApplyForce(f, p, true);
+      float y = int(m.first)*.5f*bodyRadius();
+      if (_dormancy.dormant) {  // Would wake the body
+        _dormancy.force += s;
+        _dormancy.torque -= y * s;
+
+      } else {
+        P2D f = _body->GetWorldVector({s,0}),
+            p = _body->GetWorldPoint({0, y});
+        _body->ApplyForce(f, p, true);
+      }
 
       if (debugMotors)
         std::cerr << CID(this) << " Applied motor force for " << m.first
@@ -741,7 +902,7 @@ void Critter::neuralStep(void) {
     uint vi=0;
 #endif
     assert(vi < VOCAL_CHANNELS);
-    _sounds[0] = std::min(1.f, _body.GetLinearVelocity().Length());
+    _sounds[0] = std::min(1.f, linearSpeed());
     _sounds[1+vi] = std::max(0.f, _voice[0]);
     assert(0 <= _sounds[1+vi] && _sounds[1+vi] <= 1);
   }
@@ -799,7 +960,7 @@ void Critter::energyConsumption (Environment &env) {
 #endif
   static const auto &N = config::Simulation::neuronEnergyConsumption();
 
-  static const auto activeNeurons = [] (auto brain) {
+  static const auto activeNeurons = [] (const phenotype::ANN &brain) {
     uint count = 0;
     for (const auto &n: brain.neurons())  if (n->value != 0) count ++;
     return count;
@@ -816,13 +977,14 @@ void Critter::energyConsumption (Environment &env) {
                         [] (float a, float b) { return a + fabs(b); }) * J;
 #endif
   de += (_voice[0] > 0) * V;
-  de += activeNeurons(_brain) * N;
+  const uint active = activeNeurons(_brain);
+  de += active * N;
 
   energyCosts[0] +=
     M * (std::fabs(_lmotors[Motor::LEFT]) + std::fabs(_lmotors[Motor::RIGHT]))
       * _clockSpeed * _size;
   energyCosts[1] += (_voice[0] > 0) * V;
-  energyCosts[2] += activeNeurons(_brain) * N;
+  energyCosts[2] += active * N;
 
   if (debugMetabolism) {
     std::cerr << CID(this) << " de = " << de
@@ -943,6 +1105,7 @@ void Critter::aging(Environment &env) {
     }
 
     _size = newSize;
+    env.structuralChange();
     updateShape();
     updateVisionRays();
     _nextGrowthStep = nextGrowthStepAt(step);
@@ -979,8 +1142,10 @@ void Critter::aging(Environment &env) {
     // Just turned active -> create sensor
     if (hasSexualReproduction()
         && reproductionReadiness(reproductionType()) == 1
-        && _reproductionSensor == nullptr)
+        && _reproductionSensor == nullptr) {
+      env.structuralChange();
       _reproductionSensor = addReproFixture();
+    }
   }
 
   // Old critter. Destroy reproduction sensor
@@ -1295,7 +1460,7 @@ b2Fixture* Critter::addBodyFixture (void) {
   fd.filter.categoryBits = uint16(CollisionFlag::CRITTER_BODY_FLAG);
   fd.filter.maskBits = uint16(CollisionFlag::CRITTER_BODY_MASK);
 
-  FixtureData cfd (_body, FixtureType::BODY, currentBodyColor());
+  FixtureData cfd (*_body, FixtureType::BODY, currentBodyColor());
 
   return addFixture(fd, cfd);
 }
@@ -1314,7 +1479,7 @@ b2Body* Critter::arm (uint splineIndex, Side side) {
   //  bodyDef.angularDamping = .95;
   //  bodyDef.linearDamping = .9;
 
-    a = _body.GetWorld()->CreateBody(&armDef);
+    a = _body->GetWorld()->CreateBody(&armDef);
     a->SetUserData(&_bodyUserData);
   }
 
@@ -1367,7 +1532,7 @@ b2Fixture* Critter::addPolygonFixture (uint splineIndex, Side side,
   fd.filter.categoryBits = uint16(CollisionFlag::CRITTER_SPLN_FLAG);
   fd.filter.maskBits = uint16(CollisionFlag::CRITTER_SPLN_MASK);
 
-  b2Body *refBody = &_body;
+  b2Body *refBody = _body;
   if (!isStaticSpline(splineIndex))
     refBody = arm(splineIndex, side);
 
@@ -1390,7 +1555,7 @@ b2Fixture* Critter::addAuditionFixture(void) {
   fd.filter.categoryBits = uint16(CollisionFlag::CRITTER_AUDT_FLAG);
   fd.filter.maskBits = uint16(CollisionFlag::CRITTER_AUDT_MASK);
 
-  return addFixture(fd, audioUserData(_body));
+  return addFixture(fd, audioUserData(*_body));
 }
 
 b2Fixture* Critter::addReproFixture(void) {
@@ -1406,7 +1571,7 @@ b2Fixture* Critter::addReproFixture(void) {
   fd.filter.categoryBits = uint16(CollisionFlag::CRITTER_REPRO_FLAG);
   fd.filter.maskBits = uint16(CollisionFlag::CRITTER_REPRO_MASK);
 
-  return addFixture(fd, reproUserData(_body));
+  return addFixture(fd, reproUserData(*_body));
 }
 
 b2Fixture* Critter::addFixture (const b2FixtureDef &def,
@@ -1420,6 +1585,7 @@ b2Fixture* Critter::addFixture (const b2FixtureDef &def,
     utils::Thrower("Unable to insert fixture ", data, " in collection");
 
   f->SetUserData(&pair.first->second);
+  _bodyUserData.revision = b2BodyUserData::nextRevision();
   return f;
 }
 
@@ -1427,6 +1593,94 @@ void Critter::delFixture (b2Fixture *f) {
   auto it = _b2FixturesUserData.find(f);
   it->second.body.DestroyFixture(f);
   _b2FixturesUserData.erase(it);
+  _bodyUserData.revision = b2BodyUserData::nextRevision();
+}
+
+void Critter::migrate (b2World &world, const P2D &offset) {
+  b2World *oldWorld = _body->GetWorld();
+
+  // Same bodies (fixtures, mass and velocities) in the new world
+  std::vector<std::pair<b2Fixture*, b2Fixture*>> fixtures;
+  const auto copy = [this, &world, &offset, &fixtures] (b2Body *b) {
+    b2Body *b_ = Box2DUtils::clone(b, &world);
+    b_->SetTransform(b->GetPosition() + offset, b->GetAngle());
+    b_->SetUserData(&_bodyUserData);
+
+    // Fixtures are prepended: recreate them in reverse to keep their order
+    std::vector<b2Fixture*> bfixtures;
+    for (b2Fixture *f = b->GetFixtureList(); f; f = f->GetNext())
+      bfixtures.push_back(f);
+    for (auto it = bfixtures.rbegin(); it != bfixtures.rend(); ++it) {
+      b2Fixture *f = *it, *f_ = Box2DUtils::clone(f, b_);
+      const FixtureData &d = *get(f);
+      auto pair = _b2FixturesUserData.emplace(
+        f_, FixtureData(*b_, d.type, d.color, d.sindex, d.sside, d.aindex));
+      f_->SetUserData(&pair.first->second);
+      fixtures.emplace_back(f, f_);
+    }
+
+    b2MassData massData;
+    b->GetMassData(&massData);
+    b_->SetMassData(&massData);
+    b_->SetLinearVelocity(b->GetLinearVelocity());
+    b_->SetAngularVelocity(b->GetAngularVelocity());
+    return b_;
+  };
+
+  b2Body *body = copy(_body);
+  std::array<b2Body*, ARTICULATIONS> arms;
+  for (uint i=0; i<ARTICULATIONS; i++)
+    arms[i] = _arms[i] ? copy(_arms[i]) : nullptr;
+
+  const auto newBody = [this, body, &arms] (const b2Body *b) {
+    if (b == _body) return body;
+    for (uint i=0; i<ARTICULATIONS; i++)  if (b == _arms[i]) return arms[i];
+    return (b2Body*)nullptr;
+  };
+
+  // Same joints (warm starting is lost)
+  std::array<b2RevoluteJoint*, ARTICULATIONS> joints;
+  joints.fill(nullptr);
+  for (uint i=0; i<ARTICULATIONS; i++) {
+    b2RevoluteJoint *j = _joints[i];
+    if (!j) continue;
+
+    b2RevoluteJointDef jointDef {};
+    jointDef.bodyA = newBody(j->GetBodyA());
+    jointDef.bodyB = newBody(j->GetBodyB());
+    jointDef.collideConnected = j->GetCollideConnected();
+    jointDef.localAnchorA = j->GetLocalAnchorA();
+    jointDef.localAnchorB = j->GetLocalAnchorB();
+    jointDef.referenceAngle = j->GetReferenceAngle();
+    jointDef.enableLimit = j->IsLimitEnabled();
+    jointDef.lowerAngle = j->GetLowerLimit();
+    jointDef.upperAngle = j->GetUpperLimit();
+    jointDef.enableMotor = j->IsMotorEnabled();
+    jointDef.motorSpeed = j->GetMotorSpeed();
+    jointDef.maxMotorTorque = j->GetMaxMotorTorque();
+    joints[i] = (b2RevoluteJoint*)world.CreateJoint(&jointDef);
+  }
+
+  // Ends the old bodies' contacts (reported as this critter's, as usual)
+  for (b2Joint *j: _joints)  if (j) oldWorld->DestroyJoint(j);
+  for (b2Body *b: _arms) if (b) oldWorld->DestroyBody(b);
+  oldWorld->DestroyBody(_body);
+
+  const auto newFixture = [&fixtures] (b2Fixture *f) -> b2Fixture* {
+    for (const auto &p: fixtures) if (p.first == f) return p.second;
+    return nullptr;
+  };
+
+  _body = body;
+  _arms = arms;
+  _joints = joints;
+  if (_b2Body)  _b2Body = newFixture(_b2Body);
+  for (auto &v: _b2Artifacts) for (b2Fixture *&f: v) f = newFixture(f);
+  if (_auditionSensor)  _auditionSensor = newFixture(_auditionSensor);
+  if (_reproductionSensor)
+    _reproductionSensor = newFixture(_reproductionSensor);
+  for (const auto &p: fixtures) _b2FixturesUserData.erase(p.first);
+  _bodyUserData.revision = b2BodyUserData::nextRevision();
 }
 
 bool Critter::insideBody(const P2D &p) const {
@@ -1445,7 +1699,7 @@ void Critter::updateObjects(void) {
   for (auto &v: collisionObjects) v.clear();
 
   // clean everything
-  b2World *world = _body.GetWorld();
+  b2World *world = _body->GetWorld();
   for (uint i=0; i<SPLINES_COUNT; i++) {
     for (Side s: {Side::LEFT, Side::RIGHT}) {
       uint k = splineIndex(i, s);
@@ -1583,9 +1837,9 @@ void Critter::updateObjects(void) {
 
   if (config::Simulation::b2FixedBodyCOM()) {
     b2MassData d;
-    _body.GetMassData(&d);
+    _body->GetMassData(&d);
     d.center = {0,0};
-    _body.SetMassData(&d);
+    _body->SetMassData(&d);
   }
 
   if (ARMS == 1 && ARTICULATIONS_PER_ARM == 2) {
@@ -1605,10 +1859,10 @@ void Critter::updateObjects(void) {
       auto a = _arms[ix];
       b2Vec2 p0 = _splinesData[0].p0;
       if (s == Side::RIGHT) p0.y *= -1;
-      b2Vec2 p = _body.GetWorldPoint(p0);
+      b2Vec2 p = _body->GetWorldPoint(p0);
       a->SetTransform(p, rotation());
 
-      jointDef.Initialize(&_body, a, p);
+      jointDef.Initialize(_body, a, p);
       _joints[ix] = (b2RevoluteJoint*)world->CreateJoint(&jointDef);
     }
 
@@ -1620,7 +1874,7 @@ void Critter::updateObjects(void) {
       auto a = _arms[ix];
       b2Vec2 p1 = _splinesData[0].p1;
       if (s == Side::RIGHT) p1.y *= -1;
-      b2Vec2 p = _body.GetWorldPoint(p1);
+      b2Vec2 p = _body->GetWorldPoint(p1);
       a->SetTransform(p, rotation());
       jointDef.Initialize(_arms[ix-1], a, p);
       _joints[ix] = (b2RevoluteJoint*)world->CreateJoint(&jointDef);
@@ -1631,6 +1885,124 @@ void Critter::updateObjects(void) {
       ARTICULATIONS_PER_ARM);
 }
 
+void Critter::alignArms (void) {
+  const auto &d = _splinesData[0];
+  for (Side s: {Side::LEFT, Side::RIGHT}) {
+    const float sy = (s == Side::RIGHT) ? -1 : 1;
+    for (uint i=0; i<ARTICULATIONS_PER_ARM; i++) {
+      auto ix = i + uint(s)*ARTICULATIONS_PER_ARM;
+      if (!_joints[ix]) continue;
+      b2Vec2 p = (i == 0) ? d.p0 : d.p1;
+      p.y *= sy;
+      _arms[ix]->SetTransform(_body->GetWorldPoint(p), rotation());
+      _arms[ix]->SetLinearVelocity({0,0});
+      _arms[ix]->SetAngularVelocity(0);
+    }
+  }
+}
+
+bool Critter::isolated (const Environment &env) const {
+  struct Query : public b2QueryCallback {
+    const Critter *self;
+    bool empty;
+
+    Query (const Critter *c) : self(c), empty(true) {}
+
+    bool ReportFixture (b2Fixture *f) override {
+      const b2Body *b = f->GetBody();
+      const b2BodyUserData *d = get(b);
+      if (d->type == BodyType::CRITTER && d->ptr.critter == self) return true;
+      if (!Environment::sameArena(self->_body, b)) return true;
+      empty = false;
+      return false;
+    }
+  } q (this);
+
+  b2AABB box;
+  box.lowerBound = box.upperBound = _body->GetPosition();
+  const auto extend = [&box] (const b2Body *b) {
+    for (const b2Fixture *f = b->GetFixtureList(); f; f = f->GetNext())
+      for (int i=0; i<f->GetProxyCount(); i++)  box.Combine(f->GetAABB(i));
+  };
+  extend(_body);
+  for (const b2Body *a: _arms)  if (a) extend(a);
+
+  const float r = _visionRange + bodyRadius();
+  box.lowerBound -= P2D(r, r);
+  box.upperBound += P2D(r, r);
+
+  env.queryAABB(&q, box);
+  return q.empty;
+}
+
+void Critter::sleep (void) {
+  assert(!_dormancy.dormant);
+  Dormancy &d = _dormancy;
+  d.dormant = true;
+  d.v = _body->GetLinearVelocityFromLocalPoint({0,0});
+  d.w = _body->GetAngularVelocity();
+  d.force = d.torque = 0;
+
+  _body->SetAwake(false);
+  for (b2Body *a: _arms)  if (a) a->SetAwake(false);
+}
+
+void Critter::wake (void) {
+  assert(_dormancy.dormant);
+  Dormancy &d = _dormancy;
+  d.dormant = false;
+
+  // Rigid motion of the whole
+  const P2D &o = _body->GetPosition();
+  for (b2Body *b: _arms) {
+    if (!b) continue;
+    b->SetAwake(true);
+    b->SetLinearVelocity(d.v + b2Cross(d.w, b->GetWorldCenter() - o));
+    b->SetAngularVelocity(d.w);
+  }
+  _body->SetAwake(true);
+  _body->SetLinearVelocity(d.v + b2Cross(d.w, _body->GetWorldCenter() - o));
+  _body->SetAngularVelocity(d.w);
+}
+
+std::pair<float, float> Critter::lumpedInverseMass (void) const {
+  const P2D &o = _body->GetPosition();
+  float m = _body->GetMass(), I = _body->GetInertia();
+  for (const b2Body *a: _arms) {
+    if (!a) continue;
+    const float ma = a->GetMass();
+    m += ma;
+    I += a->GetInertia() - ma * a->GetLocalCenter().LengthSquared()
+       + ma * (a->GetWorldCenter() - o).LengthSquared();
+  }
+  return { m > 0 ? 1 / m : 0, I > 0 ? 1 / I : 0 };
+}
+
+void Critter::drift (float dt) {
+  assert(_dormancy.dormant);
+  Dormancy &d = _dormancy;
+
+  // Driving corrections: no lateral motion
+  const P2D lateral = _body->GetWorldVector({0,1});
+  d.v -= b2Dot(lateral, d.v) * lateral;
+
+  // Motors, as applied in neuralStep
+  const auto [invMass, invInertia] = lumpedInverseMass();
+  d.v += (dt * invMass * d.force) * _body->GetWorldVector({1,0});
+  d.w += dt * invInertia * d.torque;
+  d.force = d.torque = 0;
+
+  // Dampings, as in b2Island::Solve
+  d.v *= 1.f / (1.f + dt * _body->GetLinearDamping());
+  d.w *= 1.f / (1.f + dt * _body->GetAngularDamping());
+
+  _body->SetTransform(_body->GetPosition() + dt * d.v,
+                     _body->GetAngle() + dt * d.w);
+#if ARMS > 0
+  alignArms();
+#endif
+}
+
 // =============================================================================
 // == Unsorted stuff
 
@@ -1735,7 +2107,7 @@ void Critter::destroySpline(uint k) {
       destroySpline(k+1);
     }
 
-    b2World *world = _body.GetWorld();
+    b2World *world = _body->GetWorld();
     world->DestroyBody(_arms[aindex]);
     _arms[aindex] = nullptr;
     _joints[aindex] = nullptr;
@@ -1746,15 +2118,29 @@ void Critter::destroySpline(uint k) {
 
   if (config::Simulation::b2FixedBodyCOM()) {
     b2MassData d;
-    _body.GetMassData(&d);
+    _body->GetMassData(&d);
     d.center = {0,0};
-    _body.SetMassData(&d);
+    _body->SetMassData(&d);
   }
 #else
   (void)k;
 #endif
 }
 
+uint Critter::visionRays (const Genome &g) {
+  return 2 * (2 * g.vision.precision + 1);
+}
+
+float Critter::complexity (const Genome &g) {
+  uint splines = 0;
+  for (const auto &s: g.splines)
+    splines += (s.data[genotype::Spline::EL] > 0);
+
+  const auto &cppn = g.brain.cppn;
+  return visionRays(g) + 2 * splines
+       + g.brain.substeps * (1 + cppn.nodes.size() + cppn.links.size());
+}
+
 /// Static method for generating start/end points of visual rays
 /// @warning Member variables cannot be set up (naturally). Use member method
 /// for embodied instantiation
@@ -1762,8 +2148,8 @@ void Critter::generateVisionRays (const Genome &g, float radius,
                                   VisionStartPoints &starts,
                                   VisionEndPoints &ends) {
   const auto &v = g.vision;
-  uint rs_h = 2 * v.precision + 1;
-  uint rs = 2 * rs_h;
+  uint rs = visionRays(g);
+  uint rs_h = rs / 2;
 
   ends.resize(rs, P2D(0,0));
 
@@ -1902,7 +2288,8 @@ nlohmann::json Critter::save (const Critter &c) {
   assert(false);  // Brain save not implemented
   return nlohmann::json {
     c._genotype, jb, c._energy, c._age, c._reproductionReserve,
-    c._currHealth, c._destroyed.to_string(), c.userIndex
+    c._currHealth, c._destroyed.to_string(), c.userIndex,
+    c.gestating() ? nlohmann::json(c._gestation->remaining) : nlohmann::json()
   };
 }
 
@@ -1915,6 +2302,20 @@ Critter* Critter::load (const nlohmann::json &j, b2Body *body) {
   c->_destroyed = decltype(c->_destroyed)(j[6].get<std::string>());
   c->userIndex = j[7];
 
+  if (j.size() > 8 && !j[8].is_null()) {
+    // Brain was already built (and its axons paid for by the overwritten
+    // energy): it is only withheld until the same step as in the original
+    std::promise<phenotype::ANN> brain;
+    brain.set_value(std::move(c->_brain));
+    c->_brain = phenotype::ANN();
+    c->_neuralInputs = {};
+    c->_neuralOutputs = {};
+
+    c->_gestation = std::make_unique<Gestation>();
+    c->_gestation->remaining = j[8];
+    c->_gestation->brain = brain.get_future();
+  }
+
   return c;
 }
 
@@ -1945,12 +2346,13 @@ Critter* Critter::clone(const Critter *c, b2Body *b) {
 //  };
 
   assert(get(b) == &this_c->_bodyUserData);
-  assert(get(&this_c->_body) == &this_c->_bodyUserData);
+  assert(get(this_c->_body) == &this_c->_bodyUserData);
 
 #define COPY(X) this_c->X = c->X
 
   COPY(_visionRange);
   COPY(_size);
+  COPY(_dormancy);
 
   COPY(_bodyUserData);
   COPY(_currentColors);
@@ -1989,6 +2391,7 @@ Critter* Critter::clone(const Critter *c, b2Body *b) {
   assert(false); // not copying joints/arms ...
 
   COPY(_brain);
+  if (c->gestating()) this_c->gestate(c->_gestation->remaining);
 
   COPY(_age);
   COPY(_efficiency);
@@ -2043,13 +2446,22 @@ void assertEqual (const Critter &lhs, const Critter &rhs, bool deepcopy) {
   ASRT(_genotype);
   ASRT(_visionRange);
   ASRT(_size);
-  ASRT(_body);
+  ASRT(_dormancy.dormant);
+  ASRT(_dormancy.v);
+  ASRT(_dormancy.w);
+  ASRT(_dormancy.force);
+  ASRT(_dormancy.torque);
+  assertEqual(*lhs._body, *rhs._body, deepcopy);
   ASRT(_bodyUserData);
   ASRT(_currentColors);
   ASRT(_splinesData);
   ASRT(_b2Body);
   ASRT(_b2Artifacts);
-  ASRT(_b2FixturesUserData);
+  { // Compared as standard maps (pooled nodes are irrelevant)
+    using M = std::map<b2Fixture*, FixtureData>;
+    const auto &l = lhs._b2FixturesUserData, &r = rhs._b2FixturesUserData;
+    assertEqual(M(l.begin(), l.end()), M(r.begin(), r.end()), deepcopy);
+  }
   ASRT(_masses);
   ASRT(_retina);
   ASRT(_raysStart);
@@ -2061,6 +2473,10 @@ void assertEqual (const Critter &lhs, const Critter &rhs, bool deepcopy) {
   ASRT(_clockSpeed);
   ASRT(_reproduction);
   ASRT(_brain);
+  assertEqual(lhs.gestating(), rhs.gestating(), deepcopy);
+  if (lhs.gestating())
+    assertEqual(lhs._gestation->remaining, rhs._gestation->remaining,
+                deepcopy);
   ASRT(_age);
   ASRT(_efficiency);
   ASRT(_ec0Coeff);
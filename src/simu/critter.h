@@ -2,11 +2,13 @@
 #define SIMU_CRITTER_H
 
 #include <bitset>
+#include <future>
 
 #include "kgd/eshn/phenotype/ann.h"
 
 #include "../genotype/critter.h"
 #include "config.h"
+#include "pool.h"
 
 #include "box2d/b2_body.h"
 #include "box2d/b2_revolute_joint.h"
@@ -21,8 +23,10 @@ DEFINE_PRETTY_ENUMERATION(Motor, LEFT = 1, RIGHT = -1)
 namespace simu {
 
 struct Environment;
+class Profiler;
+struct Kernels;
 
-class Critter {
+class Critter : public Pooled<Critter> {
 public:
   using Genome = genotype::Critter;
   using Sex = Genome::Sex;
@@ -99,7 +103,7 @@ private:
   float _visionRange; // Derived from genotype
   float _size; // in ]0,1] maturity-dependant
 
-  b2Body &_body;
+  b2Body *_body;
   b2BodyUserData _bodyUserData;
   std::array<Color, 1+2*SPLINES_COUNT> _currentColors;
 
@@ -160,12 +164,22 @@ private:
 
   b2Fixture *_b2Body;
   std::array<std::vector<b2Fixture*>, 2*SPLINES_COUNT> _b2Artifacts;
-  std::map<b2Fixture*, FixtureData> _b2FixturesUserData;
+  PooledMap<b2Fixture*, FixtureData> _b2FixturesUserData;
   std::array<decimal, 1+2*SPLINES_COUNT> _masses;
 
   std::array<b2Body*, ARTICULATIONS> _arms;
   std::array<b2RevoluteJoint*, ARTICULATIONS> _joints;
 
+  /// Level of detail: while nothing is around, the critter is taken out of the
+  /// solver (its bodies sleep) and moved by drift (see
+  /// config::Simulation::lodCritters)
+  struct Dormancy {
+    bool dormant = false;
+    P2D v {0,0};  ///< Velocities (zeroed by Box2D for sleeping bodies)
+    float w = 0;
+    float force = 0, torque = 0;    ///< Motors' output, for the next drift
+  } _dormancy;
+
   // ===========================================================================
   // == Vision cache data ==
   // (each vector of size 2*(2*genotype.vision.precision+1))
@@ -205,6 +219,14 @@ private:
 
   phenotype::ANN _brain;
 
+  /// Brain built in the background while the critter stays inert, for a fixed
+  /// number of steps (see config::Simulation::gestationSteps)
+  struct Gestation {
+    std::future<phenotype::ANN> brain;
+    uint remaining;
+  };
+  std::unique_ptr<Gestation> _gestation;
+
   float _age;
 
   float _efficiency, _ec0Coeff, _ec1Coeff;
@@ -262,11 +284,53 @@ public:
   std::array<float, 4> energyCosts;
 
   Critter(const Genome &g, b2Body *body, decimal e, float age = 0,
-          const phenotype::ANN *brainTemplate = nullptr);
+          const phenotype::ANN *brainTemplate = nullptr,
+          bool asyncBrain = false);
   ~Critter (void);
 
   void step (Environment &env);
 
+  /// The step split in three (see config::Simulation::twoPhaseStep): prepare
+  /// and act modify the world and must be called serially while think only
+  /// reads it (vision, neural network) and can run concurrently for distinct
+  /// critters. Timed by p, if not null
+  void prepare (Environment &env);
+  void think (const Environment &env, Profiler *p);
+  void act (Environment &env);
+
+  /// Durations (ns) of think's phases, for concurrent calls which cannot share
+  /// a profiler. Null when not profiling or during gestation
+  struct ThinkDurations {
+    uint64_t vision = 0, neural = 0;
+  };
+
+  /// Same as above, timed into d (to be recorded afterwards, serially)
+  void think (const Environment &env, ThinkDurations &d);
+
+  /// Level of detail (see config::Simulation::lodCritters)
+  ///
+  /// A critter whose envelope (its fixtures, sensors included, extended by its
+  /// vision range and a body radius) overlaps nothing else is isolated. It is
+  /// then put to sleep: Box2D skips its bodies and joints and drift advances
+  /// it instead, with the motors' forces, the driving corrections and the
+  /// dampings of the solver but with its arms rigidly following the body
+  /// (see alignArms) and their mass lumped into the body's.
+  /// It is woken up, with its velocities, as soon as anything enters that
+  /// envelope (or Box2D woke it up on its own)
+  bool isolated (const Environment &env) const;
+  void sleep (void);
+  void wake (void);
+  void drift (float dt);
+
+  /// Moves the critter's bodies, fixtures and joints (translated by offset)
+  /// into another physics world (see config::Simulation::physicsTiles).
+  /// Contacts end in the old world and begin anew in the new one
+  void migrate (b2World &world, const P2D &offset);
+
+  bool dormant (void) const {
+    return _dormancy.dormant;
+  }
+
   const auto& genotype (void) const {
     return _genotype;
   }
@@ -303,7 +367,16 @@ public:
 #endif
 
   auto pos (void) const {
-    return _body.GetPosition();
+    return _body->GetPosition();
+  }
+
+  /// See b2BodyUserData::arena (shared by the arms)
+  int arena (void) const {
+    return _bodyUserData.arena;
+  }
+
+  void setArena (int a) {
+    _bodyUserData.arena = a;
   }
 
   auto x (void) const {
@@ -316,15 +389,15 @@ public:
 
   // in radians
   auto rotation (void) const {
-    return _body.GetAngle();
+    return _body->GetAngle();
   }
 
   const b2Body& body (void) const {
-    return _body;
+    return *_body;
   }
 
   b2Body& body (void) {
-    return _body;
+    return *_body;
   }
 
   const auto& arms (void) const {
@@ -352,19 +425,28 @@ public:
   }
 
   auto mass (void) const {
-    return _body.GetMass();
+    return _body->GetMass();
   }
 
   auto momentOfInertia (void) const {
-    return _body.GetInertia();
+    return _body->GetInertia();
+  }
+
+  /// Also valid when dormant (see drift)
+  const P2D& linearVelocity (void) const {
+    return _dormancy.dormant ? _dormancy.v : _body->GetLinearVelocity();
+  }
+
+  float angularVelocity (void) const {
+    return _dormancy.dormant ? _dormancy.w : _body->GetAngularVelocity();
   }
 
   auto linearSpeed (void) const {
-    return _body.GetLinearVelocity().Length();
+    return linearVelocity().Length();
   }
 
   auto angularSpeed (void) const {
-    return _body.GetAngularVelocity();
+    return angularVelocity();
   }
 
   auto efficiency (void) const {
@@ -564,6 +646,11 @@ public:
     return _brain;
   }
 
+  /// Whether the brain is still being built (the critter is then inert)
+  bool gestating (void) const {
+    return bool(_gestation);
+  }
+
   auto& brain (void) {
     return _brain;
   }
@@ -613,11 +700,12 @@ public:
   }
 
   std::vector<std::string> neuralInputsHeader (void) const;
+  static std::vector<std::string> neuralInputsHeader (uint rays);
   const auto& neuralInputs (void) const {
     return _neuralInputs;
   }
 
-  std::vector<std::string> neuralOutputsHeader (void) const;
+  static std::vector<std::string> neuralOutputsHeader (void);
   const auto& neuralOutputs (void) const {
     return _neuralOutputs;
   }
@@ -767,6 +855,19 @@ public:
   static void buildBrain (const Genome &genotype, float bodyRadius,
                           phenotype::ANN &brain);
 
+  /// Deletes the links from some of the brain's inputs (as in life-dinner's
+  /// evaluations): 1 vision, 2 audition, 3 all, 4 (resp. 5) red vision (resp.
+  /// noise audition) into the amygdala. Returns the number of deleted links
+  static uint applyLesions (phenotype::ANN &brain, int lesions);
+
+  /// Number of visual rays (and thus of retina cells) for this genome
+  static uint visionRays (const Genome &g);
+
+  /// Relative cost of simulating this genome, predicted without building it:
+  /// vision rays, fixtures of its (non-empty) splines and brain updates scaled
+  /// by the size of its CPPN (as a proxy for the ANN's)
+  static float complexity (const Genome &g);
+
   // ===========================================================================
   // == Conversion
 
@@ -797,6 +898,9 @@ public:
 
   static float nextGrowthStepAt (uint currentStep);
 
+  /// Size of a critter created at the given age
+  static float initialSize (const Genome &g, float age);
+
   static constexpr decimal energyForCreation (void) {
     return 2*maximalEnergyStorage(MIN_SIZE);
   }
@@ -819,6 +923,8 @@ public:
   static Critter* load (const nlohmann::json &j, b2Body *body);
 
 private:
+  friend Kernels; // Micro-benchmarks (tools/microbench.cpp)
+
   Critter (const Genome &g, b2Body *b);
 
   void updateColors(void);
@@ -828,6 +934,13 @@ private:
 
   void drivingCorrections (void);
   void articulationsManagement (void);
+
+  /// Places the arms in their rest pose relative to the body (kinematic mode)
+  void alignArms (void);
+
+  /// Inverse mass and inertia (around the body's origin) of the body and arms
+  /// as a rigid whole. Not cached: growth changes them while dormant
+  std::pair<float, float> lumpedInverseMass (void) const;
   void performVision (const Environment &env);
   void neuralStep (void);
   void energyConsumption (Environment &env);
@@ -873,6 +986,16 @@ private:
                           phenotype::ANN &brain);
   void buildBrain (const phenotype::ANN *brainTemplate);
 
+  /// Builds the brain on the worker pool, installed in the given number of
+  /// steps (see birth)
+  void gestate (uint remaining);
+
+  /// Installs the brain built by the worker pool (waiting for it if needed)
+  void birth (void);
+
+  /// Deducts the energy invested in the brain's axons
+  void payAxons (void);
+
   // ===========================================================================
 };
 
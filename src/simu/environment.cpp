@@ -4,6 +4,8 @@
 #include "foodlet.h"
 #include "config.h"
 #include "box2dutils.h"
+#include "allocations.h"
+#include "workerpool.h"
 
 namespace simu {
 
@@ -63,17 +65,25 @@ struct UDID {
   }
 };
 
+/// Default filtering (categories and masks) restricted to a single arena
+struct ArenaFilter : public b2ContactFilter {
+  bool ShouldCollide (b2Fixture *fA, b2Fixture *fB) override {
+    return Environment::sameArena(fA->GetBody(), fB->GetBody())
+        && b2ContactFilter::ShouldCollide(fA, fB);
+  }
+};
+
 struct CollisionMonitor : public b2ContactListener {
   Environment &e;
 
   CollisionMonitor (Environment &e) : e(e) {}
 
-  Critter* critter (const b2BodyUserData &d) {
+  static Critter* critter (const b2BodyUserData &d) {
     if (d.type == BodyType::CRITTER)  return d.ptr.critter;
     return nullptr;
   }
 
-  Foodlet* foodlet (const b2BodyUserData &d) {
+  static Foodlet* foodlet (const b2BodyUserData &d) {
     if (d.type == BodyType::PLANT
         || d.type == BodyType::CORPSE)  return d.ptr.foodlet;
     return nullptr;
@@ -87,9 +97,10 @@ struct CollisionMonitor : public b2ContactListener {
     return (uint16(lhs) << 8) | uint16(rhs);
   }
 
-  Critter* isTouch (const b2BodyUserData &dA, b2Fixture *fA,
-                    const b2BodyUserData &dB, b2Fixture *fB) {
+  static Critter* isTouch (const b2BodyUserData &dA, b2Fixture *fA,
+                           const b2BodyUserData &dB, b2Fixture *fB) {
     if (fB->IsSensor()) return nullptr;
+    if (dA.ghost) return nullptr; // Registered in the critter's own tile
 
     auto cA = critter(dA);
     if (!cA) return nullptr;
@@ -108,32 +119,93 @@ struct CollisionMonitor : public b2ContactListener {
     return nullptr;
   }
 
-  bool isAudition (const b2Fixture *fA, const b2Fixture *fB) {
+  static bool isAudition (const b2Fixture *fA, const b2Fixture *fB) {
     /// TODO maybe dangerous
     return (Critter::get(fA)->type | Critter::get(fB)->type)
         == (Critter::FixtureType::AUDITION | Critter::FixtureType::BODY);
   }
 
-  bool isMatingAttempt (const b2Fixture *fA, const b2Fixture *fB) {
+  static bool isMatingAttempt (const b2Fixture *fA, const b2Fixture *fB) {
     return (Critter::get(fA)->type & Critter::get(fB)->type)
         == Critter::FixtureType::REPRODUCTION;
   }
 
+  /// Whether the interaction between these bodies is processed through this
+  /// contact. Always true in a single world. In a tiled one, a pair seen
+  /// from several tiles (through ghosts) is only processed in that of the
+  /// critter with the lowest id (or of the only critter)
+  static bool owned (const b2BodyUserData &dA, const b2BodyUserData &dB) {
+    if (!dA.ghost && !dB.ghost) return true;
+    if (dA.ghost && dB.ghost) return false;
+
+    const b2BodyUserData &real = dA.ghost ? dB : dA,
+                         &ghost = dA.ghost ? dA : dB;
+    Critter *cR = critter(real), *cG = critter(ghost);
+    if (!cR)  return false;
+    return !cG || cR->id() < cG->id();
+  }
+
+  /// Disables collisions between moving parts of a critter
+  static bool selfCollision (b2Contact *c) {
+    const b2BodyUserData &dA = *Critter::get(c->GetFixtureA()->GetBody()),
+                         &dB = *Critter::get(c->GetFixtureB()->GetBody());
+    if (dA.type == BodyType::CRITTER && dB.type == BodyType::CRITTER
+        && dA.ptr.critter == dB.ptr.critter) {
+      if (ignoreSelfCollisions) c->SetEnabled(false);
+      return true;
+    }
+    return false;
+  }
+
   struct Velocities { float A, B; };
-  Velocities velocities (const b2Contact *c, b2Fixture *fA, b2Fixture *fB) {
+  static Velocities velocities (const b2Contact *c) {
     b2WorldManifold m;
     c->GetWorldManifold(&m);
     static const auto velocity = [] (const b2Body &b, const b2Vec2 &p) {
       return b.GetLinearVelocityFromWorldPoint(p).Length();
     };
-    return { velocity(Critter::get(fA)->body, m.points[0]),
-             velocity(Critter::get(fB)->body, m.points[0]) };
+    return { velocity(*c->GetFixtureA()->GetBody(), m.points[0]),
+             velocity(*c->GetFixtureB()->GetBody(), m.points[0]) };
+  }
+
+  /// Velocities of the fixtures (in the contact's order), if fighting
+  static Velocities fightVelocities (const b2Contact *c) {
+    const b2Fixture *fA = c->GetFixtureA(), *fB = c->GetFixtureB();
+    if (Critter::get(fA->GetBody())->type != BodyType::CRITTER
+        || Critter::get(fB->GetBody())->type != BodyType::CRITTER
+        || isMatingAttempt(fA, fB))
+      return {0, 0};
+    return velocities(c);
+  }
+
+  static float totalImpulse (const b2ContactImpulse *impulse) {
+    float total = 0;
+    for (int i=0; i<impulse->count; i++)  total += impulse->normalImpulses[i];
+    return total;
   }
 
   void BeginContact(b2Contact *c) override {
     if (!c->IsTouching()) return;
+    begin(c->GetFixtureA(), c->GetFixtureB());
+  }
+
+  void PreSolve(b2Contact *c, const b2Manifold */*oldManifold*/) override {
+    if (selfCollision(c)) return;
+    preSolve(c->GetFixtureA(), c->GetFixtureB(), fightVelocities(c));
+  }
+
+  void PostSolve(b2Contact* c, const b2ContactImpulse* impulse) override {
+    postSolve(c->GetFixtureA(), c->GetFixtureB(), totalImpulse(impulse),
+              fightVelocities(c));
+  }
+
+  void EndContact(b2Contact *c) override {
+    end(c->GetFixtureA(), c->GetFixtureB());
+  }
+
+  // ===========================================================================
 
-    b2Fixture *fA = c->GetFixtureA(), *fB = c->GetFixtureB();
+  void begin (b2Fixture *fA, b2Fixture *fB) {
     b2Body *bA = fA->GetBody(), *bB = fB->GetBody();
     const b2BodyUserData &dA = *Critter::get(bA),
                          &dB = *Critter::get(bB);
@@ -141,6 +213,8 @@ struct CollisionMonitor : public b2ContactListener {
     if (auto c = isTouch(dA, fA, dB, fB)) registerTouchStart(c, fA);
     if (auto c = isTouch(dB, fB, dA, fA)) registerTouchStart(c, fB);
 
+    if (!owned(dA, dB)) return;
+
     switch (pair(dA.type, dB.type)) {
     case pair(BodyType::CRITTER, BodyType::CRITTER):
       if (isAudition(fA, fB))
@@ -176,32 +250,22 @@ struct CollisionMonitor : public b2ContactListener {
     }
   }
 
-  void PreSolve(b2Contact *c, const b2Manifold */*oldManifold*/) override {
-    b2Fixture *fA = c->GetFixtureA(), *fB = c->GetFixtureB();
+  void preSolve (b2Fixture *fA, b2Fixture *fB, const Velocities &v) {
     b2Body *bA = fA->GetBody(), *bB = fB->GetBody();
     const b2BodyUserData &dA = *Critter::get(bA),
                          &dB = *Critter::get(bB);
 
-    // Disable collisions between moving parts of a critter
-    if (dA.type == BodyType::CRITTER && dB.type == BodyType::CRITTER
-        && dA.ptr.critter == dB.ptr.critter) {
-      if (ignoreSelfCollisions) c->SetEnabled(false);
-      return;
-    }
+    if (!owned(dA, dB)) return;
 
 //    std::cerr << __PRETTY_FUNCTION__ << "\n"
 //              << UDID(bA, dA, fA) << " & " << UDID(bB, dB, fB) << "\n";
-//    b2WorldManifold m;
-//    c->GetWorldManifold(&m);
-//    for (int i=0; i<c->GetManifold()->pointCount; i++)
-//      std::cerr << m.points[i] << "\n";
 //    for (b2Body *b: {bA, bB}) b->Dump();
 //    std::cerr << "\n";
 
     switch (pair(dA.type, dB.type)) {
     case pair(BodyType::CRITTER, BodyType::CRITTER):
       if (!isMatingAttempt(fA, fB))
-        processFightPreStep(c, critter(dA), fA, critter(dB), fB);
+        processFightPreStep(critter(dA), fA, critter(dB), fB, v);
       break;
 
     case pair(BodyType::CRITTER, BodyType::PLANT):
@@ -219,24 +283,22 @@ struct CollisionMonitor : public b2ContactListener {
     }
   }
 
-  void PostSolve(b2Contact* c, const b2ContactImpulse* impulse) {
-    b2Fixture *fA = c->GetFixtureA(), *fB = c->GetFixtureB();
+  void postSolve (b2Fixture *fA, b2Fixture *fB, float impulse,
+                  const Velocities &v) {
     b2Body *bA = fA->GetBody(), *bB = fB->GetBody();
     const b2BodyUserData &dA = *Critter::get(bA),
                          &dB = *Critter::get(bB);
 
+    if (!owned(dA, dB)) return;
+
 //    std::cerr << __PRETTY_FUNCTION__ << "\n" << std::setprecision(20)
 //              << UDID(bA, dA, fA) << " & " << UDID(bB, dB, fB) << "\n"
-//              << "Impulse:\n";
-//    for (uint i=0; i<impulse->count; i++)
-//      std::cerr << "\t" << impulse->normalImpulses[i]
-//                << "\t" << impulse->tangentImpulses[i]
-//                << "\n";
+//              << "Impulse: " << impulse << "\n";
 
     switch (pair(dA.type, dB.type)) {
     case pair(BodyType::CRITTER, BodyType::CRITTER):
       if (!isMatingAttempt(fA, fB))
-        processFightPostStep(c, critter(dA), fA, critter(dB), fB, impulse);
+        processFightPostStep(critter(dA), fA, critter(dB), fB, impulse, v);
       break;
 
     default:
@@ -246,8 +308,7 @@ struct CollisionMonitor : public b2ContactListener {
     }
   }
 
-  void EndContact(b2Contact *c) override {
-    b2Fixture *fA = c->GetFixtureA(), *fB = c->GetFixtureB();
+  void end (b2Fixture *fA, b2Fixture *fB) {
     b2Body *bA = fA->GetBody(), *bB = fB->GetBody();
     const b2BodyUserData &dA = *Critter::get(bA),
                          &dB = *Critter::get(bB);
@@ -255,6 +316,8 @@ struct CollisionMonitor : public b2ContactListener {
     if (auto c = isTouch(dA, fA, dB, fB)) registerTouchEnd(c, fA);
     if (auto c = isTouch(dB, fB, dA, fA)) registerTouchEnd(c, fB);
 
+    if (!owned(dA, dB)) return;
+
     switch (pair(dA.type, dB.type)) {
     case pair(BodyType::CRITTER, BodyType::CRITTER):
       if (isAudition(fA, fB))
@@ -343,51 +406,57 @@ struct CollisionMonitor : public b2ContactListener {
     d.fixtures.insert({{fA,fB}, Environment::FightingData::FixturesData{}});
   }
 
-  void processFightPreStep (b2Contact *contact,
-                            Critter *cA, b2Fixture *fA,
-                            Critter *cB, b2Fixture *fB) {
+  /// Fixtures data of an ongoing fight, if any. In a tiled environment, a
+  /// contact between a real body and a ghost may start (or end) a step later
+  /// than its counterpart in the ghost's own tile
+  Environment::FightingData::FixturesData*
+  fightData (Critter *cA, b2Fixture *fA, Critter *cB, b2Fixture *fB) {
+    auto it = e._fightingEvents.find({ cA, cB });
+    if (it == e._fightingEvents.end())  return nullptr;
+    auto fit = it->second.fixtures.find({fA,fB});
+    if (fit == it->second.fixtures.end()) return nullptr;
+    return &fit->second;
+  }
+
+  void processFightPreStep (Critter *cA, b2Fixture *fA,
+                            Critter *cB, b2Fixture *fB, Velocities v) {
     if (cA == cB) return; // Different moving parts of the same critter
 
     if (cA->id() > cB->id()) { // ensure order
-      std::swap(cA, cB); std::swap(fA, fB);
+      std::swap(cA, cB); std::swap(fA, fB); std::swap(v.A, v.B);
     }
 
     for (Critter *c: { cA, cB }) {
-      Environment::CritterData &d = e._critterData.at(c);
-      d.totalImpulsions = 0;
+      auto it = e._critterData.find(c);
+      if (it != e._critterData.end()) it->second.totalImpulsions = 0;
     }
 
-    Environment::FightingData &d = e._fightingEvents.at({ cA, cB });
-    auto &fd = d.fixtures.at({fA,fB});
-    auto v = velocities(contact, fA, fB);
-    fd.A.velocity[0] = v.A;
-    fd.B.velocity[0] = v.B;
+    auto fd = fightData(cA, fA, cB, fB);
+    if (!fd)  return;
+    fd->A.velocity[0] = v.A;
+    fd->B.velocity[0] = v.B;
   }
 
-  void processFightPostStep (b2Contact *contact,
-                             Critter *cA, b2Fixture *fA,
+  void processFightPostStep (Critter *cA, b2Fixture *fA,
                              Critter *cB, b2Fixture *fB,
-                             const b2ContactImpulse *impulse) {
+                             float totalImpulse, Velocities v) {
     if (cA == cB) return; // Different moving parts of the same critter
 
     if (cA->id() > cB->id()) {  // ensure order
-      std::swap(cA, cB);  std::swap(fA, fB);
+      std::swap(cA, cB);  std::swap(fA, fB);  std::swap(v.A, v.B);
     }
 
-    float totalImpulse = 0;
-    for (int i=0; i<impulse->count; i++)
-      totalImpulse += impulse->normalImpulses[i];
-
-    for (Critter *c: { cA, cB })
-      e._critterData.at(c).totalImpulsions += totalImpulse;
-
-    Environment::FightingData &d = e._fightingEvents.at({ cA, cB });
-    auto &fd = d.fixtures.at({fA,fB});
-    fd.impulse = totalImpulse;
+    for (Critter *c: { cA, cB }) {
+      auto it = e._critterData.find(c);
+      if (it != e._critterData.end())
+        it->second.totalImpulsions += totalImpulse;
+    }
 
-    auto v = velocities(contact, fA, fB);
-    fd.A.velocity[1] = v.A;
-    fd.B.velocity[1] = v.B;
+    auto fd = fightData(cA, fA, cB, fB);
+    if (!fd)  return;
+    fd->impulse = totalImpulse;
+    fd->A.velocity[1] = v.A;
+    fd->B.velocity[1] = v.B;
   }
 
   void registerFightEnd (Critter *cA, b2Fixture *fA,
@@ -510,6 +579,92 @@ struct CollisionMonitor : public b2ContactListener {
 
 // =============================================================================
 
+uint b2BodyUserData::nextRevision (void) {
+  static std::atomic<uint> next = 0;
+  return next++;
+}
+
+/// Kinematic (static for static bodies) stand-in, in a tile, for a body of
+/// another tile. Shares its owner's data (critter, foodlet...) but for the
+/// ghost flag
+struct Ghost : public b2BodyUserData {
+  const b2Body *original;
+  const b2BodyUserData *owner;
+  b2Body *body = nullptr;
+  uint sync;  ///< Last synchronization that required it
+
+  /// Copies of the original fixtures' data (critters only)
+  std::vector<Critter::FixtureData> fixtures;
+};
+
+/// Contact reported by a tile's world while stepping (see TileMonitor)
+struct ContactEvent {
+  enum Type : uint8 { BEGIN, END, PRE_SOLVE, POST_SOLVE };
+  Type type;
+  b2Fixture *fA, *fB;
+  float impulse;
+  CollisionMonitor::Velocities v;
+};
+
+/// One of the worlds the arena is split into (see
+/// config::Simulation::physicsTiles)
+struct PhysicsTile {
+  std::unique_ptr<b2World> world;
+  b2Body *edges;  ///< The whole arena's, in every tile
+  b2AABB bounds;
+
+  /// Ghosts of other tiles' bodies, by original body
+  PooledMap<const b2Body*, Ghost> ghosts;
+
+  /// Contacts of the last step, not yet processed
+  std::vector<ContactEvent> events;
+  std::unique_ptr<b2ContactListener> monitor;
+};
+
+/// Contact listener of a tile's world when the arena is tiled. The worlds
+/// being stepped concurrently, contacts are only recorded (with what is only
+/// available during the step) and replayed afterwards, in tiles order (see
+/// Environment::replayContacts). Outside of a step (bodies destruction)
+/// they are processed immediately
+struct TileMonitor : public b2ContactListener {
+  CollisionMonitor &m;
+  PhysicsTile &t;
+
+  TileMonitor (CollisionMonitor &m, PhysicsTile &t) : m(m), t(t) {}
+
+  void record (ContactEvent::Type type, b2Contact *c, float impulse = 0,
+               CollisionMonitor::Velocities v = {0,0}) {
+    if (t.events.size() == t.events.capacity())
+      Allocations::Scope::poolGrowth();
+    t.events.push_back({type, c->GetFixtureA(), c->GetFixtureB(), impulse, v});
+  }
+
+  void BeginContact(b2Contact *c) override {
+    if (!t.world->IsLocked()) return m.BeginContact(c);
+    if (c->IsTouching())  record(ContactEvent::BEGIN, c);
+  }
+
+  void PreSolve(b2Contact *c, const b2Manifold *oldManifold) override {
+    if (!t.world->IsLocked()) return m.PreSolve(c, oldManifold);
+    if (CollisionMonitor::selfCollision(c)) return;
+    record(ContactEvent::PRE_SOLVE, c, 0,
+           CollisionMonitor::fightVelocities(c));
+  }
+
+  void PostSolve(b2Contact* c, const b2ContactImpulse* impulse) override {
+    if (!t.world->IsLocked()) return m.PostSolve(c, impulse);
+    record(ContactEvent::POST_SOLVE, c, CollisionMonitor::totalImpulse(impulse),
+           CollisionMonitor::fightVelocities(c));
+  }
+
+  void EndContact(b2Contact *c) override {
+    if (!t.world->IsLocked()) return m.EndContact(c);
+    record(ContactEvent::END, c);
+  }
+};
+
+// =============================================================================
+
 bool Environment::ID_CMP::operator() (const DestroyedSpline &lhs,
                                       const DestroyedSpline &rhs) const {
   if (lhs.first->id() != rhs.first->id())
@@ -519,18 +674,24 @@ bool Environment::ID_CMP::operator() (const DestroyedSpline &lhs,
 
 
 Environment::Environment(const Genome &g)
-  : _genome(g), _physics({0,0}),
-    _cmonitor(new CollisionMonitor(*this)) {
+  : _genome(g),
+    _tilesPerSide(std::max(1u, config::Simulation::physicsTiles())),
+    _cmonitor(new CollisionMonitor(*this)), _cfilter(new ArenaFilter) {
 
-  createEdges();
-  _physics.SetContactListener(_cmonitor);
+  _ghostMargin = 0;
+  _ghostSync = 0;
+  createWorld();
+  _plants.reset(width(), height());
 
   _energyReserve = 0;
+  _kinematic = false;
+  _structuralChanges = 0;
 }
 
 Environment::~Environment (void) {
-  _physics.DestroyBody(_edges);
+  for (auto &t: _tiles) t->world->DestroyBody(t->edges);
   delete _cmonitor;
+  delete _cfilter;
 }
 
 void Environment::init(decimal energy, uint rngSeed) {
@@ -538,6 +699,32 @@ void Environment::init(decimal energy, uint rngSeed) {
   if (rngSeed != uint(-1)) _dice.reset(rngSeed);
 }
 
+void Environment::reset (const Genome &g) {
+  for (const auto &t: _tiles) { // Only the edges remain
+    assert(t->world->GetBodyCount() == 1);
+    assert(t->ghosts.empty());
+  }
+
+  _genome = g;
+  createWorld();
+  _plants.reset(width(), height());
+
+  _critterData.clear();
+  _feedingEvents.clear();
+  _fightingEvents.clear();
+  _hearingEvents.clear();
+  _matingEvents.clear();
+  _edgeCritters.clear();
+  _destroyedSplines.clear();
+  _migrations.clear();
+  fightDataLogger.str("");
+
+  _energyReserve = 0;
+  _kinematic = false;
+  _dice = rng::FastDice();
+  _profiler.commit();
+}
+
 void Environment::modifyEnergyReserve (decimal e) {
 //  std::cerr << "Environment received " << (e>0?"+":"") << e << ", reserves are "
 //            << _energyReserve;
@@ -545,6 +732,103 @@ void Environment::modifyEnergyReserve (decimal e) {
 //  std::cerr << " >> " << _energyReserve << std::endl;
 }
 
+bool Environment::sameArena (const b2Body *lhs, const b2Body *rhs) {
+  int aL = Critter::get(lhs)->arena, aR = Critter::get(rhs)->arena;
+  return aL < 0 || aR < 0 || aL == aR;
+}
+
+const b2World& Environment::physics (void) const {
+  return *_tiles.front()->world;
+}
+
+b2World& Environment::physics (void) {
+  return *_tiles.front()->world;
+}
+
+const b2World& Environment::physics (uint tile) const {
+  return *_tiles[tile]->world;
+}
+
+b2World& Environment::physics (uint tile) {
+  return *_tiles[tile]->world;
+}
+
+b2Body* Environment::edges (void) {
+  return _tiles.front()->edges;
+}
+
+uint Environment::tileAt (const P2D &p) const {
+  const int n = _tilesPerSide;
+  const auto index = [n] (float v, float extent) {
+    int i = int(std::floor(n * (v + extent) / (2 * extent)));
+    return std::max(0, std::min(i, n-1));
+  };
+  return index(p.y, yextent()) * n + index(p.x, xextent());
+}
+
+/// Whether the AABBs overlap once the second is extended by margin
+static bool overlap (const b2AABB &lhs, const b2AABB &rhs, float margin) {
+  return lhs.lowerBound.x <= rhs.upperBound.x + margin
+      && rhs.lowerBound.x - margin <= lhs.upperBound.x
+      && lhs.lowerBound.y <= rhs.upperBound.y + margin
+      && rhs.lowerBound.y - margin <= lhs.upperBound.y;
+}
+
+void Environment::rayCast (b2RayCastCallback *callback,
+                           const b2Vec2 &p1, const b2Vec2 &p2) const {
+  if (!tiled()) return physics().RayCast(callback, p1, p2);
+
+  // Each world restarts from the whole ray: only report fixtures before the
+  // closest one so far (as a single world would)
+  struct Clipped : public b2RayCastCallback {
+    b2RayCastCallback *callback;
+    float fraction = 1;
+
+    Clipped (b2RayCastCallback *c) : callback(c) {}
+
+    float ReportFixture(b2Fixture *f, const b2Vec2 &p, const b2Vec2 &n,
+                        float fraction) override {
+      if (Critter::get(f->GetBody())->ghost)  return -1;
+      if (fraction > this->fraction)  return this->fraction;
+      float r = callback->ReportFixture(f, p, n, fraction);
+      if (0 <= r && r < this->fraction) this->fraction = r;
+      return r;
+    }
+  } clipped (callback);
+
+  b2AABB ray;
+  ray.lowerBound = b2Min(p1, p2);
+  ray.upperBound = b2Max(p1, p2);
+  for (const auto &t: _tiles) {
+    if (clipped.fraction <= 0)  break;
+    if (overlap(ray, t->bounds, _ghostMargin))
+      t->world->RayCast(&clipped, p1, p2);
+  }
+}
+
+void Environment::queryAABB (b2QueryCallback *callback,
+                             const b2AABB &aabb) const {
+  if (!tiled()) return physics().QueryAABB(callback, aabb);
+
+  struct Real : public b2QueryCallback {
+    b2QueryCallback *callback;
+    bool more = true;
+
+    Real (b2QueryCallback *c) : callback(c) {}
+
+    bool ReportFixture(b2Fixture *f) override {
+      if (Critter::get(f->GetBody())->ghost)  return true;
+      return (more = callback->ReportFixture(f));
+    }
+  } real (callback);
+
+  for (const auto &t: _tiles) {
+    if (!real.more) break;
+    if (overlap(aabb, t->bounds, _ghostMargin))
+      t->world->QueryAABB(&real, aabb);
+  }
+}
+
 void Environment::step (void) {
 
   // Box2D parameters
@@ -553,29 +837,357 @@ void Environment::step (void) {
 
   fightDataLogger.str("");
 
+  // A null time step only updates existing contacts (see setKinematic)
+  const float timeStep = _kinematic ? 0.f : float(dt());
+
+  if (tiled()) {
+    auto t = _profiler.time(Profiler::GHOSTS);
+    syncGhosts();
+  }
+
 //  std::cerr << "\n\n## Before physics step\n";
-//  _physics.Dump();
-  _physics.Step(float(dt()), V_ITER, P_ITER);
+//  physics().Dump();
+  {
+    auto t = _profiler.time(Profiler::BOX2D);
+    if (!tiled())
+      physics().Step(timeStep, V_ITER, P_ITER);
+
+    else {
+      // Worlds are independent but for Box2D's global (statistics) counters
+      WorkerPool::instance().forEach(tiles(), [this, timeStep] (uint i) {
+        _tiles[i]->world->Step(timeStep, V_ITER, P_ITER);
+      });
+      replayContacts();
+    }
+  }
+  if (Profiler::enabled())  profilePhysics();
 //  std::cerr << "\n\n## After physics step\n";
-//  _physics.Dump();
+//  physics().Dump();
 //  std::cerr << "\n\n#####################\n";
 
   if (debugFighting && !_fightingEvents.empty())
     std::cerr << ">> Processing fight events\n";
 
-  DestroyedSplines destroyedSplines;
+  auto t = _profiler.time(Profiler::FIGHTS);
   for (const auto &f: _fightingEvents)
-    processFight(f.first.first, f.first.second, f.second, destroyedSplines);
-  for (const auto &p: destroyedSplines)
+    processFight(f.first.first, f.first.second, f.second, _destroyedSplines);
+  if (!_destroyedSplines.empty()) structuralChange();
+  for (const auto &p: _destroyedSplines)
     p.first->destroySpline(p.second);
+  _destroyedSplines.clear();
+
+  if (!tiled())
+    for (Critter *c: _edgeCritters) maybeTeleport(c);
+  else
+    migrateCritters();
+}
+
+void Environment::replayContacts (void) {
+  // Beginnings and ends first, so that a contact seen from two tiles (a real
+  // body and a ghost on both sides) is known to both critters when solved
+  for (const auto &t: _tiles)
+    for (const ContactEvent &e: t->events)
+      if (e.type == ContactEvent::BEGIN)      _cmonitor->begin(e.fA, e.fB);
+      else if (e.type == ContactEvent::END)   _cmonitor->end(e.fA, e.fB);
+
+  for (const auto &t: _tiles)
+    for (const ContactEvent &e: t->events)
+      if (e.type == ContactEvent::PRE_SOLVE)
+        _cmonitor->preSolve(e.fA, e.fB, e.v);
+
+  for (const auto &t: _tiles) {
+    for (const ContactEvent &e: t->events)
+      if (e.type == ContactEvent::POST_SOLVE)
+        _cmonitor->postSolve(e.fA, e.fB, e.impulse, e.v);
+    t->events.clear();
+  }
+}
+
+void Environment::syncGhosts (void) {
+  const auto aabb = [] (const b2Body *b) {
+    b2AABB box;
+    box.lowerBound = box.upperBound = b->GetPosition();
+    for (const b2Fixture *f = b->GetFixtureList(); f; f = f->GetNext())
+      for (int i=0; i<f->GetProxyCount(); i++)  box.Combine(f->GetAABB(i));
+    return box;
+  };
+  const auto real = [] (const PhysicsTile &t, const b2Body *b) {
+    return b != t.edges && !Critter::get(b)->ghost && b->GetFixtureList();
+  };
+
+  // Reach of the fixtures from their owner's position (a critter's main body
+  // for its arms): any contact of a tile's real body is with a body reaching
+  // within that distance of the tile
+  _ghostMargin = 0;
+  for (const auto &t: _tiles) {
+    for (const b2Body *b = t->world->GetBodyList(); b; b = b->GetNext()) {
+      if (!real(*t, b)) continue;
+      const b2BodyUserData &d = *Critter::get(b);
+      const P2D o = (d.type == BodyType::CRITTER) ? d.ptr.critter->pos()
+                                                  : b->GetPosition();
+      const b2AABB box = aabb(b);
+      _ghostMargin = std::max({ _ghostMargin,
+                                o.x - box.lowerBound.x, o.y - box.lowerBound.y,
+                                box.upperBound.x - o.x, box.upperBound.y - o.y
+                              });
+    }
+  }
+  _ghostMargin += b2_aabbExtension; // Contacts are found on fattened AABBs
+
+  _ghostSync++;
+  for (uint i=0; i<tiles(); i++) {
+    PhysicsTile &t = *_tiles[i];
+    for (b2Body *b = t.world->GetBodyList(); b; b = b->GetNext()) {
+      if (!real(t, b)) continue;
+      const b2BodyUserData &d = *Critter::get(b);
+      const b2AABB box = aabb(b);
+
+      for (uint j=0; j<tiles(); j++) {
+        PhysicsTile &other = *_tiles[j];
+        if (i == j || !overlap(box, other.bounds, _ghostMargin)) continue;
+
+        Ghost &g = other.ghosts[b];
+        g.sync = _ghostSync;
+        const bool dynamic = (b->GetType() != b2_staticBody);
+
+        if (g.body && g.owner == &d && g.revision == d.revision) {
+          if (dynamic) {
+            if (g.body->GetPosition() != b->GetPosition()
+                || g.body->GetAngle() != b->GetAngle())
+              g.body->SetTransform(b->GetPosition(), b->GetAngle());
+            g.body->SetLinearVelocity(
+              b->GetLinearVelocityFromLocalPoint({0,0}));
+            g.body->SetAngularVelocity(b->GetAngularVelocity());
+          }
+          continue;
+        }
+
+        // New or outdated (its owner's fixtures changed)
+        structuralChange();
+        if (g.body) other.world->DestroyBody(g.body);
+
+        static_cast<b2BodyUserData&>(g) = d;
+        g.ghost = true;
+        g.original = b;
+        g.owner = &d;
+
+        b2BodyDef def;
+        def.type = dynamic ? b2_kinematicBody : b2_staticBody;
+        def.position = b->GetPosition();
+        def.angle = b->GetAngle();
+        if (dynamic) {
+          def.linearVelocity = b->GetLinearVelocityFromLocalPoint({0,0});
+          def.angularVelocity = b->GetAngularVelocity();
+        }
+        g.body = other.world->CreateBody(&def);
+
+        uint n = 0;
+        for (const b2Fixture *f = b->GetFixtureList(); f; f = f->GetNext()) n++;
+        g.fixtures.clear();
+        if (d.type == BodyType::CRITTER)  g.fixtures.reserve(n);
+
+        for (b2Fixture *f = b->GetFixtureList(); f; f = f->GetNext()) {
+          b2Fixture *f_ = Box2DUtils::clone(f, g.body);
+          if (d.type == BodyType::CRITTER) {
+            const Critter::FixtureData &fd = *Critter::get(f);
+            g.fixtures.emplace_back(*g.body, fd.type, fd.color,
+                                    fd.sindex, fd.sside, fd.aindex);
+            f_->SetUserData(&g.fixtures.back());
+          } else
+            f_->SetUserData(f->GetUserData());
+        }
+        g.body->SetUserData(static_cast<b2BodyUserData*>(&g));
+      }
+    }
+  }
+
+  // Sweep, in the (deterministic) order of the worlds' bodies
+  for (const auto &t: _tiles) {
+    for (b2Body *b = t->world->GetBodyList(), *next; b; b = next) {
+      next = b->GetNext();
+      b2BodyUserData *d = Critter::get(b);
+      if (!d->ghost || static_cast<Ghost*>(d)->sync == _ghostSync)  continue;
+      structuralChange();
+      const b2Body *original = static_cast<Ghost*>(d)->original;
+      t->world->DestroyBody(b);
+      t->ghosts.erase(original);
+    }
+  }
+}
+
+void Environment::dropGhosts (const b2Body *body) {
+  const b2BodyUserData *owner = Critter::get(body);
+  for (const auto &t: _tiles) {
+    for (b2Body *b = t->world->GetBodyList(), *next; b; b = next) {
+      next = b->GetNext();
+      b2BodyUserData *d = Critter::get(b);
+      if (!d->ghost || static_cast<Ghost*>(d)->owner != owner)  continue;
+      structuralChange();
+      const b2Body *original = static_cast<Ghost*>(d)->original;
+      t->world->DestroyBody(b);
+      t->ghosts.erase(original);
+    }
+  }
+}
+
+P2D Environment::wrapped (const P2D &p) const {
+  P2D p_ = p;
+  if (p_.x < -xextent())      p_.x += width();
+  else if (p_.x > xextent())  p_.x -= width();
+
+  if (p_.y < -yextent())      p_.y += height();
+  else if (p_.y > yextent())  p_.y -= height();
+  return p_;
+}
+
+void Environment::migrateCritters (void) {
+  _migrations.clear();
+
+  // Through the torus edges (with their arms, unlike in a single world)
+  for (Critter *c: _edgeCritters) {
+    const P2D p0 = c->pos(), p1 = wrapped(p0);
+    if (p0 != p1) _migrations.push_back({c, p1 - p0});
+  }
+
+  // Into the neighbouring tile
+  for (uint i=0; i<tiles(); i++) {
+    const b2World &w = *_tiles[i]->world;
+    for (const b2Body *b = w.GetBodyList(); b; b = b->GetNext()) {
+      const b2BodyUserData &d = *Critter::get(b);
+      if (d.type != BodyType::CRITTER || d.ghost) continue;
+      Critter *c = d.ptr.critter;
+      if (&c->body() != b || wrapped(c->pos()) != c->pos())  continue;
+      if (tileAt(c->pos()) != i)  _migrations.push_back({c, {0,0}});
+    }
+  }
+
+  // _edgeCritters is ordered by address
+  std::sort(_migrations.begin(), _migrations.end(),
+            [] (const Migration &lhs, const Migration &rhs) {
+    return lhs.critter->id() < rhs.critter->id();
+  });
+
+  for (const Migration &m: _migrations) {
+    structuralChange();
+    dropGhosts(&m.critter->body());
+    m.critter->migrate(physicsAt(m.critter->pos() + m.offset), m.offset);
+  }
+}
+
+b2Profile Environment::physicsProfile (void) const {
+  b2Profile p {};
+  for (const auto &t: _tiles) {
+    const b2Profile &p_ = t->world->GetProfile();
+    p.step += p_.step;
+    p.collide += p_.collide;
+    p.solve += p_.solve;
+    p.solveInit += p_.solveInit;
+    p.solveVelocity += p_.solveVelocity;
+    p.solvePosition += p_.solvePosition;
+    p.broadphase += p_.broadphase;
+    p.solveTOI += p_.solveTOI;
+  }
+  return p;
+}
+
+Box2DUtils::WorldStats Environment::worldStats (bool islands) {
+  Box2DUtils::WorldStats s {};
+  for (const auto &t: _tiles) {
+    auto s_ = Box2DUtils::worldStats(*t->world, islands);
+    s.bodies += s_.bodies;
+    s.awake += s_.awake;
+    s.contacts += s_.contacts;
+    s.touching += s_.touching;
+    s.proxies += s_.proxies;
+    s.treeHeight = std::max(s.treeHeight, s_.treeHeight);
+    if (islands) {
+      s.islands += s_.islands;
+      s.largestIsland = std::max(s.largestIsland, s_.largestIsland);
+    }
+  }
+  return s;
+}
+
+void Environment::profilePhysics (void) {
+  using P = Profiler;
+  const b2Profile p = physicsProfile();
+  _profiler.recordMs(P::B2_COLLIDE, p.collide);
+  _profiler.recordMs(P::B2_SOLVE, p.solve);
+  _profiler.recordMs(P::B2_SOLVE_INIT, p.solveInit);
+  _profiler.recordMs(P::B2_SOLVE_VELOCITY, p.solveVelocity);
+  _profiler.recordMs(P::B2_SOLVE_POSITION, p.solvePosition);
+  _profiler.recordMs(P::B2_BROADPHASE, p.broadphase);
+  _profiler.recordMs(P::B2_SOLVE_TOI, p.solveTOI);
+
+  bool islands = (P::level() > 1);
+  auto s = worldStats(islands);
+  _profiler.sample(P::BODIES, s.bodies);
+  _profiler.sample(P::AWAKE_BODIES, s.awake);
+  _profiler.sample(P::CONTACTS, s.contacts);
+  _profiler.sample(P::TOUCHING_CONTACTS, s.touching);
+  _profiler.sample(P::PROXIES, s.proxies);
+  if (islands) {
+    _profiler.sample(P::ISLANDS, s.islands);
+    _profiler.sample(P::LARGEST_ISLAND, s.largestIsland);
+  }
+}
+
+/// Box2D (2.4.0) lazily fills its contact factories when creating the first
+/// contact: make sure it happens before worlds are stepped concurrently
+static void initializeContactFactories (void) {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    b2World world (b2Vec2{0,0});
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_dynamicBody;
+    b2CircleShape shape;
+    shape.m_radius = 1;
+    for (uint i=0; i<2; i++)
+      world.CreateBody(&bodyDef)->CreateFixture(&shape, 1);
+    world.Step(0, 1, 1);
+  });
+}
+
+void Environment::createWorld (void) {
+  const uint n = _tilesPerSide;
+  if (n > 1)  initializeContactFactories();
+  const float tw = float(width()) / n, th = float(height()) / n;
+  if (_tiles.empty())
+    for (uint i=0; i<n*n; i++)
+      _tiles.push_back(std::make_unique<PhysicsTile>());
+
+  for (uint i=0; i<n*n; i++) {
+    PhysicsTile &t = *_tiles[i];
+
+    // A brand new world (thus stepping exactly as in a new environment) but
+    // constructed in the previous one's storage. The object itself is large
+    // (mostly b2StackAllocator's buffer) while its internal pools are, anyway,
+    // released by its destructor
+    if (t.world) {
+      t.world->~b2World();
+      new (t.world.get()) b2World(b2Vec2{0,0});
+    } else
+      t.world = std::make_unique<b2World>(b2Vec2{0,0});
+
+    t.ghosts.clear();
+    t.events.clear();
+    if (n == 1)
+      t.world->SetContactListener(_cmonitor);
+    else {
+      if (!t.monitor) t.monitor = std::make_unique<TileMonitor>(*_cmonitor, t);
+      t.world->SetContactListener(t.monitor.get());
+    }
+    t.world->SetContactFilter(_cfilter);
 
-  for (Critter *c: _edgeCritters) maybeTeleport(c);
+    t.bounds.lowerBound.Set(-xextent() + (i % n) * tw,
+                            -yextent() + (i / n) * th);
+    t.bounds.upperBound = t.bounds.lowerBound + P2D(tw, th);
 
-//  std::cerr << "Physical step took " << _physics.GetProfile().step
-//            << " ms" << std::endl;
+    createEdges(t);
+  }
 }
 
-void Environment::createEdges(void) {
+void Environment::createEdges(PhysicsTile &t) {
   static constexpr float W = 10, W2 = 2*W;
   real HW = xextent(), HH = yextent();
 
@@ -583,7 +1195,7 @@ void Environment::createEdges(void) {
   edgesBodyDef.type = b2_staticBody;
   edgesBodyDef.position.Set(0, 0);
 
-  _edges = _physics.CreateBody(&edgesBodyDef);
+  b2Body *edges = t.edges = t.world->CreateBody(&edgesBodyDef);
 
   if (!boxEdges) { // Linear edges
     P2D edgesVertices [4] {
@@ -598,7 +1210,7 @@ void Environment::createEdges(void) {
     edgesFixture.density = 0;
     edgesFixture.isSensor = isTaurus();
 
-    _edges->CreateFixture(&edgesFixture);
+    edges->CreateFixture(&edgesFixture);
 
   } else {  // Box edges
     b2PolygonShape boxes [4];
@@ -615,13 +1227,13 @@ void Environment::createEdges(void) {
       edgeDef.filter.categoryBits = uint16(CollisionFlag::OBSTACLE_FLAG);
       edgeDef.filter.maskBits = uint16(CollisionFlag::OBSTACLE_MASK);
 
-      _edges->CreateFixture(&edgeDef);
+      edges->CreateFixture(&edgeDef);
     }
   }
 
   _edgesUserData.type = isTaurus() ? BodyType::WARP_ZONE : BodyType::OBSTACLE;
   _edgesUserData.ptr.obstacle = nullptr;
-  _edges->SetUserData(&_edgesUserData);
+  edges->SetUserData(&_edgesUserData);
 }
 
 auto densityCollisionFactor (float d) {
@@ -656,8 +1268,13 @@ void Environment::processFight(Critter *cA, Critter *cB, const FightingData &d,
         );
   };
 
-  const CritterData &dA = _critterData.at(cA),
-                    &dB = _critterData.at(cB);
+  // Both touch (in their own tile, if tiled)
+  static const CritterData none {};
+  const auto data = [this] (Critter *c) -> const CritterData& {
+    auto it = _critterData.find(c);
+    return (it != _critterData.end()) ? it->second : none;
+  };
+  const CritterData &dA = data(cA), &dB = data(cB);
 
   bool ignoreA = dA.totalImpulsions < CMI,
        ignoreB = dB.totalImpulsions < CMI;
@@ -753,16 +1370,10 @@ void Environment::processFight(Critter *cA, Critter *cB, const FightingData &d,
 void Environment::maybeTeleport(Critter *c) {
   b2Body &b = c->body();
   auto a = b.GetAngle();
-  P2D p0 = b.GetPosition(), p1 = p0;
+  P2D p0 = b.GetPosition(), p1 = wrapped(p0);
 
 //  std::cerr << CID(c, "Critter ") << " touching edges at " << p0 << std::endl;
 
-  if (p1.x < -xextent())      p1.x += width();
-  else if (p1.x > xextent())  p1.x -= width();
-
-  if (p1.y < -yextent())      p1.y += height();
-  else if (p1.y > yextent())  p1.y -= height();
-
   if (p0 != p1) b.SetTransform(p1, a);
 
 //  if (p0 != p1)
@@ -814,6 +1425,7 @@ Environment *Environment::clone(const Environment &e) {
   assert(this_e->_edgeCritters.empty());
 
   this_e->_energyReserve = e._energyReserve;
+  this_e->_kinematic = e._kinematic;
 
   this_e->_dice = e._dice;
 
@@ -828,13 +1440,16 @@ void assertEqual (const Environment &lhs, const Environment &rhs,
   ASRT(_genome);
 //  ASRT(_physics);
 //  ASRT(_cmonitor);
-  ASRT(_edges);
+  ASRT(_tiles.size());
+  for (uint i=0; i<lhs._tiles.size(); i++)
+    assertEqual(lhs._tiles[i]->edges, rhs._tiles[i]->edges, deepcopy);
   ASRT(_edgesUserData);
 //  ASRT(_feedingEvents);
 //  ASRT(_fightingEvents);
 //  ASRT(_matingEvents);
 //  ASRT(_edgeCritters);
   ASRT(_energyReserve);
+  ASRT(_kinematic);
   ASRT(_dice);
 #undef ASRT
 }
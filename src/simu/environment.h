@@ -5,6 +5,10 @@
 
 #include "../genotype/environment.h"
 #include "config.h"
+#include "box2dutils.h"
+#include "profiler.h"
+#include "pool.h"
+#include "plantfield.h"
 
 namespace simu {
 
@@ -12,8 +16,10 @@ struct Foodlet;
 struct Critter;
 
 struct CollisionMonitor;
+struct PhysicsTile;
+struct Kernels;
 
-class Obstacle {
+class Obstacle : public Pooled<Obstacle> {
   b2Body &_body;
   Color _color;
   b2BodyUserData _userData;
@@ -23,10 +29,14 @@ public:
 
   const auto& color (void) const { return _color; }
   b2Body& body (void) { return _body; }
+
+  int arena (void) const { return _userData.arena; }
+  void setArena (int a) { _userData.arena = a; }
 };
 
 class Environment {
   friend CollisionMonitor;
+  friend Kernels; // Micro-benchmarks (tools/microbench.cpp)
 public:
   using Genome = genotype::Environment;
 
@@ -39,13 +49,13 @@ public:
       return lhs.foodlet < rhs.foodlet;
     }
   };
-  using FeedingEvents = std::set<FeedingEvent>;
+  using FeedingEvents = PooledSet<FeedingEvent>;
 
   struct CritterData {
     uint collisions = 0;
     float totalImpulsions = 0;
   };
-  using CritterDataMap = std::map<Critter*, CritterData>;
+  using CritterDataMap = PooledMap<Critter*, CritterData>;
 
   using FightingKey = std::pair<Critter*, Critter*>;
   struct FightingData {
@@ -55,16 +65,16 @@ public:
       float impulse = 0;
       struct { std::array<float,2> velocity = {{0}}; } A, B;
     };
-    std::map<std::pair<b2Fixture*,b2Fixture*>, FixturesData> fixtures;
+    PooledMap<std::pair<b2Fixture*,b2Fixture*>, FixturesData> fixtures;
   };
-  using FightingEvents = std::map<FightingKey, FightingData>;
+  using FightingEvents = PooledMap<FightingKey, FightingData>;
 
-  using HearingEvents = std::set<std::pair<Critter*,Critter*>>;
-  using MatingEvents = std::set<std::pair<Critter*,Critter*>>;
+  using HearingEvents = PooledSet<std::pair<Critter*,Critter*>>;
+  using MatingEvents = PooledSet<std::pair<Critter*,Critter*>>;
 
 //  using PendingDeletions = std::set<std::pair<Critter*, uint>>;
 
-  using EdgeCritters = std::set<Critter*>;
+  using EdgeCritters = PooledSet<Critter*>;
 
   std::ostringstream fightDataLogger;
 
@@ -73,12 +83,29 @@ public:
 private:
   Genome _genome;
 
-  b2World _physics;
+  /// Physics worlds, one per tile of the arena (a single one unless
+  /// config::Simulation::physicsTiles > 1), each reconstructed (in place) for
+  /// every run (see reset)
+  std::vector<std::unique_ptr<PhysicsTile>> _tiles;
+  uint _tilesPerSide;
   CollisionMonitor *_cmonitor;
+  b2ContactFilter *_cfilter;
 
-  b2Body *_edges;
+  /// Shared by every tile's edges
   b2BodyUserData _edgesUserData;
 
+  /// Farthest reach of a fixture from its owner's position, over all real
+  /// bodies (see syncGhosts)
+  float _ghostMargin;
+  uint _ghostSync;
+
+  /// Critters changing tile at the end of the step (scratch)
+  struct Migration {
+    Critter *critter;
+    P2D offset;
+  };
+  std::vector<Migration> _migrations;
+
   CritterDataMap _critterData;
 
   FeedingEvents _feedingEvents;
@@ -89,17 +116,30 @@ private:
 
   EdgeCritters _edgeCritters;
 
+  /// Plants, when kept out of the physics (see PlantField::enabled)
+  PlantField _plants;
+
   decimal _energyReserve;
 
+  /// Whether the physics solve is skipped (see setKinematic)
+  bool _kinematic;
+
+  /// Number of bodies/fixtures created or destroyed so far (see
+  /// Simulation::step for the allocation checks)
+  uint _structuralChanges;
+
   rng::FastDice _dice;
 
+  Profiler _profiler;
+
   // Destroyed splines that must be deleted after the physical step
   using DestroyedSpline = std::pair<Critter*,uint>;
   struct ID_CMP {
     bool operator() (const DestroyedSpline &lhs,
                      const DestroyedSpline &rhs) const;
   };
-  using DestroyedSplines = std::set<DestroyedSpline, ID_CMP>;
+  using DestroyedSplines = PooledSet<DestroyedSpline, ID_CMP>;
+  DestroyedSplines _destroyedSplines;
 
 public:
   Environment(const Genome &g);
@@ -107,6 +147,14 @@ public:
 
   void init (decimal energy, uint rngSeed);
 
+  /// Prepares for a new run with a fresh physics world (a recycled one would
+  /// keep its broadphase proxies ids and tree history and thus diverge from a
+  /// new environment) but recycled events tables. Only the world's storage is
+  /// reused, not its allocators' blocks: see the mk-fights-* workloads of
+  /// splinoids-bench for what this pooling saves. All critters, foodlets and
+  /// obstacles must already have been destroyed
+  void reset (const Genome &g);
+
   const auto& genotype (void) const {
     return _genome;
   }
@@ -131,16 +179,53 @@ public:
     return _genome.taurus;
   }
 
-  const auto& physics (void) const {
-    return _physics;
+  /// The first tile's world (the only one unless tiled)
+  const b2World& physics (void) const;
+  b2World& physics (void);
+
+  /// Number of physics worlds the arena is split into
+  uint tiles (void) const {
+    return _tiles.size();
   }
 
-  auto& physics (void) {
-    return _physics;
+  bool tiled (void) const {
+    return tiles() > 1;
+  }
+
+  const b2World& physics (uint tile) const;
+  b2World& physics (uint tile);
+
+  /// Tile holding the (real) bodies positioned at p
+  uint tileAt (const P2D &p) const;
+
+  /// World in which to create a body positioned at p
+  b2World& physicsAt (const P2D &p) {
+    return physics(tileAt(p));
+  }
+
+  /// Ray cast / AABB query over every world, not reporting ghosts (copies of
+  /// bodies from neighbouring tiles). Callers only see real bodies, as with a
+  /// single world. Thread-safe (as Box2D's const queries)
+  void rayCast (b2RayCastCallback *callback,
+                const b2Vec2 &p1, const b2Vec2 &p2) const;
+  void queryAABB (b2QueryCallback *callback, const b2AABB &aabb) const;
+
+  /// Destroys the ghosts of b's owner (e.g. before its deletion)
+  void dropGhosts (const b2Body *b);
+
+  /// Box2D's breakdown of the last step, summed over tiles (thus CPU rather
+  /// than wall time when tiled)
+  b2Profile physicsProfile (void) const;
+  Box2DUtils::WorldStats worldStats (bool islands);
+
+  b2Body* edges (void);
+
+  const auto& plants (void) const {
+    return _plants;
   }
 
-  b2Body* edges (void) {
-    return _edges;
+  auto& plants (void) {
+    return _plants;
   }
 
   const auto& feedingEvents (void) const {
@@ -167,20 +252,66 @@ public:
     return _hearingEvents;
   }
 
+  /// Number of ongoing contacts involving c
+  uint contacts (const Critter *c) const {
+    auto it = _critterData.find(const_cast<Critter*>(c));
+    return it != _critterData.end() ? it->second.collisions : 0;
+  }
+
   void vision (const Critter *c) const;
 
+  /// Whether these bodies belong to the same arena (or either to all)
+  static bool sameArena (const b2Body *lhs, const b2Body *rhs);
+
   virtual void step (void);
 
+  /// In kinematic mode, bodies are only moved by whoever drives the scenario
+  /// (e.g. SetTransform in neural evaluations) and arms rigidly follow their
+  /// critter's body. Box2D (2.4.0) is stepped with a null time step, which
+  /// skips Solve and thus:
+  ///  - never fires PostSolve: no fight is ever detected
+  ///  - only looks for new contacts after fixtures are created (SetTransform
+  ///    does not schedule FindNewContacts). Existing contacts are updated and
+  ///    may end, but bodies moved into one another never start touching
+  ///    (touch, hearing, ...)
+  /// Only meant for scenarios that do not rely on the above. Opt-in (see
+  /// config::Simulation::kinematicEvaluations) and reverts to false on reset
+  void setKinematic (bool k) {
+    _kinematic = k;
+  }
+
+  bool kinematic (void) const {
+    return _kinematic;
+  }
+
   void modifyEnergyReserve (decimal e);
 
   decimal energy (void) const {
     return _energyReserve;
   }
 
+  /// Notifies of a body or fixture creation/destruction, which legitimately
+  /// allocates (physics, ann, ...)
+  void structuralChange (void) {
+    _structuralChanges++;
+  }
+
+  uint structuralChanges (void) const {
+    return _structuralChanges;
+  }
+
   auto& dice (void) {
     return _dice;
   }
 
+  auto& profiler (void) {
+    return _profiler;
+  }
+
+  const auto& profiler (void) const {
+    return _profiler;
+  }
+
   void mutateController (rng::AbstractDice &dice, float r);
 
   static decimal dt(void);
@@ -193,12 +324,33 @@ public:
   static void load (const nlohmann::json &j, std::unique_ptr<Environment> &e);
 
 private:
-  void createEdges (void);
+  /// Physics worlds (with their listener, filter and edges) for the current
+  /// genome
+  void createWorld (void);
+  void createEdges (PhysicsTile &t);
+
+  /// Replays the contacts recorded by the tiles' worlds, stepped concurrently
+  void replayContacts (void);
+
+  /// Mirrors every real body reaching into another tile with a ghost there.
+  /// Ghosts are kinematic (static for static bodies) and only take part in
+  /// the contacts of the tile's real bodies (see CollisionMonitor::owned)
+  void syncGhosts (void);
+
+  /// Moves critters into the tile matching their position (through the
+  /// torus edges, if any)
+  void migrateCritters (void);
+
+  /// Records Box2D's breakdown of the last step and world statistics
+  void profilePhysics (void);
 
   void processFight (Critter *cA, Critter *cB,
                      const FightingData &d,
                      DestroyedSplines &destroyedSplines);
   void maybeTeleport (Critter *c);
+
+  /// Position p after crossing the torus edges, if outside of the arena
+  P2D wrapped (const P2D &p) const;
 };
 
 } // end of namespace simu
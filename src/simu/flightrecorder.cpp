@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "flightrecorder.h"
+#include "critter.h"
+#include "environment.h"
+#include "allocations.h"
+
+namespace simu {
+
+static constexpr char MAGIC [4] = { 'S', 'P', 'F', 'R' };
+static constexpr uint32_t VERSION = 1;
+
+static uint capacityFromEnvironment (void) {
+  const char *v = std::getenv("SPLINOIDS_FLIGHT_RECORDER");
+  return v ? std::max(0, std::atoi(v)) : 128;
+}
+
+const uint FlightRecorder::_capacity = capacityFromEnvironment();
+
+FlightRecorder::FlightRecorder (void)
+  : _frames(_capacity), _next(0), _size(0) {}
+
+FlightRecorder::Frame& FlightRecorder::nextFrame (uint timestamp, uint n) {
+  Frame &f = _frames[_next];
+  _next = (_next + 1) % _capacity;
+  if (_size < _capacity)  _size++;
+
+  f.timestamp = timestamp;
+  f.states.clear();
+  if (f.states.capacity() < n) {
+    Allocations::Scope::poolGrowth();
+    f.states.reserve(n);
+  }
+  return f;
+}
+
+FlightRecorder::State FlightRecorder::state (const Critter *c,
+                                             const Environment &e) {
+  const b2Body &b = c->body();
+  const b2Vec2 &p = b.GetPosition(), &v = c->linearVelocity();
+  State s;
+  s.id = uint32_t(c->id());
+  s.x = p.x;
+  s.y = p.y;
+  s.a = b.GetAngle();
+  s.vx = v.x;
+  s.vy = v.y;
+  s.va = c->angularVelocity();
+  s.motors[0] = c->motorOutput(Motor::LEFT);
+  s.motors[1] = c->motorOutput(Motor::RIGHT);
+  s.health = c->bodyHealth();
+  s.healthness = c->healthness();
+  s.contacts = e.contacts(c);
+  return s;
+}
+
+template <typename T>
+static void write (std::ofstream &ofs, const T &v) {
+  ofs.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+static void read (std::ifstream &ifs, T &v) {
+  ifs.read(reinterpret_cast<char*>(&v), sizeof(T));
+}
+
+std::string FlightRecorder::dump (const std::string &path,
+                                  const std::string &reason) const {
+  std::ofstream ofs (path, std::ios::out | std::ios::binary);
+  if (!ofs) {
+    std::cerr << "Unable to open '" << path << "' to dump the flight recorder"
+              << std::endl;
+    return "";
+  }
+
+  ofs.write(MAGIC, sizeof(MAGIC));
+  write(ofs, VERSION);
+  write(ofs, uint32_t(reason.size()));
+  ofs.write(reason.data(), reason.size());
+  write(ofs, uint32_t(_size));
+
+  for (uint i=0; i<_size; i++) {
+    const Frame &f = _frames[(_next + _capacity - _size + i) % _capacity];
+    write(ofs, f.timestamp);
+    write(ofs, uint32_t(f.states.size()));
+    ofs.write(reinterpret_cast<const char*>(f.states.data()),
+              f.states.size() * sizeof(State));
+  }
+
+  std::cerr << "Dumped the last " << _size << " steps to " << path << " ("
+            << reason << ")" << std::endl;
+  return path;
+}
+
+FlightRecorder::Recording FlightRecorder::load (const std::string &path) {
+  std::ifstream ifs (path, std::ios::in | std::ios::binary);
+  if (!ifs)
+    utils::Thrower("Unable to open '", path, "' for reading");
+
+  char magic [sizeof(MAGIC)];
+  ifs.read(magic, sizeof(magic));
+  uint32_t version = 0;
+  read(ifs, version);
+  if (!ifs || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+      || version != VERSION)
+    utils::Thrower("'", path, "' is not a (v", VERSION, ") flight recording");
+
+  Recording r;
+  uint32_t n;
+  read(ifs, n);
+  r.reason.resize(n);
+  ifs.read(r.reason.data(), n);
+
+  read(ifs, n);
+  r.frames.resize(n);
+  for (Frame &f: r.frames) {
+    read(ifs, f.timestamp);
+    read(ifs, n);
+    f.states.resize(n);
+    ifs.read(reinterpret_cast<char*>(f.states.data()), n * sizeof(State));
+  }
+
+  if (!ifs) utils::Thrower("Truncated flight recording '", path, "'");
+  return r;
+}
+
+} // end of namespace simu
@@ -0,0 +1,94 @@
+#ifndef SIMU_FLIGHTRECORDER_H
+#define SIMU_FLIGHTRECORDER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace simu {
+
+class Critter;
+class Environment;
+
+/// Ring buffer of the critters' dynamic state over the last few steps
+///
+/// Always on (unless SPLINOIDS_FLIGHT_RECORDER=0, otherwise the number of
+/// recorded steps, default 128). Nothing is written unless the simulation
+/// aborts or fails a budget assertion, in which case the buffer is dumped to
+/// a binary file that the (mkombat) visualizer can replay (--replay).
+///
+/// Frames are reused so that, once every slot has seen the largest
+/// population, recording does not allocate.
+class FlightRecorder {
+public:
+  /// Compact state of a single critter (written as is)
+  struct State {
+    uint32_t id;
+    float x, y, a;      ///< Body transform
+    float vx, vy, va;   ///< Linear and angular velocities
+    float motors[2];    ///< Left and right motor outputs
+    float health;       ///< Body health
+    float healthness;   ///< Overall health ratio (body and splines)
+    uint32_t contacts;  ///< Number of ongoing contacts
+  };
+  static_assert(sizeof(State) == 12 * 4, "Unexpected padding in State");
+
+  struct Frame {
+    uint32_t timestamp;
+    std::vector<State> states;
+  };
+
+  struct Recording {
+    std::string reason;
+    std::vector<Frame> frames;  ///< Chronological
+  };
+
+  FlightRecorder (void);
+
+  /// Number of recorded steps (0 if disabled)
+  static uint capacity (void) {
+    return _capacity;
+  }
+
+  template <typename CONTAINER>
+  void record (uint timestamp, const CONTAINER &critters,
+               const Environment &e) {
+    if (_capacity == 0) return;
+    Frame &f = nextFrame(timestamp, critters.size());
+    for (const Critter *c: critters)  f.states.push_back(state(c, e));
+  }
+
+  bool empty (void) const {
+    return _size == 0;
+  }
+
+  void clear (void) {
+    _size = 0;
+  }
+
+  /// Writes the buffered frames (oldest first) and returns the path used.
+  /// Never throws: failure to dump is reported on std::cerr
+  std::string dump (const std::string &path, const std::string &reason) const;
+
+  static Recording load (const std::string &path);
+
+  friend void swap (FlightRecorder &lhs, FlightRecorder &rhs) {
+    using std::swap;
+    swap(lhs._frames, rhs._frames);
+    swap(lhs._next, rhs._next);
+    swap(lhs._size, rhs._size);
+  }
+
+private:
+  static const uint _capacity;
+
+  std::vector<Frame> _frames;
+  uint _next, _size;
+
+  Frame& nextFrame (uint timestamp, uint n);
+  static State state (const Critter *c, const Environment &e);
+};
+
+} // end of namespace simu
+
+#endif // SIMU_FLIGHTRECORDER_H
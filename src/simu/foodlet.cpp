@@ -35,7 +35,8 @@ Foodlet::Foodlet(BodyType type, uint id, b2Body *body, float r, decimal e)
     fd.filter.maskBits = uint16(CollisionFlag::CORPSE_MASK);
   }
 
-  _body.CreateFixture(&fd);
+  // Plants in a PlantField are not seen by Box2D
+  if (!isPlant() || !PlantField::enabled())  _body.CreateFixture(&fd);
 
   _body.SetUserData(&_userData);
 
@@ -95,9 +96,10 @@ Foodlet* Foodlet::clone (const Foodlet *f, b2Body *b) {
   COPY(_userData);
 #undef COPY
 
-  b2Fixture *fxt = f->_body.GetFixtureList();
-  b2Fixture *this_fxt = Box2DUtils::clone(fxt, b);
-  this_fxt->SetUserData(&this_f->_color);
+  if (const b2Fixture *fxt = f->_body.GetFixtureList()) {
+    b2Fixture *this_fxt = Box2DUtils::clone(fxt, b);
+    this_fxt->SetUserData(&this_f->_color);
+  }
 
   this_f->_userData.ptr.foodlet = this_f;
   this_f->_body.SetUserData(&this_f->_userData);
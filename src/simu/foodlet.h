@@ -2,13 +2,14 @@
 #define SIMU_FOODLET_H
 
 #include "config.h"
+#include "pool.h"
 #include "box2d/b2_body.h"
 
 namespace simu {
 
 struct Environment;
 
-class Foodlet {
+class Foodlet : public Pooled<Foodlet> {
   uint _id;
   b2Body &_body;
   float _radius;
@@ -56,6 +57,14 @@ public:
     return _radius;
   }
 
+  int arena (void) const {
+    return _userData.arena;
+  }
+
+  void setArena (int a) {
+    _userData.arena = a;
+  }
+
   static decimal maxStorage(BodyType type, float radius);
 
   decimal energy (void) const {
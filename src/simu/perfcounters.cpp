@@ -0,0 +1,99 @@
+#include <iostream>
+#include <memory>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "perfcounters.h"
+
+namespace simu {
+
+static constexpr int debugPerfCounters = 0;
+
+const std::array<const char*, PerfCounters::EVENTS> PerfCounters::names {
+  "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+#ifdef __linux__
+
+static int openEvent (uint64_t config, int group) {
+  perf_event_attr attr {};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = (group == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+PerfCounters::PerfCounters (void) : _leader(-1) {
+  static constexpr std::array<uint64_t, EVENTS> configs {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+  };
+
+  _opened.fill(false);
+  _fds.fill(-1);
+  for (uint i=0; i<EVENTS; i++) {
+    _fds[i] = openEvent(configs[i], _leader);
+    _opened[i] = (_fds[i] >= 0);
+    if (_opened[i] && _leader < 0) _leader = _fds[i];
+
+    if (debugPerfCounters)
+      std::cerr << "perf counter " << names[i] << ": "
+                << (_opened[i] ? "ok" : "unavailable") << "\n";
+  }
+
+  if (_leader >= 0) {
+    ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+PerfCounters::~PerfCounters (void) {
+  for (int fd: _fds) if (fd >= 0) close(fd);
+}
+
+bool PerfCounters::read (Values &v) const {
+  struct { uint64_t nr; uint64_t values [EVENTS]; } data;
+  if (::read(_leader, &data, sizeof(data)) < ssize_t(sizeof(uint64_t)))
+    return false;
+
+  // Group values are in opening order, i.e. without the missing events
+  uint j = 0;
+  for (uint i=0; i<EVENTS; i++)
+    v[i] = (_opened[i] && j < data.nr) ? data.values[j++] : 0;
+  return true;
+}
+
+PerfCounters* PerfCounters::forThisThread (void) {
+  thread_local std::unique_ptr<PerfCounters> counters (new PerfCounters);
+  return counters->_leader >= 0 ? counters.get() : nullptr;
+}
+
+#else
+
+PerfCounters::PerfCounters (void) : _leader(-1) {
+  _opened.fill(false);
+  _fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters (void) {}
+
+bool PerfCounters::read (Values &) const {
+  return false;
+}
+
+PerfCounters* PerfCounters::forThisThread (void) {
+  return nullptr;
+}
+
+#endif
+
+} // end of namespace simu
@@ -0,0 +1,45 @@
+#ifndef SIMU_PERFCOUNTERS_H
+#define SIMU_PERFCOUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+namespace simu {
+
+/// Hardware counters (through Linux's perf_event_open) of the calling thread
+///
+/// All events are opened as a single group so that they are scheduled (and
+/// read) together. Events the machine cannot provide (typical of containers
+/// and virtual machines) are silently left at zero; if none can be opened
+/// forThisThread() returns nullptr.
+class PerfCounters {
+public:
+  enum Event : uint8_t {
+    CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, EVENTS
+  };
+  static const std::array<const char*, EVENTS> names;
+
+  using Values = std::array<uint64_t, EVENTS>;
+
+  /// Counters of the calling thread, opened on first use
+  static PerfCounters* forThisThread (void);
+
+  /// Current (cumulative) values. False on failure
+  bool read (Values &v) const;
+
+  PerfCounters (const PerfCounters&) = delete;
+  PerfCounters& operator= (const PerfCounters&) = delete;
+
+  ~PerfCounters (void);
+
+private:
+  int _leader;
+  std::array<bool, EVENTS> _opened;
+  std::array<int, EVENTS> _fds;
+
+  PerfCounters (void);
+};
+
+} // end of namespace simu
+
+#endif // SIMU_PERFCOUNTERS_H
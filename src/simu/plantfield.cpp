@@ -0,0 +1,159 @@
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "plantfield.h"
+#include "foodlet.h"
+#include "environment.h"
+
+namespace simu {
+
+PlantField::PlantField (void)
+  : _x0(0), _y0(0), _cell(1), _cols(0), _rows(0), _contacts(0) {}
+
+bool PlantField::enabled (void) {
+  return config::Simulation::plantField();
+}
+
+void PlantField::reset (float width, float height) {
+  assert(_plants.empty());
+
+  // Plants then span at most 2x2 cells
+  _cell = std::max(1.f, 2 * config::Simulation::plantMaxRadius());
+  _x0 = -.5f * width;
+  _y0 = -.5f * height;
+  _cols = std::max(1, int(std::ceil(width / _cell)));
+  _rows = std::max(1, int(std::ceil(height / _cell)));
+  for (auto &c: _cells)  c.clear(); // Keeps the capacities for the next run
+  _cells.resize(_cols * _rows);
+  _contacts = 0;
+}
+
+int PlantField::col (float x) const {
+  return std::clamp(int(std::floor((x - _x0) / _cell)), 0, _cols-1);
+}
+
+int PlantField::row (float y) const {
+  return std::clamp(int(std::floor((y - _y0) / _cell)), 0, _rows-1);
+}
+
+PlantField::Range PlantField::range (float x0, float y0,
+                                     float x1, float y1) const {
+  return { col(x0), row(y0), col(x1), row(y1) };
+}
+
+void PlantField::insert (Foodlet *f) {
+  assert(f->isPlant());
+  uint k = _plants.size();
+  _x.push_back(f->x());
+  _y.push_back(f->y());
+  _r.push_back(f->radius());
+  _plants.push_back(f);
+
+  const Range q = range(_x[k] - _r[k], _y[k] - _r[k],
+                        _x[k] + _r[k], _y[k] + _r[k]);
+  for (int j=q.j0; j<=q.j1; j++)
+    for (int i=q.i0; i<=q.i1; i++)
+      cell(i, j).push_back(k);
+}
+
+void PlantField::remove (Foodlet *f) {
+  const auto rangeOf = [this] (uint k) {
+    return range(_x[k] - _r[k], _y[k] - _r[k], _x[k] + _r[k], _y[k] + _r[k]);
+  };
+  const auto reindex = [this] (const Range &q, uint from, uint to) {
+    for (int j=q.j0; j<=q.j1; j++) {
+      for (int i=q.i0; i<=q.i1; i++) {
+        auto &c = cell(i, j);
+        auto it = std::find(c.begin(), c.end(), from);
+        assert(it != c.end());
+        if (to != uint(-1)) *it = to;
+        else {
+          *it = c.back();
+          c.pop_back();
+        }
+      }
+    }
+  };
+
+  const auto &c = cell(col(f->x()), row(f->y()));
+  auto it = std::find_if(c.begin(), c.end(),
+                         [this, f] (uint k) { return _plants[k] == f; });
+  if (it == c.end())
+    utils::Thrower("Plant ", f->id(), " is not in the field");
+
+  uint k = *it, last = _plants.size() - 1;
+  reindex(rangeOf(k), k, -1);
+
+  // Move the last plant into the hole
+  if (k != last) {
+    reindex(rangeOf(last), last, k);
+    _x[k] = _x[last];
+    _y[k] = _y[last];
+    _r[k] = _r[last];
+    _plants[k] = _plants[last];
+  }
+  _x.pop_back();
+  _y.pop_back();
+  _r.pop_back();
+  _plants.pop_back();
+}
+
+PlantField::Hit PlantField::rayCast (const b2Vec2 &p1, const b2Vec2 &p2,
+                                     float maxFraction,
+                                     const b2Body *viewer) const {
+  Hit hit;
+  hit.fraction = maxFraction;
+  if (_plants.empty())  return hit;
+
+  const b2Vec2 d = p2 - p1;
+  const float dd = b2Dot(d, d);
+  if (dd <= 0)  return hit;
+
+  // Same convention as b2CircleShape::RayCast: no hit from the inside
+  const auto test = [&] (uint k) {
+    b2Vec2 m (p1.x - _x[k], p1.y - _y[k]);
+    float b = b2Dot(m, d), c = b2Dot(m, m) - _r[k] * _r[k];
+    float sigma = b * b - dd * c;
+    if (sigma < 0)  return;
+    float t = -(b + std::sqrt(sigma)) / dd;
+    if (0 <= t && t < hit.fraction
+        && Environment::sameArena(viewer, &_plants[k]->body())) {
+      hit.plant = _plants[k];
+      hit.fraction = t;
+    }
+  };
+
+  // Walk the cells crossed by the segment (Amanatides & Woo), in grid units
+  static constexpr float INF = std::numeric_limits<float>::infinity();
+  const float ax = (p1.x - _x0) / _cell, ay = (p1.y - _y0) / _cell,
+              dx = d.x / _cell, dy = d.y / _cell;
+  int i = std::floor(ax), j = std::floor(ay);
+  const int iE = std::floor(ax + dx), jE = std::floor(ay + dy);
+  const int si = dx > 0 ? 1 : -1, sj = dy > 0 ? 1 : -1;
+  const float tdx = dx != 0 ? 1 / std::fabs(dx) : INF,
+              tdy = dy != 0 ? 1 / std::fabs(dy) : INF;
+  float tx = dx > 0 ? (i + 1 - ax) * tdx : dx < 0 ? (ax - i) * tdx : INF,
+        ty = dy > 0 ? (j + 1 - ay) * tdy : dy < 0 ? (ay - j) * tdy : INF;
+
+  while (true) {
+    // Plants sticking out of the grid are registered in its border cells
+    for (uint k: cell(std::clamp(i, 0, _cols-1), std::clamp(j, 0, _rows-1)))
+      test(k);
+
+    float exit = std::min(tx, ty);
+    if (hit.fraction <= exit || exit > 1 || (i == iE && j == jE)) break;
+
+    if (tx < ty) {
+      i += si;
+      tx += tdx;
+    } else {
+      j += sj;
+      ty += tdy;
+    }
+  }
+
+  return hit;
+}
+
+} // end of namespace simu
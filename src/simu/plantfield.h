@@ -0,0 +1,112 @@
+#ifndef SIMU_PLANTFIELD_H
+#define SIMU_PLANTFIELD_H
+
+#include <algorithm>
+#include <vector>
+
+#include "box2d/b2_math.h"
+
+namespace simu {
+
+class Foodlet;
+
+/// Static spatial index of the plants, used instead of Box2D when
+/// config::Simulation::plantField is set
+///
+/// Plants then have no fixture: they are invisible to the broadphase and thus
+/// neither block critters nor generate contacts. Feeding is detected by
+/// overlap queries against the critters' bodies (see Simulation::step) and
+/// vision rays are cast against this field in addition to the physics world.
+///
+/// Plants never move: each is registered, once, in every cell its bounding box
+/// covers. Geometry is stored in flat arrays (struct of arrays) while the
+/// foodlets keep owning the (varying) energy and color.
+class PlantField {
+  float _x0, _y0;           ///< Lower-left corner of the grid
+  float _cell;              ///< Cells' side length
+  int _cols, _rows;
+
+  std::vector<float> _x, _y, _r;
+  std::vector<Foodlet*> _plants;
+  std::vector<std::vector<uint>> _cells;  ///< Indices into the above
+
+  /// Plants overlapping a critter's body (updated by the feeding pass)
+  uint _contacts;
+
+  struct Range { int i0, j0, i1, j1; };
+  Range range (float x0, float y0, float x1, float y1) const;
+
+  int col (float x) const;
+  int row (float y) const;
+
+  std::vector<uint>& cell (int i, int j) {
+    return _cells[j * _cols + i];
+  }
+
+  const std::vector<uint>& cell (int i, int j) const {
+    return _cells[j * _cols + i];
+  }
+
+public:
+  PlantField (void);
+
+  /// Whether plants are managed by this field (config::Simulation::plantField)
+  static bool enabled (void);
+
+  /// Covers a new world (which must hold no plant)
+  void reset (float width, float height);
+
+  void insert (Foodlet *f);
+  void remove (Foodlet *f);
+
+  uint size (void) const {
+    return _plants.size();
+  }
+
+  bool empty (void) const {
+    return _plants.empty();
+  }
+
+  /// Calls f(Foodlet*) once for every plant overlapping the disk (p,r)
+  template <typename F>
+  void overlaps (const b2Vec2 &p, float r, F &&f) const {
+    if (_plants.empty())  return;
+
+    const Range q = range(p.x - r, p.y - r, p.x + r, p.y + r);
+    for (int j=q.j0; j<=q.j1; j++) {
+      for (int i=q.i0; i<=q.i1; i++) {
+        for (uint k: cell(i, j)) {
+          // Only report plants from the first cell shared with the query
+          if (std::max(q.i0, col(_x[k] - _r[k])) != i
+              || std::max(q.j0, row(_y[k] - _r[k])) != j) continue;
+
+          float dx = _x[k] - p.x, dy = _y[k] - p.y, R = r + _r[k];
+          if (dx * dx + dy * dy < R * R)  f(_plants[k]);
+        }
+      }
+    }
+  }
+
+  struct Hit {
+    Foodlet *plant = nullptr;
+    float fraction = 1;
+  };
+
+  /// First plant hit by the segment p1 -> p2 before maxFraction (as in
+  /// b2World::RayCast). Plants in another arena than viewer are ignored.
+  /// Does not modify the field and can thus be called concurrently
+  Hit rayCast (const b2Vec2 &p1, const b2Vec2 &p2, float maxFraction,
+               const b2Body *viewer) const;
+
+  uint contacts (void) const {
+    return _contacts;
+  }
+
+  void setContacts (uint c) {
+    _contacts = c;
+  }
+};
+
+} // end of namespace simu
+
+#endif // SIMU_PLANTFIELD_H
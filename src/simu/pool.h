@@ -0,0 +1,141 @@
+#ifndef SIMU_POOL_H
+#define SIMU_POOL_H
+
+#include <cstddef>
+#include <map>
+#include <new>
+#include <set>
+
+#include "allocations.h"
+
+namespace simu {
+
+/// Recycles fixed-size blocks through a per-thread free list
+///
+/// Blocks are individually allocated (so that one freed by another thread,
+/// e.g. when a simulation changes hands, is still a valid block of that size)
+/// and only returned to the system when the thread exits. Memory usage is
+/// thus the high-water mark of the thread's live blocks.
+///
+/// Containers destroyed after the list (e.g. in other thread-local objects,
+/// such as pooled simulations) directly free their blocks.
+template <std::size_t SIZE>
+class FreeList {
+  struct Node { Node *next; };
+  static_assert(SIZE >= sizeof(Node), "Blocks too small for the free list");
+
+  Node *_head = nullptr;
+  bool _destroyed = false;
+
+  FreeList (void) = default;
+
+public:
+  ~FreeList (void) {
+    while (_head) {
+      Node *n = _head;
+      _head = n->next;
+      ::operator delete(n);
+    }
+    _destroyed = true;
+  }
+
+  static FreeList& local (void) {
+    static thread_local FreeList list;
+    return list;
+  }
+
+  void* get (void) {
+    if (_head) {
+      Node *n = _head;
+      _head = n->next;
+      return n;
+    }
+    Allocations::Scope::poolGrowth();
+    return ::operator new(SIZE);
+  }
+
+  void put (void *p) {
+    if (_destroyed) return ::operator delete(p);
+    Node *n = static_cast<Node*>(p);
+    n->next = _head;
+    _head = n;
+  }
+};
+
+/// Size of the blocks serving objects of the given size (so that they are
+/// suitably aligned and large enough to hold the free list's link)
+constexpr std::size_t poolBlockSize (std::size_t size) {
+  constexpr std::size_t A = alignof(std::max_align_t);
+  return ((size < sizeof(void*) ? sizeof(void*) : size) + A - 1) / A * A;
+}
+
+/// Stateless allocator for node-based containers (std::set, std::map, ...)
+/// serving single elements from a FreeList. Once a container's high-water mark
+/// is reached, inserting and erasing no longer touches the heap.
+template <typename T>
+struct PoolAllocator {
+  using value_type = T;
+
+  PoolAllocator (void) = default;
+
+  template <typename U>
+  PoolAllocator (const PoolAllocator<U>&) {}
+
+  T* allocate (std::size_t n) {
+    if (n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+    return static_cast<T*>(list().get());
+  }
+
+  void deallocate (T *p, std::size_t n) {
+    if (n != 1) ::operator delete(p);
+    else        list().put(p);
+  }
+
+  friend bool operator== (const PoolAllocator&, const PoolAllocator&) {
+    return true;
+  }
+
+  friend bool operator!= (const PoolAllocator&, const PoolAllocator&) {
+    return false;
+  }
+
+private:
+  static auto& list (void) {
+    return FreeList<poolBlockSize(sizeof(T))>::local();
+  }
+};
+
+/// Base class making (single-object) new/delete of T go through a FreeList.
+/// Derived classes of a different size use the global operators
+///
+/// Box2D's objects (bodies, fixtures, shapes, joints, contacts) are not
+/// concerned: they come from their world's b2BlockAllocator, whose free lists
+/// already recycle them for as long as the world lives, i.e. a whole run (a
+/// new world is only built when a simulation is reset)
+template <typename T>
+struct Pooled {
+  static void* operator new (std::size_t n) {
+    if (n != sizeof(T)) return ::operator new(n);
+    return list().get();
+  }
+
+  static void operator delete (void *p, std::size_t n) {
+    if (n != sizeof(T)) ::operator delete(p);
+    else                list().put(p);
+  }
+
+private:
+  static auto& list (void) {
+    return FreeList<poolBlockSize(sizeof(T))>::local();
+  }
+};
+
+template <typename T, typename CMP = std::less<T>>
+using PooledSet = std::set<T, CMP, PoolAllocator<T>>;
+
+template <typename K, typename V, typename CMP = std::less<K>>
+using PooledMap = std::map<K, V, CMP, PoolAllocator<std::pair<const K, V>>>;
+
+} // end of namespace simu
+
+#endif // SIMU_POOL_H
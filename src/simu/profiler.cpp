@@ -0,0 +1,277 @@
+#include <fstream>
+#include <mutex>
+
+#include "profiler.h"
+
+namespace simu {
+
+static constexpr int debugProfiler = 0;
+
+const std::array<const char*, Profiler::PHASES> Profiler::names {
+  "vision", "neural", "metabolism", "aging",
+  "critters",
+  "box2d", "fights", "feeding", "lod", "ghosts",
+  "b2_collide", "b2_solve", "b2_solve_init", "b2_solve_velocity",
+  "b2_solve_position", "b2_broadphase", "b2_solve_toi",
+  "audition", "reproduction", "corpses", "decomposition", "plants", "stats",
+  "step"
+};
+
+const std::array<const char*, Profiler::COUNTERS> Profiler::counterNames {
+  "bodies", "awake_bodies", "contacts", "touching_contacts", "proxies",
+  "islands", "largest_island"
+};
+
+namespace {
+
+/// Collects destroyed profilers and saves the total when the program exits
+struct Aggregate {
+  std::mutex mutex;
+  Profiler profiler;
+  bool flushed = false;
+
+  static Aggregate& instance (void) {
+    static Aggregate a;
+    return a;
+  }
+
+  void flush (void) {
+    std::lock_guard<std::mutex> lock (mutex);
+    if (flushed || !Profiler::enabled() || profiler.empty()) return;
+    flushed = true;
+
+    const char *v = std::getenv("SPLINOIDS_PROFILE_OUTPUT");
+    stdfs::path base = v ? v : "profile";
+    profiler.save(base);
+    std::cerr << "Step profile written to " << base << ".{csv,json}\n";
+  }
+
+  ~Aggregate (void) {
+    flush();
+  }
+};
+
+static int levelFromEnvironment (void) {
+  const char *v = std::getenv("SPLINOIDS_PROFILE");
+  // Created now to outlive (most) other static objects
+  Aggregate::instance();
+  return v ? std::atoi(v) : 0;
+}
+
+} // end of anonymous namespace
+
+int Profiler::_level = levelFromEnvironment();
+bool Profiler::_hardware = [] {
+  const char *v = std::getenv("SPLINOIDS_PROFILE_HW");
+  return v && std::atoi(v) > 0;
+}();
+
+// =============================================================================
+
+void Profiler::Histogram::add (ns d) {
+  uint i = (d > 0) ? 63 - __builtin_clzll(d) : 0;
+  counts[std::min(i, BUCKETS-1)]++;
+}
+
+Profiler::ns Profiler::Histogram::quantile (float q) const {
+  uint64_t total = 0;
+  for (uint64_t c: counts)  total += c;
+  if (total == 0) return 0;
+
+  uint64_t target = std::ceil(q * total), cumul = 0;
+  for (uint i=0; i<BUCKETS; i++) {
+    cumul += counts[i];
+    if (cumul >= target)  return ns(2) << i;
+  }
+  return ns(2) << (BUCKETS-1);
+}
+
+void Profiler::PhaseStats::merge (const PhaseStats &that) {
+  count += that.count;
+  total += that.total;
+  min = std::min(min, that.min);
+  max = std::max(max, that.max);
+  last = that.last;
+  for (uint i=0; i<Histogram::BUCKETS; i++)
+    histogram.counts[i] += that.histogram.counts[i];
+}
+
+Profiler::~Profiler (void) {
+  commit();
+}
+
+void Profiler::commit (void) {
+  if (!enabled() || empty())  return;
+
+  Aggregate &a = Aggregate::instance();
+  if (this == &a.profiler)  return;
+
+  {
+    std::lock_guard<std::mutex> lock (a.mutex);
+    a.profiler.merge(*this);
+  }
+  clear();
+}
+
+void Profiler::merge (const Profiler &that) {
+  for (uint i=0; i<PHASES; i++) _phases[i].merge(that._phases[i]);
+  for (uint i=0; i<COUNTERS; i++) _counters[i].merge(that._counters[i]);
+  for (uint i=0; i<PHASES; i++)
+    for (uint j=0; j<PerfCounters::EVENTS; j++)
+      _hw[i][j] += that._hw[i][j];
+  for (const auto &p: that._critters) {
+    CritterStats &s = _critters[p.first];
+    for (uint i=0; i<CRITTER_PHASES; i++) {
+      s.counts[i] += p.second.counts[i];
+      s.totals[i] += p.second.totals[i];
+    }
+  }
+}
+
+void Profiler::clear (void) {
+  _phases = {};
+  _counters = {};
+  _hw = {};
+  _critters.clear();
+}
+
+static nlohmann::json toJson (const Profiler::PhaseStats &s) {
+  nlohmann::json jh;
+  for (uint b=0; b<Profiler::Histogram::BUCKETS; b++)
+    if (s.histogram.counts[b] > 0)
+      jh[std::to_string(b)] = s.histogram.counts[b];
+
+  return {
+    { "count", s.count }, { "total", s.total }, { "mean", s.mean() },
+    { "min", s.min }, { "max", s.max }, { "log2histogram", jh }
+  };
+}
+
+bool Profiler::hasHardwareStats (void) const {
+  for (const HardwareStats &s: _hw)
+    for (uint64_t v: s)
+      if (v > 0)  return true;
+  return false;
+}
+
+Profiler::DerivedHardwareStats
+Profiler::derivedHardwareStats (const HardwareStats &s) {
+  using P = PerfCounters;
+  DerivedHardwareStats d;
+  double ki = s[P::INSTRUCTIONS] / 1000.;
+  d.ipc = s[P::CYCLES] > 0 ? double(s[P::INSTRUCTIONS]) / s[P::CYCLES] : 0;
+  d.cacheMPKI = ki > 0 ? s[P::CACHE_MISSES] / ki : 0;
+  d.branchMPKI = ki > 0 ? s[P::BRANCH_MISSES] / ki : 0;
+  return d;
+}
+
+nlohmann::json Profiler::toJson (void) const {
+  nlohmann::json j, &jp = j["phases"];
+  for (uint i=0; i<PHASES; i++)
+    if (_phases[i].count > 0)
+      jp[names[i]] = simu::toJson(_phases[i]);
+
+  for (uint i=0; i<COUNTERS; i++)
+    if (_counters[i].count > 0)
+      j["counters"][counterNames[i]] = simu::toJson(_counters[i]);
+
+  if (hasHardwareStats())
+    for (uint i=0; i<PHASES; i++) {
+      if (_phases[i].count == 0)  continue;
+      auto d = derivedHardwareStats(_hw[i]);
+      nlohmann::json &jh = jp[names[i]]["hardware"];
+      for (uint e=0; e<PerfCounters::EVENTS; e++)
+        jh[PerfCounters::names[e]] = _hw[i][e];
+      jh["ipc"] = d.ipc;
+      jh["cache_mpki"] = d.cacheMPKI;
+      jh["branch_mpki"] = d.branchMPKI;
+    }
+
+  if (!_critters.empty()) {
+    nlohmann::json &jc = j["critters"];
+    for (const auto &p: _critters) {
+      nlohmann::json jcp;
+      for (uint i=0; i<CRITTER_PHASES; i++)
+        jcp[names[i]] = { { "count", p.second.counts[i] },
+                          { "total", p.second.totals[i] } };
+      jc[std::to_string(p.first)] = jcp;
+    }
+  }
+
+  j["unit"] = "ns";
+  j["level"] = _level;
+  return j;
+}
+
+void Profiler::writeCSV (std::ostream &os) const {
+  const auto write = [&os] (const char *name, const PhaseStats &s) {
+    if (s.count == 0) return;
+    os << name << " " << s.count << " " << s.total << " " << s.mean()
+       << " " << s.min << " " << s.max << " " << s.histogram.quantile(.5)
+       << " " << s.histogram.quantile(.99) << "\n";
+  };
+
+  os << "Name Count Total Mean Min Max P50 P99\n";
+  for (uint i=0; i<PHASES; i++)   write(names[i], _phases[i]);
+  for (uint i=0; i<COUNTERS; i++) write(counterNames[i], _counters[i]);
+}
+
+void Profiler::writeCrittersCSV (std::ostream &os) const {
+  os << "Critter";
+  for (uint i=0; i<CRITTER_PHASES; i++) os << " " << names[i];
+  os << "\n";
+  for (const auto &p: _critters) {
+    os << p.first;
+    for (uint i=0; i<CRITTER_PHASES; i++)
+      os << " " << p.second.totals[i];
+    os << "\n";
+  }
+}
+
+void Profiler::writeHardwareCSV (std::ostream &os) const {
+  os << "Phase";
+  for (const char *n: PerfCounters::names)  os << " " << n;
+  os << " IPC CacheMPKI BranchMPKI\n";
+  for (uint i=0; i<PHASES; i++) {
+    if (_phases[i].count == 0)  continue;
+    auto d = derivedHardwareStats(_hw[i]);
+    os << names[i];
+    for (uint64_t v: _hw[i])  os << " " << v;
+    os << " " << d.ipc << " " << d.cacheMPKI << " " << d.branchMPKI << "\n";
+  }
+}
+
+void Profiler::save (const stdfs::path &base) const {
+  if (base.has_parent_path())
+    stdfs::create_directories(base.parent_path());
+
+  std::ofstream (base.string() + ".json") << toJson().dump(2);
+  std::ofstream csv (base.string() + ".csv");
+  writeCSV(csv);
+
+  if (!_critters.empty()) {
+    std::ofstream ccsv (base.string() + "_critters.csv");
+    writeCrittersCSV(ccsv);
+  }
+
+  if (hasHardwareStats()) {
+    std::ofstream hcsv (base.string() + "_hw.csv");
+    writeHardwareCSV(hcsv);
+  }
+
+  if (debugProfiler)
+    std::cerr << "Saved profile to " << base << "\n";
+}
+
+void Profiler::flush (void) {
+  Aggregate::instance().flush();
+}
+
+void Profiler::takeAggregate (Profiler &into) {
+  Aggregate &a = Aggregate::instance();
+  std::lock_guard<std::mutex> lock (a.mutex);
+  into.merge(a.profiler);
+  a.profiler.clear();
+}
+
+} // end of namespace simu
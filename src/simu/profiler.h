@@ -0,0 +1,278 @@
+#ifndef SIMU_PROFILER_H
+#define SIMU_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <map>
+
+#include "kgd/external/json.hpp"
+#include "kgd/utils/utils.h"
+
+#include "trace.h"
+#include "perfcounters.h"
+#include "pool.h"
+
+namespace simu {
+
+/// Nanosecond timers for the phases of a simulation step
+///
+/// Controlled at runtime through the SPLINOIDS_PROFILE environment variable
+/// (or setLevel()):
+///  - 0 (default): disabled. Timers cost a single, well-predicted, branch
+///  - 1: per-phase counts, totals, extrema and log2 histograms
+///  - 2: same plus per-critter breakdowns of the critter phases
+///
+/// With SPLINOIDS_PROFILE_HW=1, hardware counters (cycles, instructions,
+/// cache and branch misses) are also accumulated per phase, when the
+/// machine provides them (see PerfCounters). Reading them costs a system call
+/// per timer, which inflates the shortest phases' timings.
+///
+/// Independently, when tracing is enabled (see Trace), all but the
+/// per-critter phases are also recorded as timeline spans.
+///
+/// Each environment owns a profiler which is merged into a process-wide
+/// aggregate when destroyed. When enabled, that aggregate is written at exit
+/// to <base>.csv, <base>.json (and <base>_critters.csv for level 2) with base
+/// given by SPLINOIDS_PROFILE_OUTPUT (defaults to "profile").
+class Profiler {
+public:
+  enum Phase : uint8_t {
+    VISION, NEURAL, METABOLISM, AGING,  ///< Per-critter phases
+    CRITTERS,                           ///< All critters' steps
+    BOX2D, FIGHTS,                      ///< Environment phases
+    FEEDING,                            ///< Plants outside Box2D (PlantField)
+    LOD,                                ///< Dormant critters (lodCritters)
+    GHOSTS,                             ///< Tiles' ghosts (physicsTiles)
+
+    /// Box2D's own breakdown (b2Profile): BOX2D ~ COLLIDE + SOLVE + SOLVE_TOI
+    /// with SOLVE including the others (broadphase is the proxies update)
+    B2_COLLIDE, B2_SOLVE, B2_SOLVE_INIT, B2_SOLVE_VELOCITY, B2_SOLVE_POSITION,
+    B2_BROADPHASE, B2_SOLVE_TOI,
+
+    AUDITION, REPRODUCTION, CORPSES, DECOMPOSITION, PLANTS, STATS,
+    STEP,                               ///< Whole simulation step
+    PHASES
+  };
+  static constexpr uint CRITTER_PHASES = AGING+1;
+  static const std::array<const char*, PHASES> names;
+
+  /// Per-step values sampled alongside the timers (same statistics, no unit)
+  enum Counter : uint8_t {
+    BODIES, AWAKE_BODIES, CONTACTS, TOUCHING_CONTACTS, PROXIES,
+    ISLANDS, LARGEST_ISLAND,  ///< Level 2 only
+    COUNTERS
+  };
+  static const std::array<const char*, COUNTERS> counterNames;
+
+  using clock = std::chrono::steady_clock;
+  using ns = uint64_t;
+
+  /// Power-of-two buckets: bucket i holds durations in [2^i, 2^(i+1)[ ns
+  struct Histogram {
+    static constexpr uint BUCKETS = 40;
+    std::array<uint64_t, BUCKETS> counts {{0}};
+
+    void add (ns d);
+
+    /// Upper bound of the bucket containing the q-th quantile
+    ns quantile (float q) const;
+  };
+
+  struct PhaseStats {
+    uint64_t count = 0;
+    ns total = 0, min = std::numeric_limits<ns>::max(), max = 0, last = 0;
+    Histogram histogram;
+
+    void add (ns d) {
+      count++;
+      total += d;
+      min = std::min(min, d);
+      max = std::max(max, d);
+      last = d;
+      histogram.add(d);
+    }
+
+    void merge (const PhaseStats &that);
+
+    double mean (void) const {
+      return count > 0 ? double(total) / count : 0;
+    }
+  };
+
+  using HardwareStats = PerfCounters::Values;
+
+  struct CritterStats {
+    std::array<uint64_t, CRITTER_PHASES> counts {{0}};
+    std::array<ns, CRITTER_PHASES> totals {{0}};
+  };
+
+  /// Times its scope into the given phase (if profiling/tracing is enabled)
+  class Timer {
+    Profiler *_profiler;
+    Phase _phase;
+    bool _traced;
+    uint _critter;
+    clock::time_point _start;
+    PerfCounters *_counters;
+    PerfCounters::Values _hwStart;
+
+  public:
+    Timer (Profiler &p, Phase phase, uint critter)
+      : _profiler(enabled() ? &p : nullptr), _phase(phase),
+        _traced(Trace::enabled() && phase >= CRITTER_PHASES),
+        _critter(critter), _counters(nullptr) {
+      if (_profiler && _hardware) {
+        _counters = PerfCounters::forThisThread();
+        if (_counters && !_counters->read(_hwStart))  _counters = nullptr;
+      }
+      if (_profiler || _traced)  _start = clock::now();
+    }
+
+    Timer (const Timer&) = delete;
+    Timer& operator= (const Timer&) = delete;
+
+    ~Timer (void) {
+      if (!_profiler && !_traced) return;
+      auto end = clock::now();
+      if (_traced)  Trace::complete(names[_phase], "step", _start, end);
+      if (!_profiler) return;
+
+      PerfCounters::Values hwEnd;
+      if (_counters && _counters->read(hwEnd))
+        for (uint i=0; i<PerfCounters::EVENTS; i++)
+          _profiler->_hw[_phase][i] += hwEnd[i] - _hwStart[i];
+
+      ns d = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                end - _start).count();
+      if (_phase < CRITTER_PHASES)
+            _profiler->record(_critter, _phase, d);
+      else  _profiler->record(_phase, d);
+    }
+  };
+
+  Profiler (void) = default;
+  Profiler (const Profiler&) = delete;
+  Profiler& operator= (const Profiler&) = delete;
+
+  /// Merges into the process-wide aggregate
+  ~Profiler (void);
+
+  /// Merges into the process-wide aggregate and clears (for profilers that
+  /// outlive a run, e.g. in pooled simulations)
+  void commit (void);
+
+  static int level (void) {
+    return _level;
+  }
+
+  static bool enabled (void) {
+    return _level > 0;
+  }
+
+  static void setLevel (int l) {
+    _level = l;
+  }
+
+  static bool hardware (void) {
+    return _hardware;
+  }
+
+  static void setHardware (bool h) {
+    _hardware = h;
+  }
+
+  Timer time (Phase p) {
+    return Timer(*this, p, 0);
+  }
+
+  Timer time (Phase p, uint critter) {
+    return Timer(*this, p, critter);
+  }
+
+  void record (Phase p, ns d) {
+    _phases[p].add(d);
+  }
+
+  /// For externally timed phases (e.g. Box2D's profile)
+  void recordMs (Phase p, float ms) {
+    record(p, ns(ms * 1e6));
+  }
+
+  void sample (Counter c, uint64_t v) {
+    _counters[c].add(v);
+  }
+
+  void record (uint critter, Phase p, ns d) {
+    record(p, d);
+    if (_level > 1) {
+      CritterStats &s = _critters[critter];
+      s.counts[p]++;
+      s.totals[p] += d;
+    }
+  }
+
+  const PhaseStats& operator[] (Phase p) const {
+    return _phases[p];
+  }
+
+  const PhaseStats& operator[] (Counter c) const {
+    return _counters[c];
+  }
+
+  const HardwareStats& hardwareStats (Phase p) const {
+    return _hw[p];
+  }
+
+  /// Whether hardware counters were effectively collected
+  bool hasHardwareStats (void) const;
+
+  struct DerivedHardwareStats {
+    double ipc;         ///< Instructions per cycle
+    double cacheMPKI;   ///< Cache misses per thousand instructions
+    double branchMPKI;  ///< Branch misses per thousand instructions
+  };
+  static DerivedHardwareStats derivedHardwareStats (const HardwareStats &s);
+
+  /// Duration of the last occurrence of this phase, in milliseconds
+  float lastMs (Phase p) const {
+    return _phases[p].last * 1e-6;
+  }
+
+  const auto& critters (void) const {
+    return _critters;
+  }
+
+  bool empty (void) const {
+    return _phases[STEP].count == 0 && _phases[VISION].count == 0;
+  }
+
+  void merge (const Profiler &that);
+  void clear (void);
+
+  nlohmann::json toJson (void) const;
+  void writeCSV (std::ostream &os) const;
+  void writeCrittersCSV (std::ostream &os) const;
+  void writeHardwareCSV (std::ostream &os) const;
+
+  /// Writes base.csv, base.json and (if any) base_critters.csv, base_hw.csv
+  void save (const stdfs::path &base) const;
+
+  /// Writes the aggregate of all destroyed profilers (called at exit)
+  static void flush (void);
+
+  /// Moves the aggregate (so far) into the provided profiler
+  static void takeAggregate (Profiler &into);
+
+private:
+  static int _level;
+  static bool _hardware;
+
+  std::array<PhaseStats, PHASES> _phases;
+  std::array<PhaseStats, COUNTERS> _counters;
+  std::array<HardwareStats, PHASES> _hw {};
+  PooledMap<uint, CritterStats> _critters;
+};
+
+} // end of namespace simu
+
+#endif // SIMU_PROFILER_H
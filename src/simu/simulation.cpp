@@ -1,8 +1,14 @@
+#include <atomic>
+#include <optional>
+
+#include <unistd.h>
+
 #include "kgd/random/dice.hpp"
 
 #include "simulation.h"
 
 #include "box2dutils.h"
+#include "workerpool.h"
 
 namespace simu {
 using json = nlohmann::json;
@@ -14,6 +20,13 @@ static constexpr int debugFoodletManagement = 0;
 static constexpr int debugAudition = 0;
 static constexpr int debugReproduction = 0;
 
+/// Number of warm-up steps after which Simulation::step checks that it does
+/// not allocate (-1 if SPLINOIDS_CHECK_ALLOCATIONS is unset)
+static int checkAllocationsAfter (void) {
+  const char *v = std::getenv("SPLINOIDS_CHECK_ALLOCATIONS");
+  return v ? std::max(0, std::atoi(v)) : -1;
+}
+
 namespace statis_stats_details {
 
 using SConfig = config::Simulation;
@@ -100,7 +113,8 @@ void Simulation::printStaticStats (void) {
 
 Simulation::Simulation(void)
   : _environment(nullptr), _printedHeader(false), _workPath("."),
-    _timeMs(), _finished(false), _aborted(false) {}
+    _finished(false), _aborted(false), _newborns(false),
+    _checkAllocationsAfter(checkAllocationsAfter()) {}
 
 Simulation::~Simulation (void) {
   clear();
@@ -181,24 +195,75 @@ bool Simulation::setWorkPath (const stdfs::path &path, Overwrite o) {
   return true;
 }
 
-void Simulation::init(const Environment::Genome &egenome,
-                      std::vector<Critter::Genome> cgenomes,
-                      const InitData &data) {
+void Simulation::reset(const Environment::Genome &egenome,
+                       const InitData &data) {
+  clear();
 
   _finished = false;
   _aborted = false;
+  _flightRecorder.clear();
   _genData.min = 0;
   _genData.max = 0;
   _genData.goal = std::numeric_limits<decltype(_genData.goal)>::max();
   _time.set(0);
 
+  _gidManager = phylogeny::GIDManager();
+  _nextFoodletID = 0;
   _systemExpectedEnergy = data.ienergy;
+  _reproductions = ReproductionStats{};
+  _autopsies = Autopsies{};
+  _competitionStats = CompetitionStats{};
 
-  _environment = std::make_unique<Environment>(egenome);
+  if (_environment) _environment->reset(egenome);
+  else              _environment = std::make_unique<Environment>(egenome);
   _environment->init(data.ienergy, data.seed);
   if (config::Simulation::verbosity() >= 1)
     std::cout << "Using seed: " << data.seed << " -> "
               << _environment->dice().getSeed() << "\n";
+}
+
+void Simulation::recycle (void) {
+  clear();
+  _callbacks.clear();
+  _flightRecorder.clear();
+
+  _workPath = ".";
+  if (_statsLogger.is_open()) _statsLogger.close();
+  if (_competitionLogger.is_open()) _competitionLogger.close();
+  _printedHeader = false;
+
+  if (_environment) _environment->profiler().commit();
+}
+
+namespace {
+/// Idle simulations of the calling thread
+std::vector<std::unique_ptr<Simulation>>& pool (void) {
+  static thread_local std::vector<std::unique_ptr<Simulation>> p;
+  return p;
+}
+} // end of anonymous namespace
+
+Simulation::Lease::Lease (void) {
+  auto &p = pool();
+  if (p.empty())
+    _simulation = std::make_unique<Simulation>();
+  else {
+    _simulation = std::move(p.back());
+    p.pop_back();
+  }
+}
+
+Simulation::Lease::~Lease (void) {
+  if (!_simulation) return;
+  _simulation->recycle();
+  pool().push_back(std::move(_simulation));
+}
+
+void Simulation::init(const Environment::Genome &egenome,
+                      std::vector<Critter::Genome> cgenomes,
+                      const InitData &data) {
+
+  reset(egenome, data);
 
   if (cgenomes.size() > 0) {
     auto nextGID = cgenomes.front().id();
@@ -222,6 +287,23 @@ void Simulation::init(const Environment::Genome &egenome,
   const float CW = W * data.cRange, CH = H * data.cRange;
 
   _populations = cgenomes.size();
+
+  // Brains only depend on the (base) genome and the initial size: build one per
+  // population, concurrently if there are workers, and copy it into each
+  // member. The world-dependent part (bodies, dice, ids) stays serial below
+  std::vector<phenotype::ANN> brains (std::min(_populations, data.nCritters));
+  {
+    Trace::Span span ("brains", "simu", int64_t(brains.size()));
+    std::vector<std::future<void>> tasks;
+    for (uint i=0; i<brains.size(); i++)
+      tasks.push_back(WorkerPool::instance().submit(
+        [&g = cgenomes[i], &brain = brains[i], age = data.cAge] {
+          Critter::buildBrain(g, Critter::initialSize(g, age) * Critter::RADIUS,
+                              brain);
+      }));
+    for (auto &t: tasks)  t.get();
+  }
+
   auto &dice = _environment->dice();
   for (uint i=0; i<data.nCritters; i++) {
     uint bindex = i%_populations;
@@ -249,12 +331,11 @@ void Simulation::init(const Environment::Genome &egenome,
 //    if (i == 1) x = 47, y = 50-sqrt(2), a = M_PI/2;
 //    if (i == 2) x = 50-sqrt(2), y = 47, a = 0;
 
-    Critter *c = addCritter(cg, x, y, a, energyPerCritter, data.cAge);
+    Critter *c = addCritter(cg, x, y, a, energyPerCritter, data.cAge, false,
+                            &brains[bindex]);
     c->userIndex = bindex;
   }
 
-  _nextFoodletID = 0;
-
 //  addFoodlet(BodyType::PLANT,
 //             0, 0,
 //             1, 2); // Test
@@ -262,8 +343,6 @@ void Simulation::init(const Environment::Genome &egenome,
 
   if (config::Simulation::logStatsEvery() > 0)
     _statsLogger.open(config::Simulation::logFile());
-  _reproductions = ReproductionStats{};
-  _autopsies = Autopsies{};
 
 //  _ssga.init(_critters.size());
 
@@ -315,7 +394,7 @@ b2Body* Simulation::critterBody (float x, float y, float a) {
   bodyDef.angularDamping = .95;
   bodyDef.linearDamping = .9;
 
-  return physics().CreateBody(&bodyDef);
+  return _environment->physicsAt({x, y}).CreateBody(&bodyDef);
 }
 
 Critter* Simulation::addCritter (CGenome genome,
@@ -339,8 +418,9 @@ Critter* Simulation::addCritter (CGenome genome,
   if (overrideGID)
     genome.gdata.self.gid = _gidManager();
 
-  Critter *c = new Critter (genome, body, e_, age, brainTemplate);
+  Critter *c = new Critter (genome, body, e_, age, brainTemplate, _newborns);
   _critters.insert(c);
+  _environment->structuralChange();
 
   if (std::isinf(e)) e_ = c->energyEquivalent();
   _environment->modifyEnergyReserve(-e_);
@@ -384,6 +464,8 @@ void Simulation::delCritter (Critter *critter) {
   if (debugCritterManagement) critter->autopsy();
 //  if (_ssga.watching()) _ssga.registerDeath(critter);
   _critters.erase(critter);
+  _environment->structuralChange();
+  _environment->dropGhosts(&critter->body());
   delete critter;
 }
 
@@ -392,7 +474,7 @@ b2Body* Simulation::foodletBody(float x, float y) {
   bodyDef.type = b2_staticBody;
   bodyDef.position.Set(x, y);
 
-  return _environment->physics().CreateBody(&bodyDef);
+  return _environment->physicsAt({x, y}).CreateBody(&bodyDef);
 }
 
 Foodlet* Simulation::addFoodlet(BodyType t, float x, float y, float r,
@@ -409,6 +491,8 @@ Foodlet* Simulation::addFoodlet(BodyType t, float x, float y, float r,
     _environment->modifyEnergyReserve(-e);
 
   _foodlets.insert(f);
+  if (f->isPlant() && PlantField::enabled())  _environment->plants().insert(f);
+  _environment->structuralChange();
   return f;
 }
 
@@ -419,7 +503,11 @@ void Simulation::delFoodlet(Foodlet *foodlet) {
               << foodlet->body().GetPosition() << std::endl;
 
   _foodlets.erase(foodlet);
-  physics().DestroyBody(&foodlet->body());
+  if (foodlet->isPlant() && PlantField::enabled())
+    _environment->plants().remove(foodlet);
+  _environment->structuralChange();
+  _environment->dropGhosts(&foodlet->body());
+  foodlet->body().GetWorld()->DestroyBody(&foodlet->body());
   delete foodlet;
 }
 
@@ -428,7 +516,8 @@ Obstacle* Simulation::addObstacle(float x, float y, float w, float h, Color c) {
   bodyDef.type = b2_staticBody;
   bodyDef.position.Set(x+.5f*w, y+.5f*h);
 
-  b2Body *body = physics().CreateBody(&bodyDef);
+  b2Body *body =
+    _environment->physicsAt(bodyDef.position).CreateBody(&bodyDef);
 
   Obstacle *o = new Obstacle(body, w, h, c);
   _obstacles.insert(o);
@@ -438,7 +527,8 @@ Obstacle* Simulation::addObstacle(float x, float y, float w, float h, Color c) {
 
 void Simulation::delObstacle(Obstacle *o) {
   _obstacles.erase(o);
-  physics().DestroyBody(&o->body());
+  _environment->dropGhosts(&o->body());
+  o->body().GetWorld()->DestroyBody(&o->body());
   delete o;
 }
 
@@ -451,46 +541,88 @@ void Simulation::clear (void) {
 }
 
 void Simulation::step (void) {
-  auto stepStart = now(), start = stepStart;
+  Profiler &profiler = _environment->profiler();
+  auto stepTimer = profiler.time(Profiler::STEP);
 
   if (debugShowStepHeader)
     std::cerr << "\n## Simulation step " << _time.timestamp() << " ("
               << _time.pretty() << ") ##" << std::endl;
 
+  // Only counted when checking (tracing buffers events and is thus excluded)
+  std::optional<Allocations::Scope> allocations;
+  const uint changes = _environment->structuralChanges();
+  if (_checkAllocationsAfter >= 0 && !Trace::enabled()
+      && _time.timestamp() >= uint(_checkAllocationsAfter))
+    allocations.emplace();
+  bool loggedStats = false;
+  const bool wasAborted = _aborted;
+
   auto prevMinGen = _genData.min, prevMaxGen = _genData.max;
   _genData.min = std::numeric_limits<uint>::max();
   _genData.max = 0;
 
-  for (Critter *c: _critters) {
-    c->step(*_environment);
-
-    _genData.min = std::min(_genData.min, c->genotype().gdata.generation);
-    _genData.max = std::max(_genData.max, c->genotype().gdata.generation);
+  {
+    auto t = profiler.time(Profiler::CRITTERS);
+    if (config::Simulation::twoPhaseStep())
+      twoPhaseCrittersStep();
+    else
+      for (Critter *c: _critters) c->step(*_environment);
+
+    for (Critter *c: _critters) {
+      _genData.min = std::min(_genData.min, c->genotype().gdata.generation);
+      _genData.max = std::max(_genData.max, c->genotype().gdata.generation);
+    }
   }
   if (_critters.empty())  _genData.min = 0;
-  if (_timeMs.level > 1)  _timeMs.spln = durationFrom(start),  start = now();
 
   _environment->step();
+  if (config::Simulation::lodCritters() && !_environment->kinematic()) {
+    auto t = profiler.time(Profiler::LOD);
+    lodStep();
+  }
+  if (PlantField::enabled()) {
+    auto t = profiler.time(Profiler::FEEDING);
+    plantsFeeding();
+  }
   maybeCall<SimulationCallback>(POST_ENV_STEP);
 
-  if (_timeMs.level > 1)  _timeMs.env = durationFrom(start),  start = now();
-
-  audition();
-  reproduction();
-  produceCorpses();
-  decomposition();
-  if (_timeMs.level > 1)  _timeMs.decay = durationFrom(start),  start = now();
+  {
+    auto t = profiler.time(Profiler::AUDITION);
+    audition();
+  }
+  {
+    auto t = profiler.time(Profiler::REPRODUCTION);
+    reproduction();
+  }
+  {
+    auto t = profiler.time(Profiler::CORPSES);
+    produceCorpses();
+  }
+  {
+    auto t = profiler.time(Profiler::DECOMPOSITION);
+    decomposition();
+  }
 
-  if (_time.secondFraction() == 0)  plantRenewal();
-  if (_timeMs.level > 1)  _timeMs.regen = durationFrom(start),  start = now();
+  if (_time.secondFraction() == 0) {
+    auto t = profiler.time(Profiler::PLANTS);
+    plantRenewal();
+  }
 
   static const auto &lse = config::Simulation::logStatsEvery();
   if (_statsLogger && lse > 0 && (_time.timestamp() % lse) == 0) {
+    auto t = profiler.time(Profiler::STATS);
     logStats();
     _reproductions = ReproductionStats{};
     _autopsies = Autopsies{};
+    loggedStats = true;
   }
 
+  _flightRecorder.record(_time.timestamp(), _critters, *_environment);
+
+  if (allocations && !loggedStats
+      && changes == _environment->structuralChanges())
+    checkAllocations(allocations->stats());
+
   _time.next();
 
 #ifndef NDEBUG
@@ -503,14 +635,132 @@ void Simulation::step (void) {
 
   maybeCall<SimulationCallback>(POST_STEP);
 
-  if (_timeMs.level > 0)  _timeMs.step = durationFrom(stepStart);
-
   if (config::Simulation::verbosity() >= 1
       && (prevMinGen < _genData.min || prevMaxGen < _genData.max)) {
     std::cerr << "## Simulation step " << _time.pretty() << " gens: ["
               << _genData.min << "; " << _genData.max << "] at "
               << utils::CurrentTime{} << "\n";
   }
+
+  // Aborted by the scenario (e.g. on physics blow-up)
+  if (_aborted && !wasAborted)  dumpFlightRecorder("aborted");
+}
+
+void Simulation::twoPhaseCrittersStep (void) {
+  auto &critters = _scratch.critters;
+  critters.clear();
+  if (critters.capacity() < _critters.size()) {
+    Allocations::Scope::poolGrowth();
+    critters.reserve(_critters.size());
+  }
+
+  for (Critter *c: _critters) {
+    c->prepare(*_environment);
+    critters.push_back(c);
+  }
+
+  auto &durations = _scratch.durations;
+  if (durations.capacity() < critters.size()) {
+    Allocations::Scope::poolGrowth();
+    durations.reserve(critters.size());
+  }
+  durations.resize(critters.size());
+
+  // Critters only read the world (and write their own state): the result
+  // does not depend on the number of workers
+  const Environment &env = *_environment;
+  WorkerPool::instance().forEach(critters.size(),
+                                 [&critters, &durations, &env] (uint i) {
+    critters[i]->think(env, durations[i]);
+  });
+
+  // The profiler is not thread-safe: record the workers' timings afterwards
+  if (Profiler::enabled()) {
+    Profiler &p = _environment->profiler();
+    for (uint i=0; i<critters.size(); i++) {
+      const auto &d = durations[i];
+      if (d.vision == 0 && d.neural == 0) continue;
+      const uint cid = uint(critters[i]->id());
+      p.record(cid, Profiler::VISION, d.vision);
+      p.record(cid, Profiler::NEURAL, d.neural);
+    }
+  }
+
+  for (Critter *c: critters)  c->act(*_environment);
+}
+
+void Simulation::plantsFeeding (void) {
+  PlantField &plants = _environment->plants();
+  const float dt = Environment::dt();
+
+  // Same conditions as with Box2D contacts (see CollisionMonitor)
+  uint contacts = 0;
+  for (Critter *c: _critters) {
+    plants.overlaps(c->pos(), c->bodyRadius(), [&] (Foodlet *p) {
+      if (!Environment::sameArena(&c->body(), &p->body()))  return;
+      contacts++;
+      if (c->storableEnergy() > 0 && p->energy() > 0)  c->feed(p, dt);
+    });
+  }
+  plants.setContacts(contacts);
+}
+
+void Simulation::lodStep (void) {
+  auto &critters = _scratch.critters;
+  auto &isolated = _scratch.isolated;
+  critters.clear();
+  isolated.clear();
+  if (critters.capacity() < _critters.size()) {
+    Allocations::Scope::poolGrowth();
+    critters.reserve(_critters.size());
+  }
+  if (isolated.capacity() < _critters.size()) {
+    Allocations::Scope::poolGrowth();
+    isolated.reserve(_critters.size());
+  }
+
+  // Dormant critters advance on their own (unless Box2D woke them up, e.g.
+  // through a regenerated arm)
+  const float dt = Environment::dt();
+  for (Critter *c: _critters) {
+    if (c->dormant()) {
+      if (c->body().IsAwake())  c->wake();
+      else                      c->drift(dt);
+    }
+    critters.push_back(c);
+    isolated.push_back(false);
+  }
+
+  // Only queries the broadphase
+  const Environment &env = *_environment;
+  WorkerPool::instance().forEach(critters.size(),
+                                 [&critters, &isolated, &env] (uint i) {
+    isolated[i] = critters[i]->isolated(env);
+  });
+
+  for (uint i=0; i<critters.size(); i++) {
+    Critter *c = critters[i];
+    if (isolated[i] && !c->dormant())       c->sleep();
+    else if (!isolated[i] && c->dormant())  c->wake();
+  }
+}
+
+void Simulation::dumpFlightRecorder (const std::string &reason) const {
+  static std::atomic<uint> dumps = 0;
+  if (_flightRecorder.empty())  return;
+
+  std::ostringstream oss;
+  oss << "flight_" << getpid() << "_" << dumps++ << "_" << _time.pretty()
+      << ".rec";
+  _flightRecorder.dump(_workPath / oss.str(), reason);
+}
+
+void Simulation::checkAllocations (const Allocations::Stats &stats) const {
+  if (stats.allocs <= stats.pooled)  return;
+  utils::Thrower<std::logic_error>(
+    "Step ", _time.timestamp(), " (", _time.pretty(), ") performed ",
+    stats.allocs - stats.pooled, " unpooled allocation(s) (", stats.bytes,
+    " bytes) without structural changes");
 }
 
 void Simulation::atEnd (void) {
@@ -586,8 +836,10 @@ void Simulation::reproduction(void) {
       &CGenome::compatibility;
 
   auto &dice = this->dice();
-  auto matings = _environment->matingEvents();
-  for (auto p: matings) {
+  // Iterate over a (reused) copy of the events
+  const auto &events = _environment->matingEvents();
+  _scratch.matings.assign(events.begin(), events.end());
+  for (auto p: _scratch.matings) {
     Critter *f = p.first, *m = p.second;
     assert(f->hasSexualReproduction());
     assert(m->hasSexualReproduction());
@@ -659,7 +911,9 @@ Critter* Simulation::createChild(const Critter *parent, const CGenome &genome,
   utils::clip(-W, p.x, W);
   utils::clip(-H, p.y, H);
 
+  _newborns = true;
   Critter *c = addCritter(genome, p.x, p.y, dice(0., 2.*M_PI), energy);
+  _newborns = false;
 
   if (debugReproduction)  std::cerr << "\tSpawned " << CID(c) << std::endl;
 
@@ -667,7 +921,8 @@ Critter* Simulation::createChild(const Critter *parent, const CGenome &genome,
 }
 
 void Simulation::produceCorpses(void) {
-  std::vector<Critter*> corpses;
+  auto &corpses = _scratch.corpses;
+  corpses.clear();
   for (Critter *c: _critters)
     if (c->isDead())
       corpses.push_back(c);
@@ -678,6 +933,7 @@ void Simulation::produceCorpses(void) {
                             c->totalStoredEnergy());
     f->setBaseColor(c->initialBodyColor());
     f->updateColor();
+    f->setArena(c->arena());
     delCritter(c);
   }
 }
@@ -686,7 +942,8 @@ void Simulation::decomposition(void) {
   for (Foodlet *f: _foodlets) if (f->isCorpse())  f->update(*_environment);
 
   // Remove empty foodlets
-  std::vector<Foodlet*> consumed;
+  auto &consumed = _scratch.consumed;
+  consumed.clear();
   for (Foodlet *f: _foodlets)
     if (f->energy() <= 0)
       consumed.push_back(f), assert(f->energy() >= 0);
@@ -734,7 +991,8 @@ void Simulation::logStats (void) {
 
   s.ncritters = _critters.size();
 
-  s.nfeedings = _environment->feedingEvents().size();
+  s.nfeedings = _environment->feedingEvents().size()
+              + _environment->plants().contacts();
   s.nfights = _environment->fightingEvents().size();
 
   for (const auto &c: _critters) {
@@ -748,6 +1006,9 @@ void Simulation::logStats (void) {
 
   decimal eE = totalEnergy() - _systemExpectedEnergy;
 
+  const b2Profile b2p = _environment->physicsProfile();
+  auto b2s = _environment->worldStats(true);
+
 //  s.fmin = _ssga.worstFitness();
 //  s.favg = _ssga.averageFitness();
 //  s.fmax = _ssga.bestFitness();
@@ -761,7 +1022,10 @@ void Simulation::logStats (void) {
                     " eE"
                     " FRepro SRepro ARepro"// ERepro"
                     " GMin GMax"// FMin FAvg FMax"
-                    " DYInj DAInj DOInj DYStr DAStr DOStr DOAge";
+                    " DYInj DAInj DOInj DYStr DAStr DOStr DOAge"
+                    " B2Step B2Collide B2Solve B2Broadphase B2TOI"
+                    " B2Bodies B2Awake B2Contacts B2Touching B2Proxies"
+                    " B2Islands B2MaxIsland";
 
 //    for (const auto &p: _ssga.champStats())
 //      _statsLogger << " SSGAC" << p.first;
@@ -791,6 +1055,12 @@ void Simulation::logStats (void) {
       _statsLogger << " " << v;
   _statsLogger << " " << _autopsies.oldage;
 
+  _statsLogger << " " << b2p.step << " " << b2p.collide << " " << b2p.solve
+               << " " << b2p.broadphase << " " << b2p.solveTOI
+               << " " << b2s.bodies << " " << b2s.awake << " " << b2s.contacts
+               << " " << b2s.touching << " " << b2s.proxies
+               << " " << b2s.islands << " " << b2s.largestIsland;
+
 //  for (const auto &p: _ssga.champStats())
 //    _statsLogger << " " << p.second;
 
@@ -886,6 +1156,7 @@ void Simulation::detectBudgetFluctuations(float threshold) {
     oss << "\t Reserve: " << _environment->energy() << "\n";
 
     std::cerr << oss.str() << std::endl;
+    dumpFlightRecorder(oss.str());
 
     assert(false);
     abort();
@@ -944,6 +1215,7 @@ void Simulation::deserializePopulations (const json &jcritters,
     b2Body *b = foodletBody(j[0][0], j[0][1]);
     Foodlet *f = Foodlet::load(j[1], b);
     _foodlets.insert(f);
+    if (f->isPlant() && PlantField::enabled())  _environment->plants().insert(f);
   }
 
   for (const auto &j: jcritters) {
@@ -970,6 +1242,7 @@ std::string field (SimuFields f) {
 }
 
 void Simulation::save (stdfs::path file) const {
+  Trace::Span span ("save", "simu");
   auto startTime = clock::now();
   if (file.empty()) file = periodicSaveName();
 
@@ -1129,16 +1402,20 @@ void Simulation::clone (const Simulation &s) {
 
   _gidManager = s._gidManager;
   for (Critter *c: s._critters) {
-    b2Body *b_ = Box2DUtils::clone(&c->body(), &physics());
+    b2Body *b_ = Box2DUtils::clone(&c->body(),
+                                   &_environment->physicsAt(c->pos()));
     Critter *c_ = Critter::clone(c, b_);
     _critters.insert(c_);
   }
 
   _nextFoodletID = s._nextFoodletID;
   for (Foodlet *f: s._foodlets) {
-    b2Body *b_ = Box2DUtils::clone(&f->body(), &physics());
+    b2Body *b_ = Box2DUtils::clone(&f->body(),
+                                   &_environment->physicsAt(f->pos()));
     Foodlet *f_ = Foodlet::clone(f, b_);
     _foodlets.insert(f_);
+    if (f_->isPlant() && PlantField::enabled())
+      _environment->plants().insert(f_);
   }
 
   _time = s._time;
@@ -1151,7 +1428,6 @@ void Simulation::clone (const Simulation &s) {
 
   _systemExpectedEnergy = s._systemExpectedEnergy;
 
-  _timeMs.level = s._timeMs.level;
   _reproductions = s._reproductions;
   _autopsies = s._autopsies;
   _competitionStats = s._competitionStats;
@@ -1190,12 +1466,6 @@ void assertEqual (const Simulation &lhs, const Simulation &rhs, bool deepcopy) {
 //  ASRT(_competitionLogger);
   ASRT(_populations);
   ASRT(_systemExpectedEnergy);
-  ASRT(_timeMs.step);
-  ASRT(_timeMs.spln);
-  ASRT(_timeMs.env);
-  ASRT(_timeMs.decay);
-  ASRT(_timeMs.regen);
-  ASRT(_timeMs.level);
   ASRT(_reproductions.attempts);
   ASRT(_reproductions.sexual);
   ASRT(_reproductions.asexual);
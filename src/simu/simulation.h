@@ -10,6 +10,8 @@
 
 #include "time.h"
 #include "config.h"
+#include "allocations.h"
+#include "flightrecorder.h"
 
 DEFINE_PRETTY_ENUMERATION(SimuFields, ENV, CRITTERS, FOODLETS, PTREE)
 
@@ -17,6 +19,8 @@ namespace simu {
 
 struct Simulation;
 struct Scenario;
+class Arenas;
+struct Kernels;
 
 using SimulationCallback = std::function<void(void)>;
 using CritterCallback = std::function<void(Critter*)>;
@@ -60,14 +64,6 @@ protected:
 
   decimal _systemExpectedEnergy;
 
-  struct SubstepMonitor {
-    uint step, spln, env, decay, regen;
-    uint level;
-
-    SubstepMonitor (void)
-      : step(0), spln(0), env(0), decay(0), regen(0), level(0) {}
-  } _timeMs;
-
   struct ReproductionStats {
     uint attempts = 0, sexual = 0, asexual = 0;
   } _reproductions;
@@ -99,8 +95,31 @@ protected:
 
   bool _finished, _aborted;
 
+  /// Whether critters currently being added are newborns (whose brains are
+  /// built in the background, see config::Simulation::gestationSteps)
+  bool _newborns;
+
+  /// Warm-up steps before checking for allocations, read from
+  /// SPLINOIDS_CHECK_ALLOCATIONS on construction (see checkAllocations)
+  int _checkAllocationsAfter;
+
+  /// Last steps, dumped on abort or budget assertion
+  FlightRecorder _flightRecorder;
+
+  /// Reused across steps to keep them allocation-free
+  struct {
+    std::vector<std::pair<Critter*,Critter*>> matings;
+    std::vector<Critter*> corpses;
+    std::vector<Foodlet*> consumed;
+    std::vector<Critter*> critters;
+    std::vector<Critter::ThinkDurations> durations;
+    std::vector<char> isolated;
+  } _scratch;
+
 private:
   friend Scenario;
+  friend Arenas;  // Packed fights (mkombat)
+  friend Kernels; // Micro-benchmarks (tools/microbench.cpp)
   using Callbacks = std::map<Callback, SimulationCallbackVariant>;
   Callbacks _callbacks;
 
@@ -216,6 +235,31 @@ public:
              std::vector<Critter::Genome> cgenomes,
              const InitData &data);
 
+  /// Destroys all entities and restores the initial state (first part of
+  /// init). An existing environment is recycled instead of rebuilt
+  void reset (const Environment::Genome &egenome, const InitData &data);
+
+  /// Simulation borrowed from the calling thread's pool and given back
+  /// (emptied) on destruction, so that successive evaluations reuse the same
+  /// containers (the physics world is rebuilt, see Environment::reset)
+  class Lease {
+    std::unique_ptr<Simulation> _simulation;
+  public:
+    Lease (void);
+    ~Lease (void);
+
+    Lease (Lease &&) = default;
+    Lease& operator= (Lease &&) = delete;
+
+    Simulation& operator* (void) {
+      return *_simulation;
+    }
+
+    Simulation* operator-> (void) {
+      return _simulation.get();
+    }
+  };
+
   void setupCallbacks(const Callbacks &c) { _callbacks = c; }
 
   template <typename F, typename ...ARGS>
@@ -258,6 +302,18 @@ public:
 
   decimal totalEnergy(void) const;
 
+  const FlightRecorder& flightRecorder (void) const {
+    return _flightRecorder;
+  }
+
+  /// Writes the flight recorder to <workPath>/flight_<pid>_<n>_<time>.rec
+  void dumpFlightRecorder (const std::string &reason) const;
+
+  /// Per-phase timings (see Profiler for how to enable them)
+  const Profiler& profiler (void) const {
+    return _environment->profiler();
+  }
+
   void mutateEnvController (rng::AbstractDice &dice, float r) {
     _environment->mutateController(dice, r);
   }
@@ -327,12 +383,12 @@ public:
 
     SWAP(_systemExpectedEnergy);
 
-    SWAP(_timeMs);
     SWAP(_reproductions);
     SWAP(_autopsies);
     SWAP(_competitionStats);
 
     SWAP(_aborted);
+    SWAP(_flightRecorder);
 
 #undef SWAP
   }
@@ -370,8 +426,26 @@ private:
   void decomposition (void);
   void plantRenewal (float bounds = -1);
 
+  /// Back to a freshly constructed state (but for the environment)
+  void recycle (void);
+
   void logStats (void);
 
+  /// Critters' step with every vision and neural network evaluated at once,
+  /// on the worker pool (see config::Simulation::twoPhaseStep)
+  void twoPhaseCrittersStep (void);
+
+  /// Critters feeding on the plants they overlap, when these are kept out of
+  /// the physics (see PlantField)
+  void plantsFeeding (void);
+
+  /// Moves the dormant critters and updates who is (see Critter::isolated)
+  void lodStep (void);
+
+  /// Throws if a step without structural changes allocated more than what is
+  /// needed for pools to grow (see SPLINOIDS_CHECK_ALLOCATIONS)
+  void checkAllocations (const Allocations::Stats &stats) const;
+
   // Compensate for variations in total energy
   void correctFloatingErrors (void);
 };
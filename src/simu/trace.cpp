@@ -0,0 +1,95 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+#include "trace.h"
+
+namespace simu {
+
+namespace {
+
+/// Owns the per-thread buffers (so that they survive their thread)
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Trace::Buffer>> buffers;
+  std::string file;
+  bool flushed = false;
+
+  static Registry& instance (void) {
+    static Registry r;
+    return r;
+  }
+
+  Registry (void) {
+    if (const char *v = std::getenv("SPLINOIDS_TRACE")) file = v;
+  }
+
+  ~Registry (void) {
+    Trace::flush();
+  }
+};
+
+bool enabledFromEnvironment (void) {
+  // Created now to outlive (most) other static objects
+  return !Registry::instance().file.empty();
+}
+
+} // end of anonymous namespace
+
+const bool Trace::_enabled = enabledFromEnvironment();
+const Trace::clock::time_point Trace::_origin = Trace::clock::now();
+
+Trace::Buffer& Trace::buffer (void) {
+  thread_local Buffer *b = nullptr;
+  if (!b) {
+    Registry &r = Registry::instance();
+    std::lock_guard<std::mutex> lock (r.mutex);
+    r.buffers.push_back(std::make_unique<Buffer>());
+    b = r.buffers.back().get();
+  }
+  return *b;
+}
+
+void Trace::flush (void) {
+  Registry &r = Registry::instance();
+  std::lock_guard<std::mutex> lock (r.mutex);
+  if (!_enabled || r.flushed) return;
+  r.flushed = true;
+
+  std::ofstream ofs (r.file);
+  if (!ofs) {
+    std::cerr << "Failed to open trace file '" << r.file << "'\n";
+    return;
+  }
+
+  const auto pid = getpid();
+  size_t n = 0;
+  ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  for (size_t tid=0; tid<r.buffers.size(); tid++) {
+    ofs << (tid > 0 ? ",\n" : "")
+        << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+        << ",\"tid\":" << tid << ",\"args\":{\"name\":\"thread " << tid
+        << "\"}}";
+
+    for (const Event &e: *r.buffers[tid]) {
+      ofs << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+          << "\",\"pid\":" << pid << ",\"tid\":" << tid
+          << ",\"ts\":" << e.start;
+      if (e.duration >= 0)
+            ofs << ",\"ph\":\"X\",\"dur\":" << e.duration;
+      else  ofs << ",\"ph\":\"i\",\"s\":\"p\"";
+      if (e.arg >= 0) ofs << ",\"args\":{\"id\":" << e.arg << "}";
+      ofs << "}";
+      n++;
+    }
+  }
+  ofs << "\n]}\n";
+
+  std::cerr << "Trace (" << n << " events) written to " << r.file << "\n";
+}
+
+} // end of namespace simu
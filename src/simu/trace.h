@@ -0,0 +1,85 @@
+#ifndef SIMU_TRACE_H
+#define SIMU_TRACE_H
+
+#include <chrono>
+#include <deque>
+
+namespace simu {
+
+/// Timeline of what every thread did, in the trace-event format (viewable
+/// with chrome://tracing or https://ui.perfetto.dev)
+///
+/// Enabled by setting SPLINOIDS_TRACE to the output file. Events are appended
+/// to a per-thread buffer (no locking besides a thread's first event) and all
+/// buffers are written when the program exits.
+///
+/// Names and categories must be string literals (or otherwise outlive the
+/// program) as only their address is stored.
+struct Trace {
+  using clock = std::chrono::steady_clock;
+
+  struct Event {
+    const char *name, *category;
+    int64_t start, duration;  ///< In microseconds. Negative for instants
+    int64_t arg;              ///< Shown as args.id (if non-negative)
+  };
+  using Buffer = std::deque<Event>;
+
+  static bool enabled (void) {
+    return _enabled;
+  }
+
+  /// Microseconds since the trace origin
+  static int64_t timestamp (clock::time_point t = clock::now()) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+             t - _origin).count();
+  }
+
+  static void complete (const char *name, const char *category,
+                        clock::time_point start, clock::time_point end,
+                        int64_t arg = -1) {
+    auto ts = timestamp(start);
+    buffer().push_back({name, category, ts, timestamp(end) - ts, arg});
+  }
+
+  /// Zero-duration marker (e.g. a generation boundary)
+  static void instant (const char *name, const char *category,
+                       int64_t arg = -1) {
+    if (_enabled) buffer().push_back({name, category, timestamp(), -1, arg});
+  }
+
+  /// Records its scope as a complete event (if tracing is enabled)
+  class Span {
+    const char *_name, *_category;
+    int64_t _arg;
+    bool _active;
+    clock::time_point _start;
+
+  public:
+    Span (const char *name, const char *category, int64_t arg = -1)
+      : _name(name), _category(category), _arg(arg), _active(enabled()) {
+      if (_active)  _start = clock::now();
+    }
+
+    Span (const Span&) = delete;
+    Span& operator= (const Span&) = delete;
+
+    ~Span (void) {
+      if (_active)  complete(_name, _category, _start, clock::now(), _arg);
+    }
+  };
+
+  /// Writes all buffers to the output file (automatically called at exit)
+  static void flush (void);
+
+private:
+  static const bool _enabled;
+  static const clock::time_point _origin;
+
+  /// This thread's buffer (registered on first use)
+  static Buffer& buffer (void);
+};
+
+} // end of namespace simu
+
+#endif // SIMU_TRACE_H
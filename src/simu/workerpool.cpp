@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "workerpool.h"
+
+namespace simu {
+
+WorkerPool::WorkerPool (uint threads)
+  : _stop(false), _batch(nullptr), _batchId(0) {
+  for (uint i=0; i<threads; i++)
+    _threads.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool (void) {
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  for (std::thread &t: _threads)  t.join();
+}
+
+WorkerPool& WorkerPool::instance (void) {
+  static WorkerPool pool ([] {
+    const char *v = std::getenv("SPLINOIDS_BRAIN_WORKERS");
+    return v ? std::max(0, std::atoi(v)) : 0;
+  }());
+  return pool;
+}
+
+void WorkerPool::work (void) {
+  uint seen = 0;  // Last batch joined
+  while (true) {
+    std::function<void(void)> task;
+    Batch *batch = nullptr;
+    {
+      std::unique_lock<std::mutex> lock (_mutex);
+      _cv.wait(lock, [this, &seen] {
+        return _stop || !_queue.empty() || (_batch && _batchId != seen);
+      });
+      if (_batch && _batchId != seen) {
+        batch = _batch;
+        seen = _batchId;
+        batch->workers++;
+
+      } else if (_queue.empty())
+        return; // Stopped and nothing left to do
+
+      else {
+        task = std::move(_queue.front());
+        _queue.pop_front();
+      }
+    }
+
+    if (batch) {
+      process(*batch);
+      std::lock_guard<std::mutex> lock (_mutex);
+      if (--batch->workers == 0)  _batchDone.notify_all();
+
+    } else
+      task();
+  }
+}
+
+void WorkerPool::run (Batch &b) {
+  bool shared;
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    shared = (_batch == nullptr);
+    if (shared) {
+      _batch = &b;
+      _batchId++;
+    }
+  }
+
+  // Another thread's batch is in progress: go it alone
+  if (!shared)  return process(b);
+
+  _cv.notify_all();
+  process(b);
+
+  // Every index is taken: wait for those still being processed
+  std::unique_lock<std::mutex> lock (_mutex);
+  _batchDone.wait(lock, [&b] { return b.workers == 0; });
+  _batch = nullptr;
+}
+
+void WorkerPool::process (Batch &b) {
+  for (uint i = b.next++; i < b.n; i = b.next++)  b.call(b.f, i);
+}
+
+} // end of namespace simu
@@ -0,0 +1,96 @@
+#ifndef SIMU_WORKERPOOL_H
+#define SIMU_WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace simu {
+
+/// Process-wide pool of background threads for deferrable work (e.g. brains
+/// of newborns, see config::Simulation::gestationSteps) and data-parallel
+/// loops (see forEach)
+///
+/// The number of threads is given by SPLINOIDS_BRAIN_WORKERS (default 0). With
+/// no threads, tasks are deferred and run by whoever first waits on them.
+/// Tasks must thus not depend on when (or where) they run.
+class WorkerPool {
+  /// Indices shared between the caller of forEach and the workers
+  struct Batch {
+    uint n;
+    void (*call) (const void *f, uint i);
+    const void *f;
+    std::atomic<uint> next;
+    uint workers;   ///< Currently processing (guarded by _mutex)
+  };
+
+  std::vector<std::thread> _threads;
+  std::deque<std::function<void(void)>> _queue;
+  std::mutex _mutex;
+  std::condition_variable _cv, _batchDone;
+  bool _stop;
+
+  Batch *_batch;
+  uint _batchId;
+
+  WorkerPool (uint threads);
+
+  void work (void);
+
+  void run (Batch &b);
+  static void process (Batch &b);
+
+public:
+  ~WorkerPool (void);
+
+  static WorkerPool& instance (void);
+
+  uint size (void) const {
+    return _threads.size();
+  }
+
+  template <typename F>
+  auto submit (F &&f) {
+    using R = std::invoke_result_t<F>;
+    if (_threads.empty())
+      return std::async(std::launch::deferred, std::forward<F>(f));
+
+    auto task = std::make_shared<std::packaged_task<R(void)>>(
+                  std::forward<F>(f));
+    auto future = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock (_mutex);
+      _queue.emplace_back([task] { (*task)(); });
+    }
+    _cv.notify_one();
+    return future;
+  }
+
+  /// Calls f(i) for every i in [0,n), spread over the workers and the caller,
+  /// and returns once all are done. Does not allocate.
+  /// Calls for different indices must be independent
+  template <typename F>
+  void forEach (uint n, const F &f) {
+    if (_threads.empty() || n < 2) {
+      for (uint i=0; i<n; i++)  f(i);
+      return;
+    }
+
+    Batch b;
+    b.n = n;
+    b.call = [] (const void *f, uint i) { (*static_cast<const F*>(f))(i); };
+    b.f = &f;
+    b.next = 0;
+    b.workers = 0;
+    run(b);
+  }
+};
+
+} // end of namespace simu
+
+#endif // SIMU_WORKERPOOL_H
@@ -0,0 +1,21 @@
+#ifndef TESTS_GENOMES_H
+#define TESTS_GENOMES_H
+
+#include "kgd/external/json.hpp"
+
+/// Canned genomes for a reproducible two-critters fight (tester, benchmark)
+namespace canned {
+
+using json = nlohmann::json;
+static const json env_json = R"({"mvp":1,"size":4,"taurus":1})"_json;
+static const int spacing = 1;
+
+static const json agg_json =
+  R"({"asexual":1,"bdepth":2,"cdata":{"S":1,"mu":1.5255935192108154,"si":2.0,"so":2.0},"colors":[[0.2757517397403717,0.4613220989704132,0.2592845559120178],[0.6694125533103943,0.257860004901886,0.7085900902748108],[0.5034935474395752,0.48779943585395813,0.28763362765312195],[0.48798668384552,0.5404545664787292,0.3623172640800476],[0.6956374645233154,0.7438890933990479,0.4656842052936554],[0.36192917823791504,0.6419539451599121,0.3971322178840637],[0.5745621919631958,0.2712758481502533,0.3819182515144348],[0.718996524810791,0.676059365272522,0.5456474423408508],[0.40456676483154297,0.3773477077484131,0.33870458602905273],[0.5444707870483398,0.6040284633636475,0.28086891770362854]],"dimorphism":[0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0],"gen":{"f":{"g":4294967295,"s":4294967295},"m":{"g":1,"s":4294967295},"s":{"g":0,"s":4294967295}},"hNeat":{"data":[7,2,[[1,1,0.0,1,0.0,0.0,0.0,0.0],[2,1,0.0,1,0.0,0.0,0.0,0.0],[3,1,0.0,1,0.0,0.0,0.0,0.0],[4,1,0.0,1,0.0,0.0,0.0,0.0],[5,1,0.0,1,0.0,0.0,0.0,0.0],[6,1,0.0,1,0.0,0.0,0.0,0.0],[7,2,0.0,1,0.0,0.0,0.0,0.0],[8,4,1.0,2,3.025,0.0,0.0,0.0],[9,4,1.0,2,3.025,0.0,0.0,0.0]],[[1,8,1,false,-0.2224141622054316],[2,8,2,false,-0.2893479423074784],[3,8,3,false,-0.2623941856224721],[4,8,4,false,0.07122884209669722],[5,8,5,false,-0.07434555406294124],[6,8,6,false,0.331783829828021],[7,8,7,false,0.15527017243522534],[1,9,8,false,0.27539565995951865],[2,9,9,false,-0.10105442860410951],[3,9,10,false,0.30601693733333146],[4,9,11,false,0.13018283353913396],[5,9,12,false,-0.2861922949246051],[6,9,13,false,0.10476210702341515],[7,9,14,false,0.012611255834330759]]],"hnl":1,"hnv":1},"mature":0.33000001311302185,"maxCS":1.0,"minCS":1.0,"old":0.6600000262260437,"splines":[{"data":[0.9738937616348267,-0.816814124584198,0.3700000047683716,0.0,0.48000001907348633,1.0,0.0,0.4449999928474426,0.0,0.5]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]}],"vision":{"angleBody":0.5235987901687622,"angleRelative":0.0,"precision":1,"width":1.0471975803375244}})"_json;
+
+static const json def_json =
+  R"({"asexual":1,"bdepth":2,"cdata":{"S":1,"mu":3.716581106185913,"si":2.0,"so":2.0},"colors":[[0.7463167905807495,0.37734198570251465,0.6041678190231323],[0.723727285861969,0.5157703161239624,0.6358364820480347],[0.41869887709617615,0.6319261789321899,0.3835113048553467],[0.35868561267852783,0.6567767858505249,0.4212232232093811],[0.5429543256759644,0.6055812239646912,0.3682592511177063],[0.3386257290840149,0.28748273849487305,0.39409199357032776],[0.28446635603904724,0.4578661620616913,0.38329559564590454],[0.37569767236709595,0.39282092452049255,0.633774995803833],[0.6629076600074768,0.6410514116287231,0.5506556034088135],[0.3471841514110565,0.3441762924194336,0.46281373500823975]],"dimorphism":[0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0],"gen":{"f":{"g":4294967295,"s":4294967295},"m":{"g":1,"s":4294967295},"s":{"g":5,"s":4294967295}},"hNeat":{"data":[7,2,[[1,1,0.0,1,0.0,0.0,0.0,0.0],[2,1,0.0,1,0.0,0.0,0.0,0.0],[3,1,0.0,1,0.0,0.0,0.0,0.0],[4,1,0.0,1,0.0,0.0,0.0,0.0],[5,1,0.0,1,0.0,0.0,0.0,0.0],[6,1,0.0,1,0.0,0.0,0.0,0.0],[7,2,0.0,1,0.0,0.0,0.0,0.0],[8,4,1.0,2,3.025,0.0,0.0,0.0],[9,4,1.0,2,3.025,0.0,0.0,0.0]],[[1,8,1,false,0.14466649659060304],[2,8,2,false,0.16571769576844209],[3,8,3,false,0.09983673131406512],[4,8,4,false,0.22465679478980638],[5,8,5,false,0.3806830012141498],[6,8,6,false,0.23475786514491026],[7,8,7,false,-0.3168707449042088],[1,9,8,false,-0.012957573157536373],[2,9,9,false,0.013044770053520616],[3,9,10,false,-0.21084683843428137],[4,9,11,false,0.1152910997911547],[5,9,12,false,0.24432266712397832],[6,9,13,false,0.28268882022029795],[7,9,14,false,-0.13396260903750606]]],"hnl":1,"hnv":1},"mature":0.33000001311302185,"maxCS":1.0,"minCS":1.0,"old":0.6600000262260437,"splines":[{"data":[0.816814124584198,1.1938053369522095,0.5,0.0,-0.12000000476837158,1.0,0.7000000476837158,0.25,0.5,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]}],"vision":{"angleBody":0.5235987901687622,"angleRelative":0.0,"precision":1,"width":1.0471975803375244}})"_json;
+
+} // end of namespace canned
+
+#endif // TESTS_GENOMES_H
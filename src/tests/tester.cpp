@@ -1,6 +1,9 @@
 #include <csignal>
+#include <cstdlib>
 
 #include "../simu/simulation.h"
+#include "../genotype/codec.h"
+#include "genomes.h"
 
 #include "kgd/external/cxxopts.hpp"
 
@@ -33,15 +36,154 @@ long maybeSeed(const std::string& s) {
   return p? l : -2;
 }
 
-using json = nlohmann::json;
-static const json env_json = R"({"mvp":1,"size":4,"taurus":1})"_json;
-static const int spacing = 1;
+using namespace canned;
 
-static const json agg_json =
-  R"({"asexual":1,"bdepth":2,"cdata":{"S":1,"mu":1.5255935192108154,"si":2.0,"so":2.0},"colors":[[0.2757517397403717,0.4613220989704132,0.2592845559120178],[0.6694125533103943,0.257860004901886,0.7085900902748108],[0.5034935474395752,0.48779943585395813,0.28763362765312195],[0.48798668384552,0.5404545664787292,0.3623172640800476],[0.6956374645233154,0.7438890933990479,0.4656842052936554],[0.36192917823791504,0.6419539451599121,0.3971322178840637],[0.5745621919631958,0.2712758481502533,0.3819182515144348],[0.718996524810791,0.676059365272522,0.5456474423408508],[0.40456676483154297,0.3773477077484131,0.33870458602905273],[0.5444707870483398,0.6040284633636475,0.28086891770362854]],"dimorphism":[0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0],"gen":{"f":{"g":4294967295,"s":4294967295},"m":{"g":1,"s":4294967295},"s":{"g":0,"s":4294967295}},"hNeat":{"data":[7,2,[[1,1,0.0,1,0.0,0.0,0.0,0.0],[2,1,0.0,1,0.0,0.0,0.0,0.0],[3,1,0.0,1,0.0,0.0,0.0,0.0],[4,1,0.0,1,0.0,0.0,0.0,0.0],[5,1,0.0,1,0.0,0.0,0.0,0.0],[6,1,0.0,1,0.0,0.0,0.0,0.0],[7,2,0.0,1,0.0,0.0,0.0,0.0],[8,4,1.0,2,3.025,0.0,0.0,0.0],[9,4,1.0,2,3.025,0.0,0.0,0.0]],[[1,8,1,false,-0.2224141622054316],[2,8,2,false,-0.2893479423074784],[3,8,3,false,-0.2623941856224721],[4,8,4,false,0.07122884209669722],[5,8,5,false,-0.07434555406294124],[6,8,6,false,0.331783829828021],[7,8,7,false,0.15527017243522534],[1,9,8,false,0.27539565995951865],[2,9,9,false,-0.10105442860410951],[3,9,10,false,0.30601693733333146],[4,9,11,false,0.13018283353913396],[5,9,12,false,-0.2861922949246051],[6,9,13,false,0.10476210702341515],[7,9,14,false,0.012611255834330759]]],"hnl":1,"hnv":1},"mature":0.33000001311302185,"maxCS":1.0,"minCS":1.0,"old":0.6600000262260437,"splines":[{"data":[0.9738937616348267,-0.816814124584198,0.3700000047683716,0.0,0.48000001907348633,1.0,0.0,0.4449999928474426,0.0,0.5]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]}],"vision":{"angleBody":0.5235987901687622,"angleRelative":0.0,"precision":1,"width":1.0471975803375244}})"_json;
+/// Genomes must come back unaltered from their binary, armored and json forms
+uint testCodec (void) {
+  using Codec = genotype::Codec;
 
-static const json def_json =
-  R"({"asexual":1,"bdepth":2,"cdata":{"S":1,"mu":3.716581106185913,"si":2.0,"so":2.0},"colors":[[0.7463167905807495,0.37734198570251465,0.6041678190231323],[0.723727285861969,0.5157703161239624,0.6358364820480347],[0.41869887709617615,0.6319261789321899,0.3835113048553467],[0.35868561267852783,0.6567767858505249,0.4212232232093811],[0.5429543256759644,0.6055812239646912,0.3682592511177063],[0.3386257290840149,0.28748273849487305,0.39409199357032776],[0.28446635603904724,0.4578661620616913,0.38329559564590454],[0.37569767236709595,0.39282092452049255,0.633774995803833],[0.6629076600074768,0.6410514116287231,0.5506556034088135],[0.3471841514110565,0.3441762924194336,0.46281373500823975]],"dimorphism":[0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0],"gen":{"f":{"g":4294967295,"s":4294967295},"m":{"g":1,"s":4294967295},"s":{"g":5,"s":4294967295}},"hNeat":{"data":[7,2,[[1,1,0.0,1,0.0,0.0,0.0,0.0],[2,1,0.0,1,0.0,0.0,0.0,0.0],[3,1,0.0,1,0.0,0.0,0.0,0.0],[4,1,0.0,1,0.0,0.0,0.0,0.0],[5,1,0.0,1,0.0,0.0,0.0,0.0],[6,1,0.0,1,0.0,0.0,0.0,0.0],[7,2,0.0,1,0.0,0.0,0.0,0.0],[8,4,1.0,2,3.025,0.0,0.0,0.0],[9,4,1.0,2,3.025,0.0,0.0,0.0]],[[1,8,1,false,0.14466649659060304],[2,8,2,false,0.16571769576844209],[3,8,3,false,0.09983673131406512],[4,8,4,false,0.22465679478980638],[5,8,5,false,0.3806830012141498],[6,8,6,false,0.23475786514491026],[7,8,7,false,-0.3168707449042088],[1,9,8,false,-0.012957573157536373],[2,9,9,false,0.013044770053520616],[3,9,10,false,-0.21084683843428137],[4,9,11,false,0.1152910997911547],[5,9,12,false,0.24432266712397832],[6,9,13,false,0.28268882022029795],[7,9,14,false,-0.13396260903750606]]],"hnl":1,"hnv":1},"mature":0.33000001311302185,"maxCS":1.0,"minCS":1.0,"old":0.6600000262260437,"splines":[{"data":[0.816814124584198,1.1938053369522095,0.5,0.0,-0.12000000476837158,1.0,0.7000000476837158,0.25,0.5,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]},{"data":[1.5707963705062866,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0]}],"vision":{"angleBody":0.5235987901687622,"angleRelative":0.0,"precision":1,"width":1.0471975803375244}})"_json;
+  rng::FastDice dice;
+  dice.reset(0);
+
+  std::vector<CGenome> genomes { CGenome(agg_json), CGenome(def_json) };
+  for (uint i=0; i<10; i++) {
+    CGenome g = CGenome::random(dice);
+    genomes.push_back(g);
+    for (uint j=0; j<100; j++)  g.mutate(dice);
+    genomes.push_back(g);
+  }
+
+  uint failures = 0;
+  for (const CGenome &g: genomes) {
+    const auto check = [&failures, &g] (const CGenome &g_, const char *form) {
+      if (g_ == g)  return;
+      std::cerr << "Genome codec: " << form << " round-trip failed for\n"
+                << g << std::endl;
+      failures++;
+    };
+    check(Codec::decode(Codec::encode(g)), "binary");
+    check(CGenome(g.serialize()), "armored");
+    check(CGenome(nlohmann::json(g).dump()), "json");
+    check(Codec::toJSON(g.serialize()).get<CGenome>(), "armored to json");
+  }
+
+  std::cout << "Genome codec: " << genomes.size() - failures << "/"
+            << genomes.size() << " round-trips succeeded" << std::endl;
+  return failures;
+}
+
+/// The canned fight, with active brains, as a flat list of the critters' states
+std::vector<float> trajectory (simu::Simulation &s) {
+  static constexpr uint STEPS = 200;
+
+  simu::Simulation::InitData idata {};
+  idata.ienergy = 0;
+  idata.nCritters = 0;
+  idata.seed = 0;
+
+  std::vector<CGenome> cgenomes { CGenome(agg_json), CGenome(def_json) };
+  s.init(EGenome(env_json), cgenomes, idata);
+
+  auto e = simu::Critter::maximalEnergyStorage(simu::Critter::MAX_SIZE);
+  auto c0 = s.addCritter(cgenomes[0], -spacing, 0, 0, e, .5);
+  s.addCritter(cgenomes[1], +spacing, 0, M_PI, e, .5);
+  c0->body().ApplyLinearImpulseToCenter({5, 0}, true);
+
+  std::vector<float> t;
+  for (uint i=0; i<STEPS && !s.extinct(); i++) {
+    s.step();
+    for (const simu::Critter *c: s.critters()) {
+      const auto &v = c->body().GetLinearVelocity();
+      t.insert(t.end(), { c->x(), c->y(), c->rotation(), v.x, v.y,
+                          float(c->usableEnergy()), float(c->bodyHealthness()) });
+    }
+  }
+  return t;
+}
+
+/// Leased (pooled, recycled) simulations must step exactly as new ones
+uint testLeases (void) {
+  std::vector<float> reference;
+  {
+    simu::Simulation s;
+    reference = trajectory(s);
+  }
+
+  uint failures = 0;
+  for (uint i=0; i<3; i++) {
+    simu::Simulation::Lease s;
+    if (trajectory(*s) != reference) {
+      std::cerr << "Simulation pool: lease " << i << " diverged from a new"
+                   " simulation" << std::endl;
+      failures++;
+    }
+  }
+
+  std::cout << "Simulation pool: " << 3 - failures << "/3 leases matched a"
+               " new simulation" << std::endl;
+  return failures;
+}
+
+/// A tiled arena (concurrently stepped worlds, with ghosts at the borders)
+/// must be deterministic. The canned fight takes place across the border
+/// between two tiles
+uint testTiles (void) {
+  auto &tiles = config::Simulation::physicsTiles.ref();
+  const uint tilesPerSide = tiles;
+  tiles = 2;
+
+  std::vector<float> reference;
+  uint failures = 0;
+  for (uint i=0; i<3; i++) {
+    simu::Simulation s;
+    std::vector<float> t = trajectory(s);
+    if (s.environment().tiles() != 4)
+      utils::doThrow<std::logic_error>(
+        "Physics tiles: expected 4 worlds, got ", s.environment().tiles());
+
+    if (i == 0)
+      reference = t;
+    else if (t != reference) {
+      std::cerr << "Physics tiles: run " << i << " diverged from the first"
+                << std::endl;
+      failures++;
+    }
+  }
+
+  tiles = tilesPerSide;
+
+  std::cout << "Physics tiles: " << 2 - failures << "/2 runs matched the"
+               " first" << std::endl;
+  return failures;
+}
+
+/// Once warmed up, steps without structural changes must only allocate to grow
+/// pools (see SPLINOIDS_CHECK_ALLOCATIONS)
+uint testAllocations (void) {
+  if (!simu::Allocations::available()) {
+    std::cout << "Allocations: not counted in this build" << std::endl;
+    return 0;
+  }
+
+  static constexpr auto VAR = "SPLINOIDS_CHECK_ALLOCATIONS";
+  const bool set = (std::getenv(VAR) == nullptr);
+  if (set)  setenv(VAR, "100", 0);
+
+  uint failures = 0;
+  try {
+    simu::Simulation s;
+    trajectory(s);
+  } catch (const std::logic_error &e) {
+    std::cerr << "Allocations: " << e.what() << std::endl;
+    failures++;
+  }
+
+  if (set)  unsetenv(VAR);
+
+  std::cout << "Allocations: " << 1 - failures << "/1 warmed-up runs were"
+               " allocation-free" << std::endl;
+  return failures;
+}
 
 class TestSimulationHolder {
 public:
@@ -286,6 +428,11 @@ int main(int argc, char *argv[]) {
 
   auto start = simu::Simulation::now();
 
+  if (testCodec() > 0)  return 1;
+  if (testLeases() > 0) return 1;
+  if (testTiles() > 0)  return 1;
+  if (testAllocations() > 0)  return 1;
+
   std::vector<float> speeds { 5/2.f, 15/4.f, 5.f };
   std::vector<float> angles { 0, M_PI/2., M_PI };
 
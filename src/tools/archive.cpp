@@ -0,0 +1,141 @@
+#include "../ga/archive.h"
+#include "../genotype/codec.h"
+
+#include "kgd/external/cxxopts.hpp"
+
+using simu::Archive;
+using simu::ArchiveReader;
+
+void list (const ArchiveReader &reader) {
+  std::map<uint, std::map<Archive::Kind, uint>> counts;
+  for (const Archive::Entry &e: reader.entries())
+    counts[e.generation][e.kind]++;
+
+  std::cout << "Archive " << reader.folder() << ": "
+            << reader.entries().size() << " records, "
+            << counts.size() << " generations\n";
+  for (const auto &g: counts) {
+    std::cout << "\tgen" << g.first << ":";
+    for (const auto &k: g.second)
+      std::cout << " " << char(k.first) << "=" << k.second;
+    std::cout << "\n";
+  }
+}
+
+/// Replaces armored genomes (the "dna" of GAGA individuals) by their json form
+void expand (nlohmann::json &j) {
+  if (j.is_object()) {
+    auto it = j.find("dna");
+    if (it != j.end() && it->is_string())
+      *it = genotype::Codec::toJSON(it->get<std::string>()).dump();
+  }
+  if (j.is_structured())
+    for (auto &v: j)  expand(v);
+}
+
+/// Recreates the genN/ folders (elites, population) as GAGA would have
+void extract (const ArchiveReader &reader, const std::string &generation,
+              const stdfs::path &output, bool json) {
+  int first = 0, last = reader.lastGeneration();
+  if (generation == "last")     first = last;
+  else if (generation != "all") first = last = std::stoi(generation);
+
+  std::map<uint, nlohmann::json> populations;
+  uint files = 0;
+  for (const Archive::Entry &e: reader.entries()) {
+    if (int(e.generation) < first || last < int(e.generation)) continue;
+
+    stdfs::path folder = output / utils::mergeToString("gen", e.generation);
+    stdfs::create_directories(folder);
+
+    if (e.kind == Archive::ELITE) {
+      auto record = reader.read(e);
+      if (json) expand(record);
+      std::ofstream (folder / Archive::eliteFileName(record, e.rank))
+        << record.at("individual").dump(2);
+      files++;
+
+    } else if (e.kind == Archive::POPULATION) {
+      auto record = reader.read(e);
+      if (json) expand(record);
+      populations[e.generation]["population"].push_back(record);
+    }
+  }
+
+  for (const auto &p: populations) {
+    std::ofstream (output / utils::mergeToString("gen", p.first)
+                          / utils::mergeToString("pop", p.first, ".pop"))
+      << p.second.dump();
+    files++;
+  }
+
+  stdfs::path link = output / "gen_last";
+  if (last >= 0 && !stdfs::exists(stdfs::symlink_status(link)))
+    stdfs::create_directory_symlink(utils::mergeToString("gen", last), link);
+
+  std::cout << "Extracted " << files << " files under " << output << "\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::string command, target, generation = "last", output;
+  bool json = false;
+
+  cxxopts::Options options("Splinoids (archive)",
+                           "Inspection and extraction of packed evolution"
+                           " archives");
+  options.add_options()
+    ("h,help", "Display help")
+    ("command", "One of list, cat, extract, reindex, json",
+     cxxopts::value(command))
+    ("target", "Archive folder (or pack) or, for cat, an individual locator"
+               " <archive>:<gen|last>[:<rank>] or, for json, a GAGA file"
+               " (individual or population)",
+     cxxopts::value(target))
+    ("g,generation", "Generation(s) to extract: a number, last or all",
+     cxxopts::value(generation))
+    ("o,output", "Folder under which to extract (defaults to the archive's)",
+     cxxopts::value(output))
+    ("j,json", "Extract genomes as (human-readable) json instead of their"
+               " compact armored form",
+     cxxopts::value(json))
+    ;
+  options.parse_positional({"command", "target"});
+  options.positional_help("<command> <target>");
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("help") || command.empty() || target.empty()) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (command == "cat") {
+    auto individual = ArchiveReader::loadIndividual(target);
+    expand(individual);
+    std::cout << individual.dump(2) << std::endl;
+
+  } else if (command == "json") {
+    auto j = nlohmann::json::parse(utils::readAll(target));
+    expand(j);
+    std::cout << j.dump(2) << std::endl;
+
+  } else if (command == "reindex")
+    ArchiveReader::reindex(stdfs::is_directory(target)
+                           ? stdfs::path(target)
+                           : stdfs::path(target).parent_path());
+
+  else {
+    ArchiveReader reader (target);
+    if (command == "list")
+      list(reader);
+
+    else if (command == "extract")
+      extract(reader, generation,
+              output.empty() ? reader.folder() : stdfs::path(output), json);
+
+    else
+      utils::Thrower("Unknown command '", command, "'");
+  }
+
+  return 0;
+}
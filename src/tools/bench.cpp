@@ -0,0 +1,82 @@
+#include "../simu/simulation.h"
+#include "../tests/genomes.h"
+
+#include "benchmark.h"
+
+using CGenome = genotype::Critter;
+using EGenome = genotype::Environment;
+using simu::Simulation;
+
+EGenome environment (int size, bool taurus) {
+  EGenome e;
+  e.width = e.height = size;
+  e.taurus = taurus;
+  e.maxVegetalPortion = .5;
+  return e;
+}
+
+/// The tester's canned fight, with active brains
+void fight (Simulation &s, uint steps) {
+  Simulation::InitData idata {};
+  idata.ienergy = 0;
+  idata.nCritters = 0;
+  idata.seed = 0;
+
+  std::vector<CGenome> genomes { CGenome(canned::agg_json),
+                                 CGenome(canned::def_json) };
+
+  s.init(environment(4, true), genomes, idata);
+
+  auto e = simu::Critter::maximalEnergyStorage(simu::Critter::MAX_SIZE);
+  auto c0 = s.addCritter(genomes[0], -canned::spacing, 0, 0, e, .5);
+  s.addCritter(genomes[1], +canned::spacing, 0, M_PI, e, .5);
+  c0->body().ApplyLinearImpulseToCenter({5, 0}, true);
+
+  for (uint i=0; i<steps && !s.extinct(); i++)  s.step();
+}
+
+/// n short fights (as in a mkombat evaluation) in either new or leased
+/// simulations: the difference is what the simulation pool saves
+void fights (uint n, uint steps, bool leased) {
+  for (uint i=0; i<n; i++) {
+    if (leased) {
+      Simulation::Lease s;
+      fight(*s, steps);
+    } else {
+      Simulation s;
+      fight(s, steps);
+    }
+  }
+}
+
+/// Closed world with n random (seeded) critters, plants and reproduction
+void ecosystem (uint n, uint steps) {
+  rng::FastDice dice (0);
+
+  Simulation::InitData idata {};
+  idata.nCritters = n;
+  idata.ienergy = 2 * n * simu::Critter::energyForCreation();
+  idata.cRatio = .5;
+  idata.cAge = .5;
+  idata.seed = 0;
+
+  Simulation s;
+  s.init(environment(10 * std::sqrt(n), true), { CGenome::random(dice) },
+         idata);
+
+  for (uint i=0; i<steps && !s.extinct(); i++)  s.step();
+}
+
+int main(int argc, char *argv[]) {
+  config::Simulation::verbosity.overrideWith(0);
+
+  bench::Benchmark b ("splinoids-bench");
+  b.add("mk-fight", [&b] { Simulation s; fight(s, b.steps(2000)); });
+  b.add("mk-fights-new", [&b] { fights(b.steps(100), 20, false); });
+  b.add("mk-fights-leased", [&b] { fights(b.steps(100), 20, true); });
+  for (uint n: {25, 100, 400})
+    b.add(utils::mergeToString("ecosystem-", n),
+          [&b, n] { ecosystem(n, b.steps(40000 / n)); });
+
+  return b.main(argc, argv);
+}
@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <regex>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "kgd/external/cxxopts.hpp"
+
+#include "benchmark.h"
+#include "../simu/allocations.h"
+
+namespace bench {
+
+using json = nlohmann::json;
+using simu::Profiler;
+
+static constexpr auto RED = "\033[31m", GREEN = "\033[32m",
+                      NORMAL = "\033[0m";
+
+static long peakRSSKb (void) {
+  rusage u {};
+  getrusage(RUSAGE_SELF, &u);
+  return u.ru_maxrss;
+}
+
+Benchmark::Benchmark (const std::string &name) : _name(name), _scale(1) {}
+
+void Benchmark::add (const std::string &name, const Workload &w) {
+  _workloads.emplace_back(name, w);
+}
+
+json Benchmark::run (const std::string &name, const Workload &w,
+                     uint repeats) {
+  json best;
+  double bestSeconds = std::numeric_limits<double>::max();
+
+  for (uint r=0; r<repeats; r++) {
+    Profiler discarded;
+    Profiler::takeAggregate(discarded); // Anything from a previous workload
+    discarded.clear();
+
+    simu::Allocations::Scope allocations;
+    auto start = Profiler::clock::now();
+    w();
+    double seconds = std::chrono::duration<double>(
+                       Profiler::clock::now() - start).count();
+
+    Profiler p;
+    Profiler::takeAggregate(p);
+
+    if (seconds < bestSeconds) {
+      bestSeconds = seconds;
+
+      uint64_t steps = p[Profiler::STEP].count,
+               ticks = p[Profiler::AGING].count;
+      double stepTime = p[Profiler::STEP].total;
+
+      json phases;
+      for (uint i=0; i<Profiler::PHASES; i++) {
+        const auto &s = p[Profiler::Phase(i)];
+        if (s.count == 0 || i == Profiler::STEP) continue;
+        phases[Profiler::names[i]] = {
+          { "mean_ns", s.mean() },
+          { "share", stepTime > 0 ? s.total / stepTime : 0 }
+        };
+      }
+
+      best = {
+        { "steps", steps }, { "critter_ticks", ticks },
+        { "seconds", seconds },
+        { "steps_per_second", steps / seconds },
+        { "critter_ticks_per_second", ticks / seconds },
+        { "phases", phases }
+      };
+      if (simu::Allocations::available()) {
+        best["allocs"] = allocations.stats().allocs;
+        best["alloc_bytes"] = allocations.stats().bytes;
+      }
+    }
+
+    p.clear();  // Otherwise merged back into the aggregate
+  }
+
+  best["peak_rss_kb"] = peakRSSKb();
+  best["repeats"] = repeats;
+
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::setw(10) << best["steps"].get<uint64_t>() << " steps "
+            << std::setw(10) << std::fixed << std::setprecision(1)
+            << best["steps_per_second"].get<double>() << " steps/s "
+            << std::setw(12) << best["critter_ticks_per_second"].get<double>()
+            << " ticks/s " << std::setw(8) << best["peak_rss_kb"].get<long>()
+            << " kB" << std::defaultfloat << std::endl;
+
+  return best;
+}
+
+json Benchmark::runInChild (const std::string &name, const Workload &w,
+                            uint repeats) {
+  int fds [2];
+  if (pipe(fds) != 0) utils::Thrower("Failed to create pipe");
+
+  std::cout.flush();
+  std::cerr.flush();
+  pid_t pid = fork();
+  if (pid < 0)  utils::Thrower("Failed to fork");
+
+  if (pid == 0) {
+    close(fds[0]);
+    int status = 0;
+    try {
+      std::string str = run(name, w, repeats).dump();
+      if (write(fds[1], str.data(), str.size()) != ssize_t(str.size()))
+        status = 1;
+    } catch (std::exception &e) {
+      std::cerr << "Workload " << name << " failed: " << e.what()
+                << std::endl;
+      status = 1;
+    }
+    close(fds[1]);
+    _exit(status);  // Skip exit handlers (e.g. profiler output)
+  }
+
+  close(fds[1]);
+  std::string str;
+  char buffer [4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) str.append(buffer, n);
+  close(fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || str.empty()) {
+    std::cout << std::left << std::setw(24) << name << std::right
+              << RED << "  failed" << NORMAL << std::endl;
+    return {{ "failed", true }};
+  }
+
+  return json::parse(str);
+}
+
+/// Compares the per-workload values of key. Returns false on regression
+static bool compare (const json &report, const json &baseline,
+                     const std::string &key, const std::string &unit,
+                     bool higherIsBetter, float tolerance) {
+  bool ok = true;
+
+  std::cout << "\nComparison with baseline (tolerance " << 100*tolerance
+            << "%):\n";
+  for (const auto &w: report.at("workloads").items()) {
+    if (w.value().contains("failed")) {
+      std::cout << "\t" << RED << w.key() << ": failed" << NORMAL << "\n";
+      ok = false;
+      continue;
+    }
+
+    const json &bw = baseline.at("workloads");
+    if (!bw.contains(w.key())) {
+      std::cout << "\t" << w.key() << ": not in baseline\n";
+      continue;
+    }
+
+    double prev = bw.at(w.key()).at(key), curr = w.value().at(key);
+    double ratio = curr / prev;
+    bool regression = higherIsBetter ? (ratio < 1 - tolerance)
+                                     : (ratio > 1 + tolerance);
+    ok &= !regression;
+
+    std::cout << "\t" << (regression ? RED : GREEN)
+              << std::left << std::setw(24) << w.key() << std::right
+              << std::fixed << std::setprecision(1) << prev << " -> " << curr
+              << " " << unit << " (" << std::showpos << 100 * (ratio - 1)
+              << std::noshowpos << "%)" << std::defaultfloat
+              << NORMAL << "\n";
+  }
+
+  return ok;
+}
+
+/// Writes the report (if requested) and compares it with the baseline (idem)
+static int conclude (const json &report, const std::string &output,
+                     const std::string &baseline,
+                     const std::string &key, const std::string &unit,
+                     bool higherIsBetter, float tolerance) {
+  if (!output.empty()) {
+    std::ofstream (output) << report.dump(2) << "\n";
+    std::cout << "Report written to " << output << "\n";
+  }
+
+  if (!baseline.empty()) {
+    std::ifstream ifs (baseline);
+    if (!ifs) utils::Thrower("Failed to open baseline '", baseline, "'");
+    if (!compare(report, json::parse(ifs), key, unit, higherIsBetter,
+                 tolerance))
+      return 1;
+  }
+
+  return 0;
+}
+
+static void buildType (json &report) {
+#ifdef NDEBUG
+  report["build"] = "release";
+#else
+  report["build"] = "debug";
+#endif
+}
+
+int Benchmark::main (int argc, char *argv[]) {
+  std::string filter = ".*", output, baseline;
+  uint repeats = 3;
+  float tolerance = .1;
+
+  cxxopts::Options options(_name, "Headless throughput benchmark");
+  options.add_options()
+    ("h,help", "Display help")
+    ("l,list", "List available workloads")
+    ("filter", "Only run workloads whose name matches this regex",
+     cxxopts::value(filter))
+    ("r,repeats", "Repetitions per workload (best one is kept)",
+     cxxopts::value(repeats))
+    ("scale", "Multiplier for the workloads' durations",
+     cxxopts::value(_scale))
+    ("o,output", "Where to write the json report", cxxopts::value(output))
+    ("b,baseline", "Previous report to compare against",
+     cxxopts::value(baseline))
+    ("tolerance", "Acceptable relative throughput loss before reporting a"
+                  " regression", cxxopts::value(tolerance))
+    ;
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("help")) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (result.count("list")) {
+    for (const auto &w: _workloads) std::cout << w.first << "\n";
+    return 0;
+  }
+
+  if (Profiler::level() < 1)  Profiler::setLevel(1);
+  repeats = std::max(1u, repeats);
+
+  json report;
+  report["benchmark"] = _name;
+  report["scale"] = _scale;
+  buildType(report);
+
+  std::regex regex (filter);
+  for (const auto &w: _workloads)
+    if (std::regex_search(w.first, regex))
+      report["workloads"][w.first] = runInChild(w.first, w.second, repeats);
+
+  if (!report.contains("workloads")) {
+    std::cerr << "No workload matching '" << filter << "'\n";
+    return 2;
+  }
+
+  int status = conclude(report, output, baseline, "steps_per_second",
+                        "steps/s", true, tolerance);
+  for (const auto &w: report["workloads"])
+    if (w.contains("failed")) status = 1;
+  return status;
+}
+
+// =============================================================================
+
+MicroBenchmark::MicroBenchmark (const std::string &name) : _name(name) {}
+
+void MicroBenchmark::add (const std::string &name, const Fixture &f) {
+  _cases.emplace_back(name, f);
+}
+
+json MicroBenchmark::run (const std::string &name, const Fixture &f,
+                          uint samples, float sampleMs) {
+  using clock = Profiler::clock;
+  static const auto timeBatch = [] (const Case &c, uint64_t n) {
+    auto start = clock::now();
+    for (uint64_t i=0; i<n; i++)  c.op();
+    return std::chrono::duration<double>(clock::now() - start).count();
+  };
+
+  Case c = f();
+
+  // Calibrate (doubles as warm-up)
+  uint64_t batch = 1;
+  while (timeBatch(c, batch) < sampleMs / 1000 && batch < (1ull << 40))
+    batch *= 2;
+
+  std::vector<double> ns;
+  for (uint i=0; i<samples; i++) {
+    if (c.reset) c.reset();
+    ns.push_back(1e9 * timeBatch(c, batch) / batch);
+  }
+  std::sort(ns.begin(), ns.end());
+  double median = ns[ns.size()/2];
+
+  json j = {
+    { "ns_per_op", median }, { "ns_per_op_min", ns.front() },
+    { "ops_per_sample", batch }, { "samples", samples }
+  };
+  if (!c.info.is_null())  j["info"] = c.info;
+
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(14) << median << " ns/op "
+            << std::setw(14) << ns.front() << " min "
+            << std::setw(12) << batch << " ops/sample"
+            << std::defaultfloat;
+  if (!c.info.is_null())  std::cout << "  " << c.info.dump();
+  std::cout << std::endl;
+
+  return j;
+}
+
+int MicroBenchmark::main (int argc, char *argv[]) {
+  std::string filter = ".*", output, baseline;
+  uint samples = 10;
+  float sampleMs = 20;
+  float tolerance = .1;
+
+  cxxopts::Options options(_name, "Kernel micro-benchmarks");
+  options.add_options()
+    ("h,help", "Display help")
+    ("l,list", "List available cases")
+    ("filter", "Only run cases whose name matches this regex",
+     cxxopts::value(filter))
+    ("s,samples", "Number of timed samples per case (median is kept)",
+     cxxopts::value(samples))
+    ("sample-ms", "Target duration of a sample",
+     cxxopts::value(sampleMs))
+    ("o,output", "Where to write the json report", cxxopts::value(output))
+    ("b,baseline", "Previous report to compare against",
+     cxxopts::value(baseline))
+    ("tolerance", "Acceptable relative slowdown before reporting a"
+                  " regression", cxxopts::value(tolerance))
+    ;
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("help")) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (result.count("list")) {
+    for (const auto &c: _cases) std::cout << c.first << "\n";
+    return 0;
+  }
+
+  samples = std::max(1u, samples);
+
+  json report;
+  report["benchmark"] = _name;
+  buildType(report);
+
+  std::regex regex (filter);
+  for (const auto &c: _cases)
+    if (std::regex_search(c.first, regex))
+      report["workloads"][c.first] = run(c.first, c.second, samples, sampleMs);
+
+  if (!report.contains("workloads")) {
+    std::cerr << "No case matching '" << filter << "'\n";
+    return 2;
+  }
+
+  return conclude(report, output, baseline, "ns_per_op", "ns/op", false,
+                  tolerance);
+}
+
+} // end of namespace bench
@@ -0,0 +1,98 @@
+#ifndef TOOLS_BENCHMARK_H
+#define TOOLS_BENCHMARK_H
+
+#include <functional>
+
+#include "../simu/profiler.h"
+
+namespace bench {
+
+/// Runs fixed, seeded workloads and reports their throughput
+///
+/// Step and critter-tick counts come from the step profiler (forced to at
+/// least level 1) so that workloads only have to create, step and destroy
+/// simulations however they like, e.g. through an experiment's evaluator.
+///
+/// Report (json), per workload:
+///  - steps, critter ticks and wall time (best of the repetitions)
+///  - steps/s, critter ticks/s
+///  - peak resident memory (each workload runs in its own process)
+///  - heap allocations, when compiled with WITH_ALLOCATION_COUNTING
+///  - per-phase mean durations and share of the step time
+///
+/// With a baseline (a previous report), workloads whose steps/s dropped by
+/// more than the tolerance are flagged and the program returns 1.
+class Benchmark {
+public:
+  using Workload = std::function<void(void)>;
+
+  Benchmark (const std::string &name);
+
+  /// Workloads are run in order of registration
+  void add (const std::string &name, const Workload &w);
+
+  /// Parses options, runs the (selected) workloads and reports
+  int main (int argc, char *argv[]);
+
+  /// Multiplier for workloads' durations (--scale)
+  float scale (void) const {
+    return _scale;
+  }
+
+  /// Number of steps for a workload nominally lasting n steps
+  uint steps (uint n) const {
+    return std::max(1u, uint(n * _scale));
+  }
+
+private:
+  std::string _name;
+  std::vector<std::pair<std::string, Workload>> _workloads;
+  float _scale;
+
+  nlohmann::json run (const std::string &name, const Workload &w,
+                      uint repeats);
+
+  /// Forks and runs the workload in the child, so that the peak memory is
+  /// its own, and gets the result back through a pipe (as in es-scaling)
+  nlohmann::json runInChild (const std::string &name, const Workload &w,
+                             uint repeats);
+};
+
+/// Times isolated kernels in a loop (see tools/microbench.cpp)
+///
+/// Each case builds its fixture once (untimed) and returns the operation to
+/// time along with an optional reset, called before each sample (untimed), to
+/// bring the fixture back to its initial state. Operations are batched so
+/// that a sample lasts about --sample-ms and the report gives the median and
+/// minimal ns/op over the samples.
+///
+/// With a baseline, cases whose median ns/op grew by more than the tolerance
+/// are flagged and the program returns 1.
+class MicroBenchmark {
+public:
+  struct Case {
+    std::function<void(void)> op;
+    std::function<void(void)> reset;
+    nlohmann::json info;  ///< Description of the fixture (sizes, counts...)
+  };
+  using Fixture = std::function<Case(void)>;
+
+  MicroBenchmark (const std::string &name);
+
+  /// Cases are run in order of registration
+  void add (const std::string &name, const Fixture &f);
+
+  /// Parses options, runs the (selected) cases and reports
+  int main (int argc, char *argv[]);
+
+private:
+  std::string _name;
+  std::vector<std::pair<std::string, Fixture>> _cases;
+
+  nlohmann::json run (const std::string &name, const Fixture &f,
+                      uint samples, float sampleMs);
+};
+
+} // end of namespace bench
+
+#endif // TOOLS_BENCHMARK_H
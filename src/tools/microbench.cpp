@@ -0,0 +1,291 @@
+#include "../simu/simulation.h"
+#include "../tests/genomes.h"
+
+#include "benchmark.h"
+
+using CGenome = genotype::Critter;
+using EGenome = genotype::Environment;
+using simu::Critter;
+using simu::Environment;
+using simu::Simulation;
+using Case = bench::MicroBenchmark::Case;
+
+namespace simu {
+
+/// Direct access to the private substeps of critters, environment and
+/// simulation
+struct Kernels {
+  static void vision (Critter &c, const Environment &e) {
+    c.performVision(e);
+  }
+
+  static void neural (Critter &c) {
+    c.neuralStep();
+  }
+
+  static void energy (Critter &c, Environment &e) {
+    c.energyConsumption(e);
+  }
+
+  static decimal& energy (Critter &c) {
+    return c._energy;
+  }
+
+  static void splines (Critter &c) {
+    Critter::generateSplinesData(c.bodyRadius(), c._efficiency, c._genotype,
+                                 c._splinesData);
+  }
+
+  static void objects (Critter &c) {
+    c.updateObjects();
+  }
+
+  static auto& health (Critter &c) {
+    return c._currHealth;
+  }
+
+  static const auto& fixtures (const Critter &c) {
+    return c._b2FixturesUserData;
+  }
+
+  static uint rays (const Critter &c) {
+    return c._raysEnd.size();
+  }
+
+  static void audition (Simulation &s) {
+    s.audition();
+  }
+
+  /// A fight between a and b over (at most) maxPairs pairs of fixtures, with
+  /// impulses and velocities just above the thresholds
+  struct Fight {
+    Critter *a, *b;
+    Environment::FightingData data;
+    std::array<decltype(Critter::_currHealth), 2> health;
+
+    Fight (Environment &e, Critter *a, Critter *b, uint maxPairs)
+      : a(a), b(b), health{a->_currHealth, b->_currHealth} {
+      static const auto &CMI = config::Simulation::combatMinImpulse();
+      static const auto &CMV = config::Simulation::combatMinVelocity();
+
+      data.critters = { &e._critterData[a], &e._critterData[b] };
+      for (auto *d: data.critters)  d->totalImpulsions = 2 * CMI + 1;
+
+      for (const auto &fA: a->_b2FixturesUserData) {
+        if (fA.first->IsSensor()) continue;
+        for (const auto &fB: b->_b2FixturesUserData) {
+          if (fB.first->IsSensor()) continue;
+          if (data.fixtures.size() >= maxPairs) return;
+
+          auto &d = data.fixtures[{fA.first, fB.first}];
+          d.impulse = 2 * CMI + 1;
+          d.A.velocity = { CMV + 1, 0 };
+          d.B.velocity = { CMV + 1, 0 };
+        }
+      }
+    }
+
+    /// Restores health (otherwise all fixtures are quickly destroyed and
+    /// damages clamped to zero) then processes the fight
+    void operator() (Environment &e) {
+      a->_currHealth = health[0];
+      b->_currHealth = health[1];
+      Environment::DestroyedSplines destroyed;
+      e.processFight(a, b, data, destroyed);
+    }
+  };
+};
+
+} // end of namespace simu
+
+using simu::Kernels;
+
+EGenome environment (float size) {
+  EGenome e;
+  e.width = e.height = size;
+  e.taurus = true;
+  e.maxVegetalPortion = .5;
+  return e;
+}
+
+/// n critters (clones of a few seeded random genomes, mutated m times) after
+/// a few steps, so that sensors, brains and contacts are in a realistic state
+struct Population {
+  Simulation s;
+  std::vector<Critter*> critters;
+  uint next = 0;
+
+  Population (uint n, uint mutations = 0,
+              const std::function<void(CGenome&)> &edit = {},
+              float range = 1) {
+    static constexpr uint GENOMES = 4, WARMUP = 10;
+    rng::FastDice dice (0);
+
+    std::vector<CGenome> genomes;
+    for (uint i=0; i<GENOMES; i++) {
+      CGenome g = CGenome::random(dice);
+      for (uint j=0; j<mutations; j++)  g.mutate(dice);
+      if (edit) edit(g);
+      genomes.push_back(g);
+    }
+
+    Simulation::InitData idata {};
+    idata.nCritters = n;
+    idata.ienergy = 2 * n * Critter::energyForCreation();
+    idata.cRatio = .5;
+    idata.cAge = .5;
+    idata.cRange = range;
+    idata.seed = 0;
+
+    s.init(environment(10 * std::sqrt(n)), genomes, idata);
+    for (uint i=0; i<WARMUP; i++) s.step();
+    critters.assign(s.critters().begin(), s.critters().end());
+  }
+
+  Environment& env (void) {
+    return s.environment();
+  }
+
+  /// Round-robin over the critters
+  Critter& cycle (void) {
+    Critter &c = *critters[next];
+    next = (next + 1) % critters.size();
+    return c;
+  }
+
+  float meanNeurons (void) const {
+    float n = 0;
+    for (const Critter *c: critters)  n += c->brain().neurons().size();
+    return n / critters.size();
+  }
+};
+
+// =============================================================================
+
+Case vision (uint precision) {
+  auto p = std::make_shared<Population>(100, 0, [precision] (CGenome &g) {
+    g.vision.precision = precision;
+  });
+  return {
+    [p] { Kernels::vision(p->cycle(), p->env()); }, {},
+    { { "critters", p->critters.size() },
+      { "rays", Kernels::rays(*p->critters.front()) } }
+  };
+}
+
+Case neural (uint mutations) {
+  auto p = std::make_shared<Population>(100, mutations);
+  return {
+    [p] { Kernels::neural(p->cycle()); }, {},
+    { { "critters", p->critters.size() }, { "neurons", p->meanNeurons() } }
+  };
+}
+
+Case energy (void) {
+  auto p = std::make_shared<Population>(100);
+  auto energies = std::make_shared<std::vector<decimal>>();
+  for (Critter *c: p->critters) energies->push_back(Kernels::energy(*c));
+  return {
+    [p] { Kernels::energy(p->cycle(), p->env()); },
+    [p, energies] {
+      for (uint i=0; i<p->critters.size(); i++)
+        Kernels::energy(*p->critters[i]) = (*energies)[i];
+    },
+    { { "critters", p->critters.size() }, { "neurons", p->meanNeurons() } }
+  };
+}
+
+Case splines (void) {
+  auto p = std::make_shared<Population>(100);
+  return {
+    [p] { Kernels::splines(p->cycle()); }, {},
+    { { "critters", p->critters.size() } }
+  };
+}
+
+Case objects (void) {
+  auto p = std::make_shared<Population>(100);
+  return {
+    [p] { Kernels::objects(p->cycle()); }, {},
+    { { "critters", p->critters.size() } }
+  };
+}
+
+Case fight (uint maxPairs) {
+  struct Fixture {
+    Simulation s;
+    std::unique_ptr<Kernels::Fight> fight;
+  };
+  auto f = std::make_shared<Fixture>();
+
+  Simulation::InitData idata {};
+  idata.ienergy = 0;
+  idata.nCritters = 0;
+  idata.seed = 0;
+  CGenome agg (canned::agg_json), def (canned::def_json);
+  f->s.init(environment(4), { agg, def }, idata);
+
+  auto e = Critter::maximalEnergyStorage(Critter::MAX_SIZE);
+  Critter *a = f->s.addCritter(agg, -canned::spacing, 0, 0, e, .5),
+          *b = f->s.addCritter(def, +canned::spacing, 0, M_PI, e, .5);
+  f->fight = std::make_unique<Kernels::Fight>(f->s.environment(), a, b,
+                                              maxPairs);
+
+  return {
+    [f] { (*f->fight)(f->s.environment()); }, {},
+    { { "pairs", f->fight->data.fixtures.size() } }
+  };
+}
+
+Case audition (uint n) {
+  // Packed so that most audition sensors overlap
+  auto p = std::make_shared<Population>(n, 0, {}, .1);
+  for (Critter *c: p->critters) c->setNoisy(true);
+  return {
+    [p] { Kernels::audition(p->s); }, {},
+    { { "critters", p->critters.size() },
+      { "events", p->env().hearingEvents().size() } }
+  };
+}
+
+Case brain (uint mutations) {
+  auto p = std::make_shared<Population>(20, mutations);
+  auto ann = std::make_shared<phenotype::ANN>();
+  return {
+    [p, ann] {
+      const Critter &c = p->cycle();
+      Critter::buildBrain(c.genotype(), c.bodyRadius(), *ann);
+    }, {},
+    { { "neurons", p->meanNeurons() } }
+  };
+}
+
+int main(int argc, char *argv[]) {
+  using utils::mergeToString;
+  config::Simulation::verbosity.overrideWith(0);
+
+  bench::MicroBenchmark b ("splinoids-microbench");
+
+  const auto &pb = genotype::Vision::config_t::precisionBounds();
+  for (uint p: std::set<uint>{ pb.min, (pb.min + pb.max) / 2, pb.max })
+    b.add(mergeToString("vision/p", p), [p] { return vision(p); });
+
+  for (uint m: {0, 100, 400})
+    b.add(mergeToString("neural/m", m), [m] { return neural(m); });
+
+  b.add("energy", energy);
+  b.add("splines", splines);
+  b.add("objects", objects);
+
+  for (uint p: {1u, 16u, ~0u})
+    b.add(mergeToString("fight/p", p == ~0u ? "all" : std::to_string(p)),
+          [p] { return fight(p); });
+
+  for (uint n: {10, 50})
+    b.add(mergeToString("audition/n", n), [n] { return audition(n); });
+
+  for (uint m: {0, 100, 400})
+    b.add(mergeToString("brain/m", m), [m] { return brain(m); });
+
+  return b.main(argc, argv);
+}
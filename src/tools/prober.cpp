@@ -0,0 +1,86 @@
+#include <thread>
+
+#include "probing.h"
+
+#include "kgd/external/cxxopts.hpp"
+
+int main(int argc, char *argv[]) {
+  std::string protocolFile, replay, output = "probes";
+  std::vector<std::string> genomes;
+  uint threads = std::thread::hardware_concurrency();
+  int lesions = 0;
+  float tolerance = 1e-3;
+
+  cxxopts::Options options("Splinoids (prober)",
+                           "Scripted neural probing of many brains, without"
+                           " simulation");
+  options.add_options()
+    ("h,help", "Display help")
+    ("p,protocol", "Json description of the stimuli (see probing.h)",
+     cxxopts::value(protocolFile))
+    ("replay", "Inputs logged by an evaluator's neural evaluation, to replay"
+               " and compare against (instead of a protocol)",
+     cxxopts::value(replay))
+    ("tolerance", "Largest acceptable difference with the replayed evaluation"
+                  " (its logs have limited precision)",
+     cxxopts::value(tolerance))
+    ("lesions", "Lesion type to apply (see Critter::applyLesions)",
+     cxxopts::value(lesions))
+    ("o,output", "Folder under which to write each subject's logs",
+     cxxopts::value(output))
+    ("t,threads", "Number of brains probed concurrently",
+     cxxopts::value(threads))
+    ("genomes", "Genomes, gaga individuals or archive locators to probe",
+     cxxopts::value(genomes))
+    ;
+  options.parse_positional("genomes");
+  options.positional_help("<genome> [<genome> ...]");
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("help") || protocolFile.empty() == replay.empty()
+      || genomes.empty()) {
+    std::cout << options.help() << std::endl;
+    return 0;
+  }
+
+  if (!replay.empty() && genomes.size() != 1)
+    utils::Thrower("Replaying an evaluation requires exactly one genome");
+
+  const auto protocol = replay.empty()
+                      ? probing::Protocol::fromFile(protocolFile)
+                      : probing::Protocol::fromRecording(replay);
+
+  std::vector<probing::Prober::Subject> subjects;
+  std::set<std::string> ids;
+  for (const std::string &g: genomes) {
+    subjects.push_back(probing::Prober::load(g));
+    auto &id = subjects.back().id;
+    if (lesions > 0)  id += utils::mergeToString("_l", lesions);
+    if (!ids.insert(id).second) { // Same file names in different folders
+      id = utils::mergeToString(subjects.size()-1, "_", id);
+      ids.insert(id);
+    }
+  }
+
+  probing::Prober prober (protocol, threads);
+  prober.setLesions(lesions);
+  uint failures = prober(subjects, output);
+
+  std::cout << "Probed " << subjects.size() - failures << "/"
+            << subjects.size() << " brains over " << protocol.duration()
+            << " ticks into " << output << "\n";
+
+  if (!replay.empty() && failures == 0) {
+    auto c = probing::Comparison::compare(
+               replay, stdfs::path(output) / subjects.front().id);
+    bool ok = (c.outputs <= tolerance && c.neurons <= tolerance);
+    std::cout << "Replay of " << replay << " over " << c.ticks << " ticks: max"
+              << " differences of " << c.outputs << " (outputs) and "
+              << c.neurons << " (neurons) -> "
+              << (ok ? "match" : "MISMATCH") << "\n";
+    if (!ok)  return 1;
+  }
+
+  return failures > 0;
+}
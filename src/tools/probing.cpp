@@ -0,0 +1,337 @@
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "probing.h"
+#include "../ga/archive.h"
+#include "../genotype/codec.h"
+
+namespace probing {
+
+uint Protocol::duration (void) const {
+  uint d = 0;
+  for (const Phase &p: phases)  d += p.ticks;
+  return repeats * d;
+}
+
+void from_json (const nlohmann::json &j, Protocol::Segment &s) {
+  s.from = j.at("from");
+  s.to = j.at("to");
+  s.rgb = j.at("rgb");
+}
+
+void from_json (const nlohmann::json &j, Protocol::Phase &p) {
+  p.flags = j.value("flags", "");
+  p.ticks = j.at("ticks");
+  if (j.count("retina"))
+    p.retina = j["retina"].get<decltype(p.retina)>();
+  if (j.count("inputs")) {
+    for (const auto &i: j["inputs"].items()) {
+      auto &s = p.inputs[i.key()];
+      if (i.value().is_array()) s = i.value().get<std::vector<float>>();
+      else                      s = { i.value().get<float>() };
+      if (s.empty())
+        utils::Thrower("Empty series for neural input '", i.key(), "'");
+    }
+  }
+}
+
+void from_json (const nlohmann::json &j, Protocol &p) {
+  p.flagsHeader = j.value("flagsHeader", p.flagsHeader);
+  p.age = j.value("age", p.age);
+  p.repeats = j.value("repeats", p.repeats);
+  p.skipMissing = j.value("skipMissing", p.skipMissing);
+  if (j.count("defaults"))
+    p.defaults = j["defaults"].get<decltype(p.defaults)>();
+  p.phases = j.at("phases").get<decltype(p.phases)>();
+}
+
+Protocol Protocol::fromFile (const stdfs::path &path) {
+  std::ifstream ifs (path);
+  if (!ifs) utils::Thrower("Unable to open protocol '", path, "'");
+  return nlohmann::json::parse(ifs).get<Protocol>();
+}
+
+Protocol Protocol::fromRecording (const stdfs::path &inputs) {
+  std::ifstream ifs (inputs);
+  if (!ifs) utils::Thrower("Unable to open recording '", inputs, "'");
+
+  std::string line, name;
+  std::vector<std::string> header;
+  std::getline(ifs, line);
+  for (std::istringstream iss (line); iss >> name;) header.push_back(name);
+
+  std::vector<std::vector<float>> rows;
+  while (std::getline(ifs, line)) {
+    std::vector<float> row;
+    float v;
+    for (std::istringstream iss (line); iss >> v;)  row.push_back(v);
+    if (row.empty())  continue;
+    if (row.size() != header.size())
+      utils::Thrower("Malformed recording '", inputs, "': ", row.size(),
+                     " values at tick ", rows.size(), " for ", header.size(),
+                     " inputs");
+    rows.push_back(row);
+  }
+
+  Protocol p;
+  std::vector<std::string> flags (rows.size());
+  if (std::ifstream nfs (inputs.parent_path() / "neurons.dat"); nfs) {
+    std::getline(nfs, line);
+    std::istringstream (line) >> p.flagsHeader;
+    for (uint t=0; t<rows.size() && std::getline(nfs, line); t++)
+      std::istringstream (line) >> flags[t];
+  }
+
+  // One phase per run of identical flags, holding the exact series
+  for (uint t=0; t<rows.size(); t++) {
+    if (p.phases.empty() || p.phases.back().flags != flags[t]) {
+      p.phases.emplace_back();
+      p.phases.back().flags = flags[t];
+      p.phases.back().ticks = 0;
+    }
+
+    Phase &phase = p.phases.back();
+    phase.ticks++;
+    for (uint i=0; i<header.size(); i++)
+      phase.inputs[header[i]].push_back(rows[t][i]);
+  }
+
+  return p;
+}
+
+Stimuli::Stimuli (const Protocol &p, uint rays)
+  : header(simu::Critter::neuralInputsHeader(rays)) {
+
+  const uint n = header.size();
+  std::map<std::string, uint> index;
+  for (uint i=0; i<n; i++)  index[header[i]] = i;
+  const auto column = [&index, &p] (const std::string &name) {
+    auto it = index.find(name);
+    if (it != index.end())  return int(it->second);
+    if (!p.skipMissing)
+      utils::Thrower("Unknown neural input '", name, "'");
+    return -1;
+  };
+
+  std::vector<float> defaults (n, 0);
+  for (const auto &d: p.defaults)
+    if (int c = column(d.first); c >= 0)  defaults[c] = d.second;
+
+  values.reserve(p.duration() * n);
+  flags.reserve(p.duration());
+  for (uint r=0; r<p.repeats; r++) {
+    for (const Protocol::Phase &phase: p.phases) {
+      // Segments of both eyes (rays are stored eye after eye)
+      std::vector<std::pair<uint, float>> painted;
+      const uint eye = rays / 2;
+      for (const Protocol::Segment &s: phase.retina) {
+        for (uint e=0; e<2; e++) {
+          for (uint i=0; i<eye; i++) {
+            float f = (i + .5f) / eye;
+            if (f < s.from || s.to <= f)  continue;
+            for (uint k=0; k<3; k++)
+              if (int c = column(utils::mergeToString("R", e*eye+i, "RGB"[k]));
+                  c >= 0)
+                painted.emplace_back(c, s.rgb[k]);
+          }
+        }
+      }
+
+      std::vector<std::pair<uint, const std::vector<float>*>> series;
+      for (const auto &i: phase.inputs)
+        if (int c = column(i.first); c >= 0)  series.emplace_back(c, &i.second);
+
+      for (uint t=0; t<phase.ticks; t++) {
+        values.insert(values.end(), defaults.begin(), defaults.end());
+        float *row = values.data() + values.size() - n;
+        for (const auto &c: painted)  row[c.first] = c.second;
+        for (const auto &s: series)
+          row[s.first] = (*s.second)[t % s.second->size()];
+        flags.push_back(&phase.flags);
+      }
+    }
+  }
+}
+
+Prober::Prober (const Protocol &p, uint threads)
+  : _protocol(p), _threads(std::max(1u, threads)), _lesions(0) {}
+
+uint Prober::operator() (const std::vector<Subject> &subjects,
+                         const stdfs::path &folder) {
+  // Unroll the protocol once per inputs layout
+  for (const Subject &s: subjects) {
+    uint rays = simu::Critter::visionRays(s.genome);
+    if (_stimuli.find(rays) == _stimuli.end())
+      _stimuli.emplace(rays, Stimuli(_protocol, rays));
+  }
+
+  std::atomic<uint> next = 0, failures = 0;
+  const auto work = [&] {
+    for (uint i = next++; i < subjects.size(); i = next++) {
+      const Subject &s = subjects[i];
+      try {
+        probe(s, _stimuli.at(simu::Critter::visionRays(s.genome)), folder);
+      } catch (const std::exception &e) {
+        std::cerr << "Failed to probe " << s.id << ": " << e.what() << "\n";
+        failures++;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint i=1; i<std::min<uint>(_threads, subjects.size()); i++)
+    threads.emplace_back(work);
+  work();
+  for (std::thread &t: threads) t.join();
+
+  return failures;
+}
+
+void Prober::probe (const Subject &s, const Stimuli &stimuli,
+                    const stdfs::path &folder) const {
+  using Critter = simu::Critter;
+  const Critter::Genome &g = s.genome;
+
+  phenotype::ANN brain;
+  Critter::buildBrain(g, Critter::initialSize(g, _protocol.age)
+                          * Critter::RADIUS, brain);
+  Critter::applyLesions(brain, _lesions);
+
+  auto inputs = brain.inputs();
+  auto outputs = brain.outputs();
+  if (inputs.size() != stimuli.header.size())
+    utils::Thrower("Brain has ", inputs.size(), " inputs instead of ",
+                   stimuli.header.size());
+
+  const stdfs::path f = folder / s.id;
+  stdfs::create_directories(f);
+
+  std::ofstream ilog (f / "inputs.dat"), olog (f / "outputs.dat"),
+                nlog (f / "neurons.dat");
+  for (const auto &n: stimuli.header) ilog << n << " ";
+  ilog << "\n";
+  for (const auto &n: Critter::neuralOutputsHeader()) olog << n << " ";
+  olog << "\n";
+
+  nlog << _protocol.flagsHeader;
+  for (const auto &p: brain.neurons())
+    if (p->isHidden())
+      nlog << " (" << p->pos << ")";
+  nlog << "\n";
+
+  {
+    std::ofstream blog (f / "brain.dat");
+    blog << "Type X Y Z Depth Flags\n";
+    for (const phenotype::ANN::Neuron::ptr &p: brain.neurons()) {
+      blog << p->type
+           << " " << p->pos.x() << " " << p->pos.y() << " " << p->pos.z()
+           << " " << p->depth << " " << p->flags << "\n";
+    }
+  }
+
+  for (uint t=0; t<stimuli.ticks(); t++) {
+    const float *row = stimuli.at(t);
+    for (uint i=0; i<inputs.size(); i++)  inputs[i] = row[i];
+
+    brain(inputs, outputs, g.brain.substeps);
+
+    for (const auto &v: inputs) ilog << v << " ";
+    ilog << "\n";
+
+    for (const auto &v: outputs) olog << v << " ";
+    olog << "\n";
+
+    nlog << *stimuli.flags[t];
+    for (const auto &p: brain.neurons())
+      if (p->isHidden())
+        nlog << " " << p->value;
+    nlog << "\n";
+  }
+}
+
+Prober::Subject Prober::load (const std::string &path) {
+  nlohmann::json o;
+  if (simu::ArchiveReader::isLocator(path))
+    o = simu::ArchiveReader::loadIndividual(path);
+
+  else {
+    std::ifstream ifs (path);
+    if (!ifs) utils::Thrower("Error while opening ", path);
+    o = nlohmann::json::parse(ifs);
+  }
+
+  Subject s;
+  s.id = stdfs::path(path).stem().string();
+
+  if (o.count("dna")) { // assuming this is a gaga individual
+    nlohmann::json dna = o["dna"];
+    if (dna.is_string())  o = genotype::Codec::toJSON(dna.get<std::string>());
+    else                  o = std::move(dna);
+  }
+  if (o.is_array()) { // mkombat team: [size, genome]
+    nlohmann::json genome = o[1];
+    o = std::move(genome);
+  }
+
+  s.genome = simu::Critter::Genome(o);
+  return s;
+}
+
+Comparison Comparison::compare (const stdfs::path &recordedInputs,
+                                const stdfs::path &probed) {
+  using Table = std::vector<std::vector<float>>;
+  const auto table = [] (const stdfs::path &path, uint skip) {
+    std::ifstream ifs (path);
+    if (!ifs) utils::Thrower("Unable to open '", path, "'");
+
+    Table rows;
+    std::string line, token;
+    std::getline(ifs, line);  // Header
+    while (std::getline(ifs, line)) {
+      std::vector<float> row;
+      std::istringstream iss (line);
+      for (uint i=0; iss >> token; i++)
+        if (i >= skip)  row.push_back(std::stof(token));
+      if (!row.empty()) rows.push_back(row);
+    }
+    return rows;
+  };
+
+  uint ticks = 0;
+  const auto maxDiff = [&table, &ticks] (const stdfs::path &lhsPath,
+                                         const stdfs::path &rhsPath,
+                                         uint skip) {
+    Table lhs = table(lhsPath, skip), rhs = table(rhsPath, skip);
+    if (lhs.size() != rhs.size())
+      utils::Thrower("Mismatched number of ticks between ", lhsPath, " (",
+                     lhs.size(), ") and ", rhsPath, " (", rhs.size(), ")");
+
+    float d = 0;
+    for (uint t=0; t<lhs.size(); t++) {
+      if (lhs[t].size() != rhs[t].size())
+        utils::Thrower("Mismatched number of values at tick ", t, " between ",
+                       lhsPath, " and ", rhsPath);
+      for (uint i=0; i<lhs[t].size(); i++)
+        d = std::max(d, std::fabs(lhs[t][i] - rhs[t][i]));
+    }
+    ticks = lhs.size();
+    return d;
+  };
+
+  std::string outputs = recordedInputs.filename().string();
+  auto i = outputs.find("inputs");
+  if (i == std::string::npos)
+    utils::Thrower("Cannot deduce the outputs of ", recordedInputs);
+  outputs.replace(i, 6, "outputs");
+
+  const stdfs::path folder = recordedInputs.parent_path();
+  Comparison c;
+  c.outputs = maxDiff(folder / outputs, probed / "outputs.dat", 0);
+  c.neurons = maxDiff(folder / "neurons.dat", probed / "neurons.dat", 1);
+  c.ticks = ticks;
+  return c;
+}
+
+} // end of namespace probing
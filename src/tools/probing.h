@@ -0,0 +1,144 @@
+#ifndef TOOLS_PROBING_H
+#define TOOLS_PROBING_H
+
+#include "../simu/critter.h"
+
+namespace probing {
+
+/// Scripted stimulation of brains, as in the neural evaluations (mkombat's
+/// pain/touch/sound flags, language's vision/audition flags, ...) but without
+/// any simulation
+///
+/// A protocol is a sequence of phases, each held for a number of ticks and
+/// assigning values to named neural inputs (see Critter::neuralInputsHeader).
+/// A single value is held for the whole phase while a series is cycled through
+/// (e.g. an audio sample). Unassigned inputs take their default (or 0).
+/// As the number of rays depends on the genome, vision is described by
+/// segments of each eye's field, in [0,1], painted with a color.
+/// Inputs absent from this build (e.g. health or touch sensors) are rejected
+/// unless skipMissing is set.
+///
+/// Json format:
+/// {
+///   "flagsHeader": "OFNCBATHI", "age": 0.5, "repeats": 1,
+///   "skipMissing": false, "defaults": { "HA": 1 },
+///   "phases": [
+///     { "flags": "000000000", "ticks": 100 },
+///     { "flags": "000000100", "ticks": 100, "inputs": { "ALC0": 1,
+///                                                        "ARC0": 1 } },
+///     { "flags": "000000010", "ticks": 100,
+///       "retina": [ { "from": 0.4, "to": 0.6, "rgb": [1, 0, 0] } ] }
+///   ]
+/// }
+///
+/// Protocols reproducing the experiments' neural evaluations are provided
+/// under data/probing/. Language's auditive evaluations have none: their
+/// stimulus is a vocalization recorded from another evaluation of the same
+/// genomes. Use Protocol::fromRecording (prober --replay) on such an
+/// evaluation's logs instead
+struct Protocol {
+  struct Segment {
+    float from, to;   ///< Fraction of each eye's rays
+    std::array<float, 3> rgb;
+  };
+
+  struct Phase {
+    std::string flags;  ///< Written in front of the neurons' values
+    uint ticks;
+    std::map<std::string, std::vector<float>> inputs;
+    std::vector<Segment> retina;
+  };
+
+  std::string flagsHeader = "Flags";
+  float age = .5;       ///< Of the subjects (determines their vision rays)
+  uint repeats = 1;     ///< Number of passes through the phases
+  bool skipMissing = false;
+
+  std::map<std::string, float> defaults;
+  std::vector<Phase> phases;
+
+  uint duration (void) const;
+
+  static Protocol fromFile (const stdfs::path &path);
+
+  /// Replays the inputs logged by an evaluator's logging_step (inputs file
+  /// and the flags of the neurons.dat next to it), tick by tick
+  static Protocol fromRecording (const stdfs::path &inputs);
+};
+
+void from_json (const nlohmann::json &j, Protocol::Segment &s);
+void from_json (const nlohmann::json &j, Protocol::Phase &p);
+void from_json (const nlohmann::json &j, Protocol &p);
+
+/// A protocol unrolled into every tick's inputs for a given layout. Shared by
+/// all brains with that layout
+struct Stimuli {
+  std::vector<std::string> header;
+  std::vector<float> values;                ///< ticks x inputs, row-major
+  std::vector<const std::string*> flags;    ///< per tick
+
+  Stimuli (const Protocol &p, uint rays);
+
+  uint ticks (void) const {
+    return flags.size();
+  }
+
+  const float* at (uint tick) const {
+    return values.data() + tick * header.size();
+  }
+};
+
+/// Runs a protocol against many brains at once (one per thread at a time) and
+/// writes, for each, what the neural evaluations log: inputs.dat, outputs.dat,
+/// neurons.dat (and brain.dat) under <folder>/<id>/
+class Prober {
+public:
+  struct Subject {
+    std::string id;
+    simu::Critter::Genome genome;
+  };
+
+  Prober (const Protocol &p, uint threads);
+
+  /// Lesions applied to every brain before probing (see Critter::applyLesions)
+  void setLesions (int lesions) {
+    _lesions = lesions;
+  }
+
+  /// Returns the number of subjects that could not be probed (reported on
+  /// std::cerr)
+  uint operator() (const std::vector<Subject> &subjects,
+                   const stdfs::path &folder);
+
+  /// Accepts plain genomes, gaga individuals and (mkombat) teams, in files or
+  /// archives (see ArchiveReader::isLocator)
+  static Subject load (const std::string &path);
+
+private:
+  const Protocol &_protocol;
+  const uint _threads;
+  int _lesions;
+
+  /// Per number of vision rays
+  std::map<uint, Stimuli> _stimuli;
+
+  void probe (const Subject &s, const Stimuli &stimuli,
+              const stdfs::path &folder) const;
+};
+
+/// Largest absolute differences between the logs of a probe and those of an
+/// in-simulation neural evaluation (e.g. replayed through
+/// Protocol::fromRecording)
+struct Comparison {
+  uint ticks;
+  float outputs, neurons;
+
+  /// Compares the outputs and neurons logs matching this inputs file (same
+  /// naming as the evaluators) with those in probed
+  static Comparison compare (const stdfs::path &recordedInputs,
+                             const stdfs::path &probed);
+};
+
+} // end of namespace probing
+
+#endif // TOOLS_PROBING_H
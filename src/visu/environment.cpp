@@ -29,7 +29,8 @@ Environment::Environment (simu::Environment &e,
 
 #ifndef NDEBUG
   _ddrawer = new DebugDrawer (10, .5);
-  _environment.physics().SetDebugDraw(_ddrawer);
+  for (uint i=0; i<_environment.tiles(); i++)
+    _environment.physics(i).SetDebugDraw(_ddrawer);
   _ddrawer->SetFlags(
       b2Draw::e_shapeBit
     | b2Draw::e_jointBit
@@ -118,7 +119,9 @@ void Environment::paint (QPainter *painter,
 #ifndef NDEBUG
 void Environment::doDebugDraw(void) {
   _ddrawer->clear();
-  if (config::Visualisation::b2DebugDraw()) _environment.physics().DebugDraw();
+  if (config::Visualisation::b2DebugDraw())
+    for (uint i=0; i<_environment.tiles(); i++)
+      _environment.physics(i).DebugDraw();
 }
 #endif
 
@@ -97,6 +97,32 @@ void GraphicSimulation::step (void) {
   _gstepTimeMs = durationFrom(start);
 }
 
+void GraphicSimulation::replay (const simu::FlightRecorder::Frame &f) {
+  for (const auto &s: f.states) {
+    auto it = std::find_if(Simulation::_critters.begin(),
+                           Simulation::_critters.end(),
+                           [&s] (const simu::Critter *c) {
+      return c->id() == s.id;
+    });
+    if (it == Simulation::_critters.end())  continue;
+
+    simu::Critter *c = *it;
+    b2Body &b = c->body();
+    b.SetTransform({s.x, s.y}, s.a);
+    b.SetLinearVelocity({s.vx, s.vy});
+    b.SetAngularVelocity(s.va);
+    c->setMotorOutput(s.motors[0], Motor::LEFT);
+    c->setMotorOutput(s.motors[1], Motor::RIGHT);
+    c->overrideBodyHealthness(
+      std::clamp(simu::decimal(s.health / c->bodyMaxHealth()),
+                 simu::decimal(0), simu::decimal(1)));
+
+    _critters.at(c)->update();
+  }
+
+  _timeLabel->setText("Replay: " + QString::number(f.timestamp));
+}
+
 void GraphicSimulation::processStats(const Stats &s) const {
   if (!_stats)  return;
 
@@ -120,14 +146,15 @@ void GraphicSimulation::processStats(const Stats &s) const {
   _stats->update("[E] Total",
                  float(s.eplants+s.ecorpses+s.ecritters+s.ereserve), 2);
 
-  const auto &st = _timeMs;
+  using P = simu::Profiler;
+  const P &p = profiler();
   _stats->update("[D] Visu    ", _gstepTimeMs, 0);
-  _stats->update( "[D] Simu   ", st.step, 0);
-  _stats->update(  "[D] Spln  ", st.spln, 0);
-  _stats->update(  "[D] Env   ", st.env, 0);
-  _stats->update(   "[D] Box2D", _environment->physics().GetProfile().step, 0);
-  _stats->update(  "[D] Decay ", st.decay, 0);
-  _stats->update(  "[D] Regen ", st.regen, 0);
+  if (!P::enabled())  return;
+  _stats->update( "[D] Simu   ", p.lastMs(P::STEP), 2);
+  _stats->update(  "[D] Box2D ", p.lastMs(P::BOX2D), 2);
+  _stats->update(  "[D] Fights", p.lastMs(P::FIGHTS), 2);
+  _stats->update(  "[D] Decay ", p.lastMs(P::DECOMPOSITION), 2);
+  _stats->update(  "[D] Regen ", p.lastMs(P::PLANTS), 2);
 }
 
 void GraphicSimulation::addVisuCritter(simu::Critter *sc) {
@@ -107,6 +107,10 @@ public:
 
   void step (void) override;
 
+  /// Places the critters (matched by id) as in a flight recorder frame,
+  /// without stepping the simulation
+  void replay (const simu::FlightRecorder::Frame &f);
+
 #ifndef NDEBUG
   void doDebugDrawNow (void) {
     _graphicEnvironment->doDebugDraw();